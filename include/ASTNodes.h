@@ -1,300 +1,488 @@
-#ifndef __ASTNODES_H__
-#define __ASTNODES_H__
-
-#include "Token.h"
-#include "Types.h"
-
-#include <memory>
-#include <optional>
-#include <string>
-#include <variant>
-#include <vector>
-
-/**
- * @brief Alternative implementation of Stmt.h and Expr.h that does not rely on
- * VTables and gets rid of performance overhead vtables incurr
- *
- */
-namespace boop::AST {
-
-// forward declaration of expression node types
-struct ExprBinary;
-struct ExprGrouping;
-struct ExprLiteral;
-struct ExprUnary;
-struct ExprConditional;
-struct ExprPostfix;
-struct ExprVariable;
-struct ExprAssignment;
-struct ExprLogical;
-struct ExprCall;
-struct ExprFunction;
-struct ExprGet;
-struct ExprSet;
-struct ExprThis;
-struct ExprSuper;
-
-// reference manager assigned to smart pointer 
-using ExprBinaryPtr = std::unique_ptr<ExprBinary>;
-using ExprGroupingPtr = std::unique_ptr<ExprGrouping>;
-using ExprLiteralPtr = std::unique_ptr<ExprLiteral>;
-using ExprUnaryPtr = std::unique_ptr<ExprUnary>;
-using ExprConditionalPtr = std::unique_ptr<ExprConditional>;
-using ExprPostfixPtr = std::unique_ptr<ExprPostfix>;
-using ExprVariablePtr = std::unique_ptr<ExprVariable>;
-using ExprAssignmentPtr = std::unique_ptr<ExprAssignment>;
-using ExprLogicalPtr = std::unique_ptr<ExprLogical>;
-using ExprCallPtr = std::unique_ptr<ExprCall>;
-using ExprFunctionPtr = std::unique_ptr<ExprFunction>;
-using ExprGetPtr = std::unique_ptr<ExprGet>;
-using ExprSetPtr = std::unique_ptr<ExprSet>;
-using ExprThisPtr = std::unique_ptr<ExprThis>;
-using ExprSuperPtr = std::unique_ptr<ExprSuper>;
-
-// union type for reference manager to handle statement nodes
-using ExprPtrVariant =
-    std::variant<ExprBinaryPtr, ExprGroupingPtr, ExprLiteralPtr, ExprUnaryPtr,
-                 ExprConditionalPtr, ExprPostfixPtr, ExprVariablePtr,
-                 ExprAssignmentPtr, ExprLogicalPtr, ExprCallPtr, ExprFunctionPtr,
-                 ExprGetPtr, ExprSetPtr, ExprThisPtr, ExprSuperPtr>;
-                 
-// forward declaration of statement node types
-struct StmtExpr;
-struct StmtPrint;
-struct StmtBlock;
-struct StmtVariable;
-struct StmtIf;
-struct StmtWhile;
-struct StmtFor;
-struct StmtFunction;
-struct StmtReturn;
-struct StmtClass;
-
-// alias for automatic reference managers on each statement node types
-using ExprStmtPtr = std::unique_ptr<StmtExpr>;
-using PrintStmtPtr = std::unique_ptr<StmtPrint>;
-using BlockStmtPtr = std::unique_ptr<StmtBlock>;
-using VarStmtPtr = std::unique_ptr<StmtVariable>;
-using IfStmtPtr = std::unique_ptr<StmtIf>;
-using WhileStmtPtr = std::unique_ptr<StmtWhile>;
-using ForStmtPtr = std::unique_ptr<StmtFor>;
-using FuncStmtPtr = std::unique_ptr<StmtFunction>;
-using RetStmtPtr = std::unique_ptr<StmtReturn>;
-using ClassStmtPtr = std::unique_ptr<StmtClass>;
-
-// union type for reference manager to handle statement nodes
-using StmtPtrVariant =
-    std::variant<ExprStmtPtr, PrintStmtPtr, BlockStmtPtr, VarStmtPtr, IfStmtPtr,
-                 WhileStmtPtr, ForStmtPtr, FuncStmtPtr, RetStmtPtr,
-                 ClassStmtPtr>;
-
-// methods that creates expression nodes 
-auto make_binary_expr(ExprPtrVariant left, Token op, ExprPtrVariant right)
-    -> ExprPtrVariant;
-auto make_unary_expr(Token op, ExprPtrVariant right) -> ExprPtrVariant;
-auto make_grouping_expr(ExprPtrVariant right) -> ExprPtrVariant;
-auto make_literal_expr(OptionalLiteral literal) -> ExprPtrVariant;
-auto make_conditional_expr(ExprPtrVariant condition, ExprPtrVariant then,
-                          ExprPtrVariant else_branch) -> ExprPtrVariant;
-auto make_postfix_expr(ExprPtrVariant left, Token op) -> ExprPtrVariant;
-auto make_variable_expr(Token var_name) -> ExprPtrVariant;
-auto make_assignment_expr(Token var_name, ExprPtrVariant expr) -> ExprPtrVariant;
-auto make_logical_expr(ExprPtrVariant left, Token op, ExprPtrVariant right)
-    -> ExprPtrVariant;
-auto make_call_expr(ExprPtrVariant callee, Token paren,
-                   std::vector<ExprPtrVariant> arguments) -> ExprPtrVariant;
-auto make_function_expr(std::vector<Token> params,
-                   std::vector<StmtPtrVariant> fnBody) -> ExprPtrVariant;
-auto make_get_expr(ExprPtrVariant expr, Token name) -> ExprPtrVariant;
-auto make_set_expr(ExprPtrVariant expr, Token name, ExprPtrVariant value)
-    -> ExprPtrVariant;
-auto make_this_expr(Token keyword) -> ExprPtrVariant;
-auto make_super_expr(Token keyword, Token method) -> ExprPtrVariant;
-
-
-
-// methods that creates statement nodes
-auto make_expr_stmt(ExprPtrVariant expr) -> StmtPtrVariant;
-auto make_print_stmt(ExprPtrVariant expr) -> StmtPtrVariant;
-auto make_block_stmt(std::vector<StmtPtrVariant> statements) -> StmtPtrVariant;
-auto make_var_stmt(Token var_name, std::optional<ExprPtrVariant> initializer)
-    -> StmtPtrVariant;
-auto make_if_stmt(ExprPtrVariant condition, StmtPtrVariant then_branch,
-                 std::optional<StmtPtrVariant> else_branch) -> StmtPtrVariant;
-auto make_while_stmt(ExprPtrVariant condition, StmtPtrVariant loop_body)
-    -> StmtPtrVariant;
-auto make_for_stmt(std::optional<StmtPtrVariant> initializer,
-                  std::optional<ExprPtrVariant> condition,
-                  std::optional<ExprPtrVariant> increment,
-                  StmtPtrVariant loop_body) -> StmtPtrVariant;
-auto make_function_stmt(Token fName, ExprFunctionPtr ExprFunction) -> StmtPtrVariant;
-auto make_return_stmt(Token ret, std::optional<ExprPtrVariant> value)
-    -> StmtPtrVariant;
-auto make_class_stmt(Token class_name, std::optional<ExprPtrVariant> superClass,
-                    std::vector<StmtPtrVariant> methods) -> StmtPtrVariant;
-
-
-// Expression AST Types member declaration:
-struct ExprBinary final : public Uncopyable {
-  ExprPtrVariant left;
-  Token op;
-  ExprPtrVariant right;
-  ExprBinary(ExprPtrVariant left, Token op, ExprPtrVariant right);
-};
-
-struct ExprGrouping final : public Uncopyable {
-  ExprPtrVariant expression;
-  explicit ExprGrouping(ExprPtrVariant expression);
-};
-
-struct ExprLiteral final : public Uncopyable {
-  OptionalLiteral literalVal;
-  explicit ExprLiteral(OptionalLiteral value);
-};
-
-struct ExprUnary final : public Uncopyable {
-  Token op;
-  ExprPtrVariant right;
-  ExprUnary(Token op, ExprPtrVariant right);
-};
-
-struct ExprConditional final : public Uncopyable {
-  ExprPtrVariant condition;
-  ExprPtrVariant then_branch;
-  ExprPtrVariant else_branch;
-  ExprConditional(ExprPtrVariant condition, ExprPtrVariant then_branch,
-                  ExprPtrVariant else_branch);
-};
-
-struct ExprPostfix final : public Uncopyable {
-  ExprPtrVariant left;
-  Token op;
-  ExprPostfix(ExprPtrVariant left, Token op);
-};
-
-struct ExprVariable final : public Uncopyable {
-  Token var_name;
-  explicit ExprVariable(Token var_name);
-};
-
-struct ExprAssignment final : public Uncopyable {
-  Token var_name;
-  ExprPtrVariant right;
-  ExprAssignment(Token var_name, ExprPtrVariant right);
-};
-
-struct ExprLogical final : public Uncopyable {
-  ExprPtrVariant left;
-  Token op;
-  ExprPtrVariant right;
-  ExprLogical(ExprPtrVariant left, Token op, ExprPtrVariant right);
-};
-
-struct ExprCall final : public Uncopyable {
-  ExprPtrVariant callee;
-  Token paren;
-  std::vector<ExprPtrVariant> arguments;
-  ExprCall(ExprPtrVariant callee, Token paren,
-           std::vector<ExprPtrVariant> arguments);
-};
-
-struct ExprFunction final : public Uncopyable {
-  std::vector<Token> parameters;
-  std::vector<StmtPtrVariant> body;
-  ExprFunction(std::vector<Token> parameters, std::vector<StmtPtrVariant> body);
-};
-
-struct ExprGet final : public Uncopyable {
-  ExprPtrVariant expr;
-  Token name;
-  ExprGet(ExprPtrVariant expr, Token name);
-};
-
-struct ExprSet final : public Uncopyable {
-  ExprPtrVariant expr;
-  Token name;
-  ExprPtrVariant value;
-  ExprSet(ExprPtrVariant expr, Token name, ExprPtrVariant value);
-};
-
-struct ExprThis final : public Uncopyable {
-  Token keyword;
-  explicit ExprThis(Token keyword);
-};
-
-struct ExprSuper final : public Uncopyable {
-  Token keyword;
-  Token method;
-  explicit ExprSuper(Token keyword, Token method);
-};
-
-// Statment AST types declaration
-struct StmtExpr final : public Uncopyable {
-  ExprPtrVariant expression;
-  explicit StmtExpr(ExprPtrVariant expr);
-};
-
-struct StmtPrint final : public Uncopyable {
-  ExprPtrVariant expression;
-  explicit StmtPrint(ExprPtrVariant expression);
-};
-
-struct StmtBlock final : public Uncopyable {
-  std::vector<StmtPtrVariant> statements;
-  explicit StmtBlock(std::vector<StmtPtrVariant> statements);
-};
-
-struct StmtVariable final : public Uncopyable {
-  Token var_name;
-  std::optional<ExprPtrVariant> initializer;
-  explicit StmtVariable(Token var_name, std::optional<ExprPtrVariant> initializer);
-};
-
-struct StmtIf final : public Uncopyable {
-  ExprPtrVariant condition;
-  StmtPtrVariant then_branch;
-  std::optional<StmtPtrVariant> else_branch;
-  explicit StmtIf(ExprPtrVariant condition, StmtPtrVariant then_branch,
-                  std::optional<StmtPtrVariant> else_branch);
-};
-
-struct StmtWhile final : public Uncopyable {
-  ExprPtrVariant condition;
-  StmtPtrVariant loop_body;
-  explicit StmtWhile(ExprPtrVariant condition, StmtPtrVariant loop_body);
-};
-
-struct StmtFor final : public Uncopyable {
-  std::optional<StmtPtrVariant> initializer;
-  std::optional<ExprPtrVariant> condition;
-  std::optional<ExprPtrVariant> increment;
-  StmtPtrVariant loop_body;
-  explicit StmtFor(std::optional<StmtPtrVariant> initializer,
-                   std::optional<ExprPtrVariant> condition,
-                   std::optional<ExprPtrVariant> increment,
-                   StmtPtrVariant loop_body);
-};
-
-struct StmtFunction : public Uncopyable {
-  Token function_name;
-  ExprFunctionPtr ExprFunction;
-  StmtFunction(Token function_name, ExprFunctionPtr ExprFunction);
-};
-
-struct StmtReturn : public Uncopyable {
-  Token ret;
-  std::optional<ExprPtrVariant> value;
-  StmtReturn(Token ret, std::optional<ExprPtrVariant> value);
-};
-
-struct StmtClass : public Uncopyable {
-  Token class_name;
-  std::optional<ExprPtrVariant> superClass;
-  std::vector<StmtPtrVariant> methods;
-  StmtClass(Token class_name, std::optional<ExprPtrVariant> superClass,
-            std::vector<StmtPtrVariant> methods);
-};
-
-} // namespace boop::AST
-
+#ifndef __ASTNODES_H__
+#define __ASTNODES_H__
+
+#include "Token.h"
+#include "Types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Alternative implementation of Stmt.h and Expr.h that does not rely on
+ * VTables and gets rid of performance overhead vtables incurr
+ *
+ */
+namespace boop::AST {
+
+// forward declaration of expression node types
+struct ExprBinary;
+struct ExprGrouping;
+struct ExprLiteral;
+struct ExprUnary;
+struct ExprConditional;
+struct ExprPostfix;
+struct ExprVariable;
+struct ExprAssignment;
+struct ExprLogical;
+struct ExprCall;
+struct ExprFunction;
+struct ExprGet;
+struct ExprSet;
+struct ExprThis;
+struct ExprSuper;
+struct ExprList;
+struct ExprIndex;
+struct ExprIndexSet;
+struct ExprSlice;
+struct ExprMap;
+struct ExprSpawn;
+struct ExprAwait;
+
+// reference manager assigned to smart pointer 
+using ExprBinaryPtr = std::unique_ptr<ExprBinary>;
+using ExprGroupingPtr = std::unique_ptr<ExprGrouping>;
+using ExprLiteralPtr = std::unique_ptr<ExprLiteral>;
+using ExprUnaryPtr = std::unique_ptr<ExprUnary>;
+using ExprConditionalPtr = std::unique_ptr<ExprConditional>;
+using ExprPostfixPtr = std::unique_ptr<ExprPostfix>;
+using ExprVariablePtr = std::unique_ptr<ExprVariable>;
+using ExprAssignmentPtr = std::unique_ptr<ExprAssignment>;
+using ExprLogicalPtr = std::unique_ptr<ExprLogical>;
+using ExprCallPtr = std::unique_ptr<ExprCall>;
+using ExprFunctionPtr = std::unique_ptr<ExprFunction>;
+using ExprGetPtr = std::unique_ptr<ExprGet>;
+using ExprSetPtr = std::unique_ptr<ExprSet>;
+using ExprThisPtr = std::unique_ptr<ExprThis>;
+using ExprSuperPtr = std::unique_ptr<ExprSuper>;
+using ExprListPtr = std::unique_ptr<ExprList>;
+using ExprIndexPtr = std::unique_ptr<ExprIndex>;
+using ExprIndexSetPtr = std::unique_ptr<ExprIndexSet>;
+using ExprSlicePtr = std::unique_ptr<ExprSlice>;
+using ExprMapPtr = std::unique_ptr<ExprMap>;
+using ExprSpawnPtr = std::unique_ptr<ExprSpawn>;
+using ExprAwaitPtr = std::unique_ptr<ExprAwait>;
+
+// union type for reference manager to handle statement nodes
+using ExprPtrVariant =
+    std::variant<ExprBinaryPtr, ExprGroupingPtr, ExprLiteralPtr, ExprUnaryPtr,
+                 ExprConditionalPtr, ExprPostfixPtr, ExprVariablePtr,
+                 ExprAssignmentPtr, ExprLogicalPtr, ExprCallPtr, ExprFunctionPtr,
+                 ExprGetPtr, ExprSetPtr, ExprThisPtr, ExprSuperPtr,
+                 ExprListPtr, ExprIndexPtr, ExprIndexSetPtr, ExprSlicePtr,
+                 ExprMapPtr, ExprSpawnPtr, ExprAwaitPtr>;
+                 
+// forward declaration of statement node types
+struct StmtExpr;
+struct StmtPrint;
+struct StmtBlock;
+struct StmtVariable;
+struct StmtIf;
+struct StmtWhile;
+struct StmtFor;
+struct StmtFunction;
+struct StmtReturn;
+struct StmtClass;
+struct StmtBreak;
+struct StmtContinue;
+
+// alias for automatic reference managers on each statement node types
+using ExprStmtPtr = std::unique_ptr<StmtExpr>;
+using PrintStmtPtr = std::unique_ptr<StmtPrint>;
+using BlockStmtPtr = std::unique_ptr<StmtBlock>;
+using VarStmtPtr = std::unique_ptr<StmtVariable>;
+using IfStmtPtr = std::unique_ptr<StmtIf>;
+using WhileStmtPtr = std::unique_ptr<StmtWhile>;
+using ForStmtPtr = std::unique_ptr<StmtFor>;
+using FuncStmtPtr = std::unique_ptr<StmtFunction>;
+using RetStmtPtr = std::unique_ptr<StmtReturn>;
+using ClassStmtPtr = std::unique_ptr<StmtClass>;
+using BreakStmtPtr = std::unique_ptr<StmtBreak>;
+using ContinueStmtPtr = std::unique_ptr<StmtContinue>;
+
+// union type for reference manager to handle statement nodes
+using StmtPtrVariant =
+    std::variant<ExprStmtPtr, PrintStmtPtr, BlockStmtPtr, VarStmtPtr, IfStmtPtr,
+                 WhileStmtPtr, ForStmtPtr, FuncStmtPtr, RetStmtPtr,
+                 ClassStmtPtr, BreakStmtPtr, ContinueStmtPtr>;
+
+// methods that creates expression nodes 
+auto make_binary_expr(ExprPtrVariant left, Token op, ExprPtrVariant right)
+    -> ExprPtrVariant;
+auto make_unary_expr(Token op, ExprPtrVariant right) -> ExprPtrVariant;
+auto make_grouping_expr(ExprPtrVariant right) -> ExprPtrVariant;
+auto make_literal_expr(OptionalLiteral literal) -> ExprPtrVariant;
+auto make_conditional_expr(ExprPtrVariant condition, ExprPtrVariant then,
+                          ExprPtrVariant else_branch) -> ExprPtrVariant;
+auto make_postfix_expr(ExprPtrVariant left, Token op) -> ExprPtrVariant;
+auto make_variable_expr(Token var_name) -> ExprPtrVariant;
+auto make_assignment_expr(Token var_name, ExprPtrVariant expr) -> ExprPtrVariant;
+auto make_logical_expr(ExprPtrVariant left, Token op, ExprPtrVariant right)
+    -> ExprPtrVariant;
+auto make_call_expr(ExprPtrVariant callee, Token paren,
+                   std::vector<ExprPtrVariant> arguments) -> ExprPtrVariant;
+auto make_function_expr(std::vector<Token> params,
+                   std::vector<StmtPtrVariant> fnBody) -> ExprPtrVariant;
+auto make_get_expr(ExprPtrVariant expr, Token name) -> ExprPtrVariant;
+auto make_set_expr(ExprPtrVariant expr, Token name, ExprPtrVariant value)
+    -> ExprPtrVariant;
+auto make_this_expr(Token keyword) -> ExprPtrVariant;
+auto make_super_expr(Token keyword, Token method) -> ExprPtrVariant;
+auto make_list_expr(Token bracket, std::vector<ExprPtrVariant> elements)
+    -> ExprPtrVariant;
+auto make_index_expr(ExprPtrVariant object, Token bracket, ExprPtrVariant index)
+    -> ExprPtrVariant;
+auto make_index_set_expr(ExprPtrVariant object, Token bracket,
+                         ExprPtrVariant index, ExprPtrVariant value)
+    -> ExprPtrVariant;
+auto make_slice_expr(ExprPtrVariant object, Token bracket,
+                     std::optional<ExprPtrVariant> begin,
+                     std::optional<ExprPtrVariant> end) -> ExprPtrVariant;
+auto make_map_expr(Token brace, std::vector<ExprPtrVariant> keys,
+                   std::vector<ExprPtrVariant> values) -> ExprPtrVariant;
+auto make_spawn_expr(Token keyword, ExprCallPtr call) -> ExprPtrVariant;
+auto make_await_expr(Token keyword, ExprPtrVariant future) -> ExprPtrVariant;
+
+
+
+// methods that creates statement nodes
+auto make_expr_stmt(ExprPtrVariant expr) -> StmtPtrVariant;
+auto make_print_stmt(ExprPtrVariant expr) -> StmtPtrVariant;
+auto make_block_stmt(std::vector<StmtPtrVariant> statements) -> StmtPtrVariant;
+auto make_var_stmt(Token var_name, std::optional<ExprPtrVariant> initializer)
+    -> StmtPtrVariant;
+auto make_if_stmt(ExprPtrVariant condition, StmtPtrVariant then_branch,
+                 std::optional<StmtPtrVariant> else_branch) -> StmtPtrVariant;
+auto make_while_stmt(ExprPtrVariant condition, StmtPtrVariant loop_body)
+    -> StmtPtrVariant;
+auto make_for_stmt(std::optional<StmtPtrVariant> initializer,
+                  std::optional<ExprPtrVariant> condition,
+                  std::optional<ExprPtrVariant> increment,
+                  StmtPtrVariant loop_body) -> StmtPtrVariant;
+auto make_function_stmt(Token fName, ExprFunctionPtr ExprFunction) -> StmtPtrVariant;
+auto make_return_stmt(Token ret, std::optional<ExprPtrVariant> value)
+    -> StmtPtrVariant;
+auto make_class_stmt(Token class_name, std::optional<ExprPtrVariant> superClass,
+                    std::vector<StmtPtrVariant> methods) -> StmtPtrVariant;
+auto make_break_stmt(Token keyword) -> StmtPtrVariant;
+auto make_continue_stmt(Token keyword) -> StmtPtrVariant;
+
+
+/**
+ * @brief location of the variable a node refers to, filled in by the Resolver:
+ * a slot of the running frame, one of the running closure's upvalues, or (for
+ * names that don't resolve) a global.
+ *
+ */
+struct ResolvedSlot {
+  enum class Kind : uint8_t { GLOBAL, LOCAL, UPVALUE };
+  Kind kind{Kind::GLOBAL};
+  uint32_t index{};
+
+  auto is_global() const noexcept -> bool { return kind == Kind::GLOBAL; }
+};
+
+/**
+ * @brief what a closure captures when it is created: a slot of the enclosing
+ * frame (`is_local`) or one of the enclosing closure's own upvalues.
+ *
+ */
+struct UpvalueDescriptor {
+  bool is_local{false};
+  uint32_t index{};
+};
+
+/**
+ * @brief handlers a binary node can be rewritten to (quickened) once the
+ * evaluator has observed stable operand types on it. Every specialized handler
+ * guards its type assumption and falls back to GENERIC when it fails.
+ *
+ */
+enum class BinaryHandler : uint8_t {
+  GENERIC,
+  DOUBLE_ADD,
+  DOUBLE_SUB,
+  DOUBLE_MUL,
+  DOUBLE_DIV,
+  DOUBLE_LESS,
+  DOUBLE_LESS_EQUAL,
+  DOUBLE_GREATER,
+  DOUBLE_GREATER_EQUAL,
+  DOUBLE_EQUAL_EQUAL,
+  DOUBLE_BANG_EQUAL,
+  INT_ADD,
+  INT_SUB,
+  INT_MUL,
+  INT_LESS,
+  INT_LESS_EQUAL,
+  INT_GREATER,
+  INT_GREATER_EQUAL,
+  INT_EQUAL_EQUAL,
+  INT_BANG_EQUAL,
+  STRING_ADD
+};
+
+// Expression AST Types member declaration:
+struct ExprBinary final : public Uncopyable {
+  ExprPtrVariant left;
+  Token op;
+  ExprPtrVariant right;
+  // quickening state, owned by the evaluator. A shared Program is evaluated
+  // by several threads at once, so these are only accessed with relaxed
+  // atomics; a racing update leaves at worst a handler whose type guard fails
+  std::atomic<BinaryHandler> handler{BinaryHandler::GENERIC};
+  // operand type indices seen on the last generic run
+  std::atomic<uint8_t> observed_left{};
+  std::atomic<uint8_t> observed_right{};
+  std::atomic<uint8_t> stable_hits{}; // consecutive generic runs, same types
+  std::atomic<uint8_t> deopt_count{};
+  ExprBinary(ExprPtrVariant left, Token op, ExprPtrVariant right);
+};
+
+struct ExprGrouping final : public Uncopyable {
+  ExprPtrVariant expression;
+  explicit ExprGrouping(ExprPtrVariant expression);
+};
+
+struct ExprLiteral final : public Uncopyable {
+  OptionalLiteral literalVal;
+  BoopObject value{nullptr}; // runtime value, built once by the Resolver
+  explicit ExprLiteral(OptionalLiteral value);
+};
+
+struct ExprUnary final : public Uncopyable {
+  Token op;
+  ExprPtrVariant right;
+  ExprUnary(Token op, ExprPtrVariant right);
+};
+
+struct ExprConditional final : public Uncopyable {
+  ExprPtrVariant condition;
+  ExprPtrVariant then_branch;
+  ExprPtrVariant else_branch;
+  ExprConditional(ExprPtrVariant condition, ExprPtrVariant then_branch,
+                  ExprPtrVariant else_branch);
+};
+
+struct ExprPostfix final : public Uncopyable {
+  ExprPtrVariant left;
+  Token op;
+  ExprPostfix(ExprPtrVariant left, Token op);
+};
+
+struct ExprVariable final : public Uncopyable {
+  Token var_name;
+  ResolvedSlot resolved;
+  explicit ExprVariable(Token var_name);
+};
+
+struct ExprAssignment final : public Uncopyable {
+  Token var_name;
+  ExprPtrVariant right;
+  ResolvedSlot resolved;
+  ExprAssignment(Token var_name, ExprPtrVariant right);
+};
+
+struct ExprLogical final : public Uncopyable {
+  ExprPtrVariant left;
+  Token op;
+  ExprPtrVariant right;
+  ExprLogical(ExprPtrVariant left, Token op, ExprPtrVariant right);
+};
+
+struct ExprCall final : public Uncopyable {
+  ExprPtrVariant callee;
+  Token paren;
+  std::vector<ExprPtrVariant> arguments;
+  // `return f(...)` outside of an initializer; set by the Resolver
+  bool is_tail_call{false};
+  ExprCall(ExprPtrVariant callee, Token paren,
+           std::vector<ExprPtrVariant> arguments);
+};
+
+struct ExprFunction final : public Uncopyable {
+  std::vector<Token> parameters;
+  std::vector<StmtPtrVariant> body;
+  // frame layout and captured variables, filled in by the Resolver
+  uint32_t frame_size{};
+  std::vector<UpvalueDescriptor> upvalues;
+  ExprFunction(std::vector<Token> parameters, std::vector<StmtPtrVariant> body);
+};
+
+struct ExprGet final : public Uncopyable {
+  ExprPtrVariant expr;
+  Token name;
+  ExprGet(ExprPtrVariant expr, Token name);
+};
+
+struct ExprSet final : public Uncopyable {
+  ExprPtrVariant expr;
+  Token name;
+  ExprPtrVariant value;
+  ExprSet(ExprPtrVariant expr, Token name, ExprPtrVariant value);
+};
+
+struct ExprThis final : public Uncopyable {
+  Token keyword;
+  ResolvedSlot resolved;
+  explicit ExprThis(Token keyword);
+};
+
+struct ExprSuper final : public Uncopyable {
+  Token keyword;
+  Token method;
+  ResolvedSlot resolved;
+  ResolvedSlot this_resolved;
+  explicit ExprSuper(Token keyword, Token method);
+};
+
+// [a, b, c]
+struct ExprList final : public Uncopyable {
+  Token bracket;
+  std::vector<ExprPtrVariant> elements;
+  ExprList(Token bracket, std::vector<ExprPtrVariant> elements);
+};
+
+// object[index]
+struct ExprIndex final : public Uncopyable {
+  ExprPtrVariant object;
+  Token bracket;
+  ExprPtrVariant index;
+  ExprIndex(ExprPtrVariant object, Token bracket, ExprPtrVariant index);
+};
+
+// object[index] = value
+struct ExprIndexSet final : public Uncopyable {
+  ExprPtrVariant object;
+  Token bracket;
+  ExprPtrVariant index;
+  ExprPtrVariant value;
+  ExprIndexSet(ExprPtrVariant object, Token bracket, ExprPtrVariant index,
+               ExprPtrVariant value);
+};
+
+// object[begin:end]; either bound may be left out
+struct ExprSlice final : public Uncopyable {
+  ExprPtrVariant object;
+  Token bracket;
+  std::optional<ExprPtrVariant> begin;
+  std::optional<ExprPtrVariant> end;
+  ExprSlice(ExprPtrVariant object, Token bracket,
+            std::optional<ExprPtrVariant> begin,
+            std::optional<ExprPtrVariant> end);
+};
+
+// {key: value, ...}; keys[i] goes with values[i]
+struct ExprMap final : public Uncopyable {
+  Token brace;
+  std::vector<ExprPtrVariant> keys;
+  std::vector<ExprPtrVariant> values;
+  ExprMap(Token brace, std::vector<ExprPtrVariant> keys,
+          std::vector<ExprPtrVariant> values);
+};
+
+// spawn f(args), made by a task (see Tasks.h), or go f(args) and
+// async f(args), made by a fiber (see Fibers.h)
+struct ExprSpawn final : public Uncopyable {
+  Token keyword;
+  ExprCallPtr call;
+  ExprSpawn(Token keyword, ExprCallPtr call);
+};
+
+struct ExprAwait final : public Uncopyable {
+  Token keyword;
+  ExprPtrVariant future;
+  ExprAwait(Token keyword, ExprPtrVariant future);
+};
+
+// Statment AST types declaration
+struct StmtExpr final : public Uncopyable {
+  ExprPtrVariant expression;
+  explicit StmtExpr(ExprPtrVariant expr);
+};
+
+struct StmtPrint final : public Uncopyable {
+  ExprPtrVariant expression;
+  explicit StmtPrint(ExprPtrVariant expression);
+};
+
+struct StmtBlock final : public Uncopyable {
+  std::vector<StmtPtrVariant> statements;
+  // slots of the locals declared directly in this block
+  uint32_t local_begin{};
+  uint32_t local_end{};
+  explicit StmtBlock(std::vector<StmtPtrVariant> statements);
+};
+
+struct StmtVariable final : public Uncopyable {
+  Token var_name;
+  std::optional<ExprPtrVariant> initializer;
+  ResolvedSlot resolved;
+  explicit StmtVariable(Token var_name, std::optional<ExprPtrVariant> initializer);
+};
+
+struct StmtIf final : public Uncopyable {
+  ExprPtrVariant condition;
+  StmtPtrVariant then_branch;
+  std::optional<StmtPtrVariant> else_branch;
+  explicit StmtIf(ExprPtrVariant condition, StmtPtrVariant then_branch,
+                  std::optional<StmtPtrVariant> else_branch);
+};
+
+struct StmtWhile final : public Uncopyable {
+  ExprPtrVariant condition;
+  StmtPtrVariant loop_body;
+  explicit StmtWhile(ExprPtrVariant condition, StmtPtrVariant loop_body);
+};
+
+struct StmtFor final : public Uncopyable {
+  std::optional<StmtPtrVariant> initializer;
+  std::optional<ExprPtrVariant> condition;
+  std::optional<ExprPtrVariant> increment;
+  StmtPtrVariant loop_body;
+  explicit StmtFor(std::optional<StmtPtrVariant> initializer,
+                   std::optional<ExprPtrVariant> condition,
+                   std::optional<ExprPtrVariant> increment,
+                   StmtPtrVariant loop_body);
+};
+
+struct StmtFunction : public Uncopyable {
+  Token function_name;
+  ExprFunctionPtr ExprFunction;
+  ResolvedSlot resolved;
+  StmtFunction(Token function_name, ExprFunctionPtr ExprFunction);
+};
+
+struct StmtReturn : public Uncopyable {
+  Token ret;
+  std::optional<ExprPtrVariant> value;
+  StmtReturn(Token ret, std::optional<ExprPtrVariant> value);
+};
+
+struct StmtClass : public Uncopyable {
+  Token class_name;
+  std::optional<ExprPtrVariant> superClass;
+  std::vector<StmtPtrVariant> methods;
+  ResolvedSlot resolved;
+  ResolvedSlot super_resolved; // slot holding 'super' for the methods
+  StmtClass(Token class_name, std::optional<ExprPtrVariant> superClass,
+            std::vector<StmtPtrVariant> methods);
+};
+
+struct StmtBreak : public Uncopyable {
+  Token keyword;
+  explicit StmtBreak(Token keyword);
+};
+
+struct StmtContinue : public Uncopyable {
+  Token keyword;
+  explicit StmtContinue(Token keyword);
+};
+
+} // namespace boop::AST
+
 #endif // __ASTNODES_H__
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef __BOOPMAP_H__
+#define __BOOPMAP_H__
+
+/**
+ * @file BoopMap.h
+ * @brief the Map value: an open-addressing hash table keyed by strings,
+ * numbers and booleans
+ *
+ */
+
+#include "Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace boop {
+
+/**
+ * @brief hash table in the style of a Swiss table. Every slot has a one byte
+ * control word holding either EMPTY, DELETED or the low 7 bits of the key's
+ * hash; a lookup compares a whole group of control words against those bits
+ * at once (SSE2 where available, 8 at a time in a 64-bit word otherwise) and
+ * only looks at the keys whose bits matched.
+ *
+ * The slots hold indices into a dense vector of entries kept in insertion
+ * order, which is also the order the map is iterated in. Erasing leaves a
+ * hole in that vector; holes are squeezed out when the table is rebuilt.
+ *
+ * Keys are compared like `==` compares them, so 1 and 1.0 are the same key.
+ *
+ */
+class BoopMap : public Uncopyable, public Freezable {
+public:
+  struct Entry {
+    BoopObject key;   // nil once the entry has been erased
+    BoopObject value;
+    size_t hash{};
+
+    auto is_live() const noexcept -> bool {
+      return !std::holds_alternative<std::nullptr_t>(key);
+    }
+  };
+
+  BoopMap() = default;
+
+  // strings, booleans and numbers other than NaN
+  static auto is_valid_key(const BoopObject &key) noexcept -> bool;
+
+  // the value stored under `key`, or nullptr; never fails, not even for keys
+  // that can't be stored
+  auto find(const BoopObject &key) const -> const BoopObject *;
+  auto contains(const BoopObject &key) const -> bool;
+  // `key` must be a valid key
+  auto set(const BoopObject &key, BoopObject value) -> void;
+  // whether there was something to erase
+  auto erase(const BoopObject &key) -> bool;
+  // makes room for `count` keys without rebuilding the table
+  auto reserve(size_t count) -> void;
+
+  auto size() const noexcept -> size_t { return m_size; }
+  // insertion-ordered; skip the entries that aren't live
+  auto entries() const noexcept -> const std::vector<Entry> & {
+    return m_entries;
+  }
+
+private:
+  static const size_t NOT_FOUND = SIZE_MAX;
+
+  std::vector<int8_t> m_ctrl;    // one control word per slot
+  std::vector<uint32_t> m_slots; // index into m_entries of each full slot
+  std::vector<Entry> m_entries;
+  size_t m_group_count{};
+  size_t m_size{};        // live entries
+  size_t m_growth_left{}; // inserts into EMPTY slots left before a rebuild
+
+  auto capacity() const noexcept -> size_t;
+  auto find_slot(const BoopObject &key, size_t hash) const -> size_t;
+  auto find_insert_slot(size_t hash) const -> size_t;
+  auto rehash(size_t min_size) -> void;
+};
+
+} // namespace boop
+
+#endif // __BOOPMAP_H__
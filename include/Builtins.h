@@ -0,0 +1,157 @@
+#ifndef __BUILTINS_H__
+#define __BUILTINS_H__
+
+/**
+ * @file Builtins.h
+ * @brief functions every script can call without importing anything
+ *
+ */
+
+namespace boop {
+
+class Evaluator;
+
+/**
+ * @brief defines the core builtins as globals of `evaluator`:
+ *
+ *   clock()           milliseconds since the epoch
+ *   len(x)            number of elements of a list, map or Float64Array, or
+ *                     bytes of a string
+ *   push(list, value) appends `value` to `list`
+ *   pop(list)         removes and returns the last element of `list`
+ *   get(map, key)     the value under `key`, or nil
+ *   set(map, key, v)  stores `v` under `key`
+ *   has(map, key)     whether `key` is in `map`
+ *   delete(map, key)  removes `key`; returns whether it was there
+ *   keys(map)         list of the keys, in insertion order
+ *   values(map)       list of the values, in insertion order
+ *
+ */
+auto define_core_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the Float64Array constructor and the builtins that run a
+ * native kernel over whole arrays:
+ *
+ *   Float64Array(x)   zeroed array of x elements, or a copy of a list of
+ *                     numbers or of another array
+ *   to_list(a)        the elements of `a` as a list
+ *   sum(a), dot(a, b), amin(a), amax(a)
+ *   scale(a, s)       new array of a[i] * s
+ *   fma(a, b, c)      new array of a[i] * b[i] + c[i]
+ *   cumsum(a)         new array of running totals
+ *
+ * `+ - * /` between two arrays of equal length, or an array and a number,
+ * are element-wise as well.
+ *
+ */
+auto define_array_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the math library. Every function takes numbers or, in
+ * place of any number, a Float64Array, in which case it's applied to each
+ * element in a native loop and returns a new array:
+ *
+ *   sqrt exp log sin cos tan asin acos atan floor ceil abs   (x)
+ *   pow atan2 min max                                        (x, y)
+ *   random()          uniform double in [0, 1) from xoshiro256**
+ *   random(n)         Float64Array of n such doubles
+ *   random_int(a, b)  uniform integer in [a, b]
+ *   random_seed(n)    restarts the generator from `n`
+ *   PI, E             constants
+ *
+ * sqrt, floor, ceil, abs, min and max use the SIMD kernels of Kernels.h.
+ * min and max are NaN if either operand is, like amin and amax of an array
+ * holding a NaN.
+ *
+ */
+auto define_math_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the builtins that go with `spawn` and `await` (Tasks.h):
+ *
+ *   freeze(x)         deep-freezes `x` so tasks can share it; returns `x`
+ *   is_frozen(x)      whether `x` is a frozen container or instance
+ *   copy(x)           deep copy of `x` that can be modified, even if `x` is
+ *                     frozen
+ *   join(futures)     awaits a list of futures, in order; list of results
+ *
+ *   parallel_map(xs, f)        list of f(x) for each x
+ *   parallel_filter(xs, f)     the x for which f(x) is true, as a list or
+ *                              Float64Array like `xs`
+ *   parallel_reduce(xs, f, v)  f(...f(f(v, x0), x1)..., xn) for an
+ *                              associative `f`
+ *
+ * The parallel builtins take a list or a Float64Array and split it into
+ * chunks that tasks work through; the results keep the order of `xs`. A
+ * function that captures variables, or a method of an instance that isn't
+ * frozen, runs over all of `xs` on the calling thread instead.
+ *
+ * push, pop, set and delete fail on frozen lists and maps, as do assignments
+ * to their elements and to the fields of frozen instances.
+ *
+ */
+auto define_task_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the builtins fibers (Fibers.h) and threads (Ports.h) talk
+ * through:
+ *
+ *   channel(n)        new channel buffering up to n values
+ *   port(n)           new port buffering at least n values
+ *   send(ch, v)       queues `v`, waiting while `ch` is full
+ *   recv(ch)          the next value, waiting while `ch` is empty; nil once
+ *                     `ch` is closed and empty
+ *   close(ch)         refuses further sends and wakes everyone waiting
+ *   select(chs)       [ch, value] from whichever of a list of channels has a
+ *                     value first; nil once all are closed and empty
+ *   yield()           lets the other fibers that can run take a turn
+ *
+ * send, recv and close take a channel or a port. A value sent to a port is
+ * transferred to the receiving thread (see Sharing.h). close also closes
+ * streams.
+ *
+ */
+auto define_channel_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the builtins for files, pipes and Unix sockets (Streams.h),
+ * which park the calling fiber rather than block the thread:
+ *
+ *   open(path, mode)  stream reading ("r"), truncating ("w") or appending to
+ *                     ("a") the file at `path`
+ *   pipe()            [reader, writer] ends of a new pipe
+ *   socketpair()      [a, b], two connected sockets
+ *   listen(path)      socket accepting connections at `path`
+ *   connect(path)     stream connected to the socket listening at `path`
+ *   accept(s)         stream of the next connection to the listening `s`
+ *   read(s, n)        up to n bytes, whatever arrived; nil at the end
+ *   readline(s)       the next line without its "\n"; nil at the end
+ *   write(s, str)     writes all of `str`
+ *
+ */
+auto define_stream_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the builtins for whole files:
+ *
+ *   lines(path)            stream over the file at `path` to readline from,
+ *                          mapped into memory rather than read into a buffer
+ *   read_all(path)         the content of the file at `path`
+ *   write_all(path, str)   replaces the content of the file at `path`
+ *
+ */
+auto define_file_builtins(Evaluator &evaluator) -> void;
+
+/**
+ * @brief defines the builtins converting to and from JSON (Json.h):
+ *
+ *   json_parse(str)       the value the JSON text `str` encodes
+ *   json_stringify(x)     `x` as compact JSON text
+ *
+ */
+auto define_json_builtins(Evaluator &evaluator) -> void;
+
+} // namespace boop
+
+#endif // __BUILTINS_H__
@@ -1,64 +1,140 @@
-#ifndef __ENVIRONMENT_H__
-#define __ENVIRONMENT_H__
-
-#include "ErrorHandler.h"
-#include "Token.h"
-#include "Types.h"
-
-#include <cstddef>
-#include <exception>
-// #include <list>
-#include <map>
-#include <memory>
-#include <optional>
-
-namespace boop {
-
-class Environment : public Uncopyable,
-                    public std::enable_shared_from_this<Environment> {
-public:
-  using EnvironmentPtr = std::shared_ptr<Environment>;
-
-private:
-  std::map<size_t, BoopObject> m_objects;
-  EnvironmentPtr m_parent_env{nullptr};
-
-public:
-  explicit Environment(EnvironmentPtr parent_env);
-
-  auto assign(size_t hashed_var_name, BoopObject object) -> bool;
-  auto define(size_t hashed_var_name, BoopObject object) -> void;
-  auto get(size_t hashed_var_name) -> BoopObject;
-  auto get_parent_env() -> EnvironmentPtr;
-
-  auto is_global() -> bool;
-};
-
-class EnvironmentManager : public Uncopyable {
-private:
-  ErrorHandler &m_error_handler;
-  Environment::EnvironmentPtr m_current_env;
-  std::hash<std::string> m_hasher;
-
-public:
-  explicit EnvironmentManager(ErrorHandler &reporter);
-
-  auto assign(const Token &variable, BoopObject object) -> void;
-  auto create_new_env(const std::string &caller = __builtin_FUNCTION()) -> void;
-  auto discard_envs_till(const Environment::EnvironmentPtr &env_to_restore,
-                         const std::string &caller = __builtin_FUNCTION())
-      -> void;
-
-  auto define(const std::string &token_str, BoopObject object) -> void;
-  auto define(const Token &var_token, BoopObject object) -> void;
-  auto get(const Token &var_token) -> BoopObject;
-//   auto get(const std::string &var_token) -> BoopObject;
-  auto get_current_env() -> Environment::EnvironmentPtr;
-  auto set_current_env(Environment::EnvironmentPtr new_current,
-                       const std::string &callee = __builtin_FUNCTION())
-      -> void;
-};
-
-} // namespace boop
-
+#ifndef __ENVIRONMENT_H__
+#define __ENVIRONMENT_H__
+
+#include "ASTNodes.h"
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace boop {
+
+class EnvironmentManager : public Uncopyable {
+public:
+  using GlobalTable = std::unordered_map<size_t, BoopObject>;
+  using SharedGlobalsPtr = std::shared_ptr<const GlobalTable>;
+
+  /**
+   * @brief the running frame, saved by `push_frame` and handed back to
+   * `pop_frame` to return to the caller
+   *
+   */
+  struct Frame {
+    BoopObject *slots{nullptr};
+    const std::vector<UpvaluePtr> *upvalues{nullptr}; // of the running closure
+    size_t base{};
+  };
+
+  /**
+   * @brief a value stack of its own, with its frames and open upvalues, for
+   * a fiber (see Fibers.h). Only the running fiber's stack is in the manager;
+   * the others are parked in their fibers.
+   *
+   */
+  struct Stack {
+    std::vector<BoopObject> values;
+    std::vector<UpvaluePtr> open_upvalues;
+    Frame frame;
+    size_t max_slots{};
+
+    Stack() = default;
+    explicit Stack(size_t slots) : max_slots(slots) { values.reserve(slots); }
+  };
+
+private:
+  static const size_t MAX_STACK_SLOTS = 1 << 16;
+  ErrorHandler &m_error_handler;
+  std::vector<BoopObject> m_stack; // capacity is fixed so slots never move
+  size_t m_max_slots{MAX_STACK_SLOTS};
+  Frame m_frame;
+  // open upvalues of all live frames, sorted by the stack index they point at
+  std::vector<UpvaluePtr> m_open_upvalues;
+  GlobalTable m_globals;
+  std::hash<std::string> m_hasher;
+  // globals of the script that spawned the running task, read-only
+  SharedGlobalsPtr m_shared_globals;
+  // what `share_globals` last handed out; dropped whenever a global changes
+  SharedGlobalsPtr m_globals_snapshot;
+
+public:
+  explicit EnvironmentManager(ErrorHandler &reporter);
+
+  // the value stack, arguments are pushed here to become the callee's slots
+  auto stack_top() const noexcept -> size_t;
+  auto push_value(BoopObject value) -> Status;
+  auto truncate_stack(size_t top) -> void;
+  // stable for as long as the value is on the stack
+  auto stack_at(size_t index) noexcept -> const BoopObject *;
+
+  /**
+   * @brief makes the slots from `base` up to `base + frame_size` the running
+   * frame of the closure owning `upvalues`, which must outlive the call.
+   * Returns `Status::STACK_OVERFLOW` if the stack is full.
+   *
+   */
+  auto push_frame(size_t base, size_t frame_size,
+                  const std::vector<UpvaluePtr> *upvalues, Frame &caller)
+      -> Status;
+  // closes the upvalues of the running frame before returning to `caller`
+  auto pop_frame(Frame caller) -> void;
+  // pops the running frame for a tail call: the values from `keep_begin` up
+  // (the callee's receiver and arguments) move down to the frame's base
+  auto pop_frame_keeping(Frame caller, size_t keep_begin) -> void;
+  auto get_frame() const noexcept -> Frame;
+  // exchanges the running stack with `stack`; the slots don't move, so
+  // frames and open upvalues stay valid while their stack is parked
+  auto swap_stack(Stack &stack) noexcept -> void;
+  // returns to `frame` with the stack cut back to `top` (closing the upvalues
+  // above it), for abandoning an evaluation that was cut short by a throw
+  auto unwind(Frame frame, size_t top) -> void;
+
+  /**
+   * @brief builds the upvalues of a closure created in the running frame:
+   * local captures share one open upvalue per slot, the rest are taken over
+   * from the running closure.
+   *
+   */
+  auto capture(const std::vector<AST::UpvalueDescriptor> &descriptors)
+      -> std::vector<UpvaluePtr>;
+  // closes the upvalues of running frame slots `begin` and above and clears
+  // the slots up to `end`, done when the scope declaring them ends
+  auto close_slots(size_t begin, size_t end) -> void;
+
+  auto assign(const Token &variable, const AST::ResolvedSlot &resolved,
+              BoopObject object) -> Status;
+  auto define(const Token &var_token, const AST::ResolvedSlot &resolved,
+              BoopObject object) -> void;
+  auto define_global(const std::string &token_str, BoopObject object) -> void;
+  // the global `name`, or nullptr if it isn't defined
+  auto find_global(const std::string &name) const -> const BoopObject *;
+
+  /**
+   * @brief the globals for a task spawned from here to read: a copy of this
+   * evaluator's own, minus the builtins (a task has its own), with strings
+   * flattened. A task sees the globals of the script it was spawned from as
+   * they were when it was spawned. The copy is only rebuilt once a global has
+   * been defined or assigned since the last one.
+   *
+   */
+  auto share_globals() -> SharedGlobalsPtr;
+  // makes `globals` readable after this evaluator's own; returns the ones
+  // they replace
+  auto set_shared_globals(SharedGlobalsPtr globals) -> SharedGlobalsPtr;
+  auto get(const Token &var_token, const AST::ResolvedSlot &resolved)
+      -> Result<BoopObject>;
+
+private:
+  auto find_shared_global(const Token &var_token) -> const BoopObject *;
+  auto slot_at(const AST::ResolvedSlot &resolved) -> BoopObject &;
+  auto close_upvalues(size_t stack_index) -> void;
+};
+
+} // namespace boop
+
 #endif // __ENVIRONMENT_H__
\ No newline at end of file
@@ -1,56 +1,141 @@
-#ifndef __ERRORHANDLER_H__
-#define __ERRORHANDLER_H__
-
-#include "Token.h"
-#include "Types.h"
-
-#include <exception>
-#include <stdexcept>
-#include <string>
-#include <vector>
-
-
-namespace boop {
-
-struct ErrorHandler {
-  ErrorHandler() = default;
-
-  /**
-   * @brief reports the error encountered.
-   *
-   */
-  auto report() const -> void;
-
-  /**
-   * @brief add information about an error encountered which will be included in
-   * the `error_list`
-   *
-   * @param line
-   * @param msg
-   */
-  auto add(int line, const std::string &msg) -> void;
-
-  /**
-   * @brief clears the data of `error_list`
-   *
-   */
-  auto clear() -> void;
-
-  /**
-   * @brief helper function that tells whether an error has occurred
-   *
-   */
-  bool has_found_error{};
-
-private:
-  std::vector<std::string> error_list;
-};
-
-class RuntimeError : std::exception {};
-
-auto report_runtime_error(ErrorHandler &reporter, const Token &token,
-                          const std::string &msg) -> RuntimeError;
-
-} // namespace boop
-
+#ifndef __ERRORHANDLER_H__
+#define __ERRORHANDLER_H__
+
+#include "Token.h"
+#include "Types.h"
+
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace boop {
+
+struct ErrorHandler {
+  ErrorHandler() = default;
+
+  /**
+   * @brief reports the error encountered.
+   *
+   */
+  auto report() const -> void;
+
+  /**
+   * @brief add information about an error encountered which will be included in
+   * the `error_list`
+   *
+   * @param line
+   * @param msg
+   */
+  auto add(int line, const std::string &msg) -> void;
+
+  /**
+   * @brief clears the data of `error_list` and resets `has_found_error`
+   *
+   */
+  auto clear() -> void;
+
+  /**
+   * @brief the errors added since the last `clear`, formatted like `report`
+   * prints them
+   *
+   */
+  auto get_errors() const noexcept -> const std::vector<std::string> &;
+
+  /**
+   * @brief removes and returns the errors added after the first `count`,
+   * e.g. those of one task out of all its thread has reported
+   *
+   */
+  auto take_errors(size_t count) -> std::vector<std::string>;
+
+  /**
+   * @brief helper function that tells whether an error has occurred
+   *
+   */
+  bool has_found_error{};
+
+private:
+  std::vector<std::string> error_list;
+};
+
+/**
+ * @brief outcome of a runtime operation. Anything other than `OK` means the
+ * operation failed; errors raised through `report_runtime_error` have already
+ * been added to the `ErrorHandler` by the time the status is seen.
+ *
+ */
+enum class Status : uint8_t {
+  OK,
+  UNDEFINED_VARIABLE,
+  UNINITIALIZED_VARIABLE,
+  STACK_OVERFLOW,
+  RUNTIME_ERROR
+};
+
+/**
+ * @brief value-or-status returned along the runtime's hot paths. Propagating a
+ * failure is a plain return instead of a stack unwind.
+ *
+ * @tparam T
+ */
+template <typename T> struct Result {
+  T value{};
+  Status status{Status::OK};
+
+  Result(Status _status) : status(_status) {}
+
+  template <typename U,
+            typename = std::enable_if_t<
+                std::is_constructible_v<T, U &&> &&
+                !std::is_same_v<std::decay_t<U>, Status> &&
+                !std::is_same_v<std::decay_t<U>, Result<T>>>>
+  Result(U &&_value) : value(std::forward<U>(_value)) {}
+
+  auto ok() const noexcept -> bool { return status == Status::OK; }
+};
+
+/**
+ * @brief thrown only for fatal conditions where evaluation has to be abandoned
+ * altogether (e.g. too many runtime errors); ordinary runtime errors travel as
+ * a `Status`.
+ *
+ */
+class RuntimeError : public std::exception {};
+
+/**
+ * @brief adds `msg` to the reporter and returns `Status::RUNTIME_ERROR` so the
+ * caller can propagate it with a plain `return`.
+ *
+ */
+auto report_runtime_error(ErrorHandler &reporter, const Token &token,
+                          const std::string &msg) -> Status;
+
+#define BOOP_CONCAT_IMPL(a, b) a##b
+#define BOOP_CONCAT(a, b) BOOP_CONCAT_IMPL(a, b)
+
+// returns the status from the enclosing function if it isn't Status::OK
+#define RETURN_IF_ERROR(status_expr)                                           \
+  do {                                                                         \
+    const ::boop::Status _boop_status = (status_expr);                         \
+    if (__builtin_expect(_boop_status != ::boop::Status::OK, 0))               \
+      return _boop_status;                                                     \
+  } while (0)
+
+// evaluates a Result, propagates its status on failure or moves its value
+// into `lhs` (which may be a declaration) otherwise
+#define ASSIGN_OR_RETURN(lhs, result_expr)                                     \
+  ASSIGN_OR_RETURN_IMPL(BOOP_CONCAT(_boop_result_, __LINE__), lhs, result_expr)
+#define ASSIGN_OR_RETURN_IMPL(tmp, lhs, result_expr)                           \
+  auto tmp = (result_expr);                                                    \
+  if (__builtin_expect(!tmp.ok(), 0))                                          \
+    return tmp.status;                                                         \
+  lhs = std::move(tmp.value)
+
+} // namespace boop
+
 #endif // __ERRORHANDLER_H__
\ No newline at end of file
@@ -1,75 +1,232 @@
-#ifndef __EVALUATOR_H__
-#define __EVALUATOR_H__
-
-#include "ASTNodes.h"
-#include "ErrorHandler.h"
-#include "Environment.h"
-#include "Types.h"
-#include "Token.h"
-
-#include <exception>
-#include <memory>
-#include <string>
-#include <vector>
-
-namespace boop {
-
-class Evaluator {
-private: 
-    static const int MAX_RUNTIME_ERR = 20;
-    int m_runtime_err_count {};
-    ErrorHandler& m_error_handler;
-    EnvironmentManager m_env_manager; 
-
-public: 
-    explicit Evaluator(ErrorHandler& error_handler);
-
-    auto evaluate_expr(const AST::ExprPtrVariant& expr) -> BoopObject;
-    auto evaluate_stmt(const AST::StmtPtrVariant& stmt) -> std::optional<BoopObject>;
-    auto evaluate_stmts(const std::vector<AST::StmtPtrVariant> &stmt)
-        -> std::optional<BoopObject>;
-
-  private:
-    // methods for evaluating Expr types
-    auto evaluate_binary_expr(const AST::ExprBinaryPtr &expr) -> BoopObject;
-    auto evaluate_grouping_expr(const AST::ExprGroupingPtr &expr) -> BoopObject;
-    static auto evaluate_literal_expr(const AST::ExprLiteralPtr &expr) -> BoopObject;
-    auto evaluate_unary_expr(const AST::ExprUnaryPtr &expr) -> BoopObject;
-    auto evaluate_conditional_expr(const AST::ExprConditionalPtr &expr) -> BoopObject;
-    auto evaluate_postfix_expr(const AST::ExprPostfixPtr &expr) -> BoopObject;
-    auto evaluate_variable_expr(const AST::ExprVariablePtr &expr) -> BoopObject;
-    auto evaluate_assignment_expr(const AST::ExprAssignmentPtr &expr) -> BoopObject;
-    auto evaluate_logical_expr(const AST::ExprLogicalPtr &expr) -> BoopObject;
-    auto evaluate_call_expr(const AST::ExprCallPtr &expr) -> BoopObject;
-    auto evaluate_function_expr(const AST::ExprFunctionPtr &expr) -> BoopObject;
-    auto evaluate_get_expr(const AST::ExprGetPtr &expr) -> BoopObject;
-    auto evaluate_set_expr(const AST::ExprSetPtr &expr) -> BoopObject;
-    auto evaluate_this_expr(const AST::ExprThisPtr &expr) -> BoopObject;
-    auto evaluate_super_expr(const AST::ExprSuperPtr &expr) -> BoopObject;
-
-    // methods for evaluating Stmt types
-    auto evaluate_expr_stmt(const AST::ExprStmtPtr &stmt)
-        -> std::optional<BoopObject>;
-    auto evaluate_print_stmt(const AST::PrintStmtPtr &stmt)
-        -> std::optional<BoopObject>;
-    auto evaluate_block_stmt(const AST::BlockStmtPtr &stmt)
-        -> std::optional<BoopObject>;
-    auto evaluate_var_stmt(const AST::VarStmtPtr &stmt) -> std::optional<BoopObject>;
-    auto evaluate_if_stmt(const AST::IfStmtPtr &stmt) -> std::optional<BoopObject>;
-    auto evaluate_while_stmt(const AST::WhileStmtPtr &stmt)
-        -> std::optional<BoopObject>;
-    auto evaluate_for_stmt(const AST::ForStmtPtr &stmt) -> std::optional<BoopObject>;
-    auto evaluate_function_stmt(const AST::FuncStmtPtr &stmt) -> std::optional<BoopObject>;
-    auto evaluate_return_stmt(const AST::RetStmtPtr &stmt) -> std::optional<BoopObject>;
-    auto evaluate_class_stmt(const AST::ClassStmtPtr &stmt)
-        -> std::optional<BoopObject>;
-
-    // throws RuntimeError if right isn't a double
-    auto get_double(const Token &token, const BoopObject &right) -> double;
-    auto bind_instance(const FuncShrdPtr &method, LoxInstanceShrdPtr instance)
-        -> FuncShrdPtr;
-};
-
-}
-
+#ifndef __EVALUATOR_H__
+#define __EVALUATOR_H__
+
+#include "ASTNodes.h"
+#include "ErrorHandler.h"
+#include "Environment.h"
+#include "OutputSink.h"
+#include "Program.h"
+#include "Types.h"
+#include "Token.h"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boop {
+
+struct TaskCall;
+struct FiberState;
+class FiberScheduler;
+class ThreadPool;
+class TaskPool;
+
+/**
+ * @brief completion record of a statement: how it finished executing. The
+ * value of a `return` is left in the evaluator's return slot instead of being
+ * copied back up through every enclosing statement. A TAIL_CALL leaves the
+ * callee and its arguments for the running call to switch to.
+ *
+ */
+enum class Completion : uint8_t { NORMAL, RETURN, BREAK, CONTINUE, TAIL_CALL };
+
+// outcome of a quickened binary handler: a result, operands of other types
+// than it was specialized for, or operands of the right types it leaves to
+// the generic path anyway (a division by zero, to be reported)
+enum class Quickened : uint8_t { DONE, GUARD_FAILED, GENERIC_PATH };
+
+using EvalResult = Result<BoopObject>;
+using StmtResult = Result<Completion>;
+
+struct EvaluatorOptions {
+  static const size_t DEFAULT_MAX_CALL_DEPTH = 10000;
+  // deeper (non-tail) calls fail with a "Stack overflow." runtime error
+  size_t max_call_depth{DEFAULT_MAX_CALL_DEPTH};
+  // evaluate on a heap-allocated native stack sized for `max_call_depth`
+  // rather than on the (usually much smaller) stack of the calling thread
+  bool dedicated_stack{true};
+  // where `print` writes to and how it's buffered
+  OutputOptions output{};
+  // the pool spawned calls run on (see Tasks.h), which the host may give
+  // several isolates; nullptr for a pool of the evaluator's own, started by
+  // its first spawn
+  TaskPool *task_pool{nullptr};
+
+  // size of the native stack needed to reach `max_call_depth`
+  auto native_stack_bytes() const noexcept -> size_t;
+};
+
+class Evaluator {
+private: 
+    static const int MAX_RUNTIME_ERR = 20;
+    int m_runtime_err_count {};
+    ErrorHandler& m_error_handler;
+    EnvironmentManager m_env_manager; 
+    BoopObject m_return_value{nullptr}; // set by a RETURN completion
+    EvaluatorOptions m_options;
+    OutputSink m_output;
+    size_t m_call_depth{};
+    size_t m_max_call_depth; // lower in fibers, which have smaller stacks
+    // the program whose code is running, which the functions it declares
+    // belong to; points at the ProgramPtr of the running function
+    const ProgramPtr *m_program{nullptr};
+
+    // set by a TAIL_CALL completion; the receiver (for methods) and the
+    // arguments are on the value stack from `args_begin` up
+    struct TailCall {
+      FunctionPtr function{nullptr};
+      const Token *paren{nullptr};
+      size_t args_begin{};
+    };
+    TailCall m_tail_call;
+    // fibers of the running script, host call or task; created by the first
+    // `go` or channel operation
+    std::unique_ptr<FiberScheduler> m_fibers;
+    // the one thread scripts run on when `dedicated_stack` is set, started by
+    // the first `run`
+    std::unique_ptr<ThreadPool> m_stack_thread;
+    // the pool of this evaluator's own, if it wasn't given one; its tasks
+    // are done before the evaluator goes away
+    std::shared_ptr<TaskPool> m_own_task_pool;
+
+public: 
+    explicit Evaluator(ErrorHandler& error_handler,
+                       EvaluatorOptions options = EvaluatorOptions{});
+    ~Evaluator();
+
+    // makes `native` a global under its name
+    auto define_native(BuiltinFunctionPtr native) -> void;
+    // defines (or redefines) the global `name`, e.g. a library constant
+    auto define_global(const std::string &name, BoopObject value) -> void;
+
+    // evaluates a whole compiled script; the same Program may be running in
+    // other evaluators at the same time
+    auto run(const ProgramPtr &program) -> void;
+    // calls the global function (or builtin) `name` from the host, on the
+    // same native stack scripts run on; errors are reported at a token
+    // carrying the name
+    auto call(const std::string &name, ArgSpan args) -> EvalResult;
+    // calls a function, builtin or class with `args`, reporting errors at
+    // `call_site`
+    auto call_value(const BoopObject &callee, ArgSpan args,
+                    const Token &call_site) -> EvalResult;
+    // spawns a call on the task pool (see Tasks.h). `callee` and `args` must
+    // have been transferred already; the globals are shared from here. An
+    // unshared result isn't frozen and is for the caller alone to read.
+    auto spawn(BoopObject callee, std::vector<BoopObject> args,
+               const Token &call_site, bool share_result) -> FuturePtr;
+    // number of threads spawned calls run on, starting the pool if need be
+    auto task_workers() -> size_t;
+    // the fibers of the running script, host call or task (see Fibers.h)
+    auto fibers() -> FiberScheduler &;
+    // exchanges the running fiber's state with `state`, done on every switch
+    auto swap_fiber_state(FiberState &state) noexcept -> void;
+    // writes out what was printed so far, before the thread goes to sleep
+    auto flush_output() -> void;
+    // makes a spawned call (see Tasks.h); may be nested in another task this
+    // evaluator is running
+    auto run_task(const TaskCall &task) -> EvalResult;
+
+    auto evaluate_expr(const AST::ExprPtrVariant& expr) -> EvalResult;
+    auto evaluate_stmt(const AST::StmtPtrVariant& stmt) -> StmtResult;
+    // throws RuntimeError once more than MAX_RUNTIME_ERR errors were reported
+    auto evaluate_stmts(const std::vector<AST::StmtPtrVariant> &stmt)
+        -> Completion;
+
+  private:
+    // methods for evaluating Expr types
+    auto evaluate_binary_expr(const AST::ExprBinaryPtr &expr) -> EvalResult;
+    auto evaluate_quickened_binary(AST::BinaryHandler handler,
+                                   const BoopObject &left,
+                                   const BoopObject &right, BoopObject &result)
+        -> Quickened;
+    auto evaluate_quickened_int_binary(AST::BinaryHandler handler,
+                                       const BoopObject &left,
+                                       const BoopObject &right,
+                                       BoopObject &result) -> Quickened;
+    auto observe_binary_operands(const AST::ExprBinaryPtr &expr,
+                                 const BoopObject &left,
+                                 const BoopObject &right) -> void;
+    // element-wise arithmetic with a Float64Array and another Float64Array
+    // or a number
+    auto evaluate_array_binary(const Token &op, const BoopObject &left,
+                               const BoopObject &right) -> EvalResult;
+    auto evaluate_grouping_expr(const AST::ExprGroupingPtr &expr) -> EvalResult;
+    static auto evaluate_literal_expr(const AST::ExprLiteralPtr &expr) -> EvalResult;
+    auto evaluate_unary_expr(const AST::ExprUnaryPtr &expr) -> EvalResult;
+    auto evaluate_conditional_expr(const AST::ExprConditionalPtr &expr) -> EvalResult;
+    auto evaluate_postfix_expr(const AST::ExprPostfixPtr &expr) -> EvalResult;
+    auto evaluate_variable_expr(const AST::ExprVariablePtr &expr) -> EvalResult;
+    auto evaluate_assignment_expr(const AST::ExprAssignmentPtr &expr) -> EvalResult;
+    auto evaluate_logical_expr(const AST::ExprLogicalPtr &expr) -> EvalResult;
+    auto evaluate_call_expr(const AST::ExprCallPtr &expr) -> EvalResult;
+    auto invoke(const AST::ExprCallPtr &expr, BoopObject callee) -> EvalResult;
+    auto call_native(const AST::ExprCallPtr &expr,
+                     const BuiltinFunctionPtr &native) -> EvalResult;
+    // checks arity and pushes the receiver and arguments of a call
+    auto push_arguments(const FunctionPtr &fun_obj,
+                        const AST::ExprCallPtr &expr) -> Status;
+    // pushes the evaluated arguments; on failure the stack is truncated back
+    // to `truncate_to`
+    auto push_argument_values(const AST::ExprCallPtr &expr,
+                              size_t truncate_to) -> Status;
+    // runs `fun_obj` (and whatever it tail-calls) on the frame at `frame_base`
+    // where its receiver and arguments have already been pushed
+    auto call_function(FunctionPtr fun_obj, size_t frame_base,
+                       const Token &paren) -> EvalResult;
+    auto evaluate_function_expr(const AST::ExprFunctionPtr &expr) -> EvalResult;
+    auto evaluate_get_expr(const AST::ExprGetPtr &expr) -> EvalResult;
+    auto evaluate_set_expr(const AST::ExprSetPtr &expr) -> EvalResult;
+    auto evaluate_this_expr(const AST::ExprThisPtr &expr) -> EvalResult;
+    auto evaluate_super_expr(const AST::ExprSuperPtr &expr) -> EvalResult;
+    auto evaluate_list_expr(const AST::ExprListPtr &expr) -> EvalResult;
+    auto evaluate_index_expr(const AST::ExprIndexPtr &expr) -> EvalResult;
+    auto evaluate_index_set_expr(const AST::ExprIndexSetPtr &expr)
+        -> EvalResult;
+    auto evaluate_slice_expr(const AST::ExprSlicePtr &expr) -> EvalResult;
+    auto evaluate_map_expr(const AST::ExprMapPtr &expr) -> EvalResult;
+    auto evaluate_spawn_expr(const AST::ExprSpawnPtr &expr) -> EvalResult;
+    auto evaluate_await_expr(const AST::ExprAwaitPtr &expr) -> EvalResult;
+
+    // methods for evaluating Stmt types
+    auto evaluate_expr_stmt(const AST::ExprStmtPtr &stmt) -> StmtResult;
+    auto evaluate_print_stmt(const AST::PrintStmtPtr &stmt) -> StmtResult;
+    auto evaluate_block_stmt(const AST::BlockStmtPtr &stmt) -> StmtResult;
+    auto evaluate_var_stmt(const AST::VarStmtPtr &stmt) -> StmtResult;
+    auto evaluate_if_stmt(const AST::IfStmtPtr &stmt) -> StmtResult;
+    auto evaluate_while_stmt(const AST::WhileStmtPtr &stmt) -> StmtResult;
+    auto evaluate_for_stmt(const AST::ForStmtPtr &stmt) -> StmtResult;
+    auto evaluate_function_stmt(const AST::FuncStmtPtr &stmt) -> StmtResult;
+    auto evaluate_return_stmt(const AST::RetStmtPtr &stmt) -> StmtResult;
+    auto evaluate_tail_call(const AST::ExprCallPtr &expr) -> StmtResult;
+    auto evaluate_class_stmt(const AST::ClassStmtPtr &stmt) -> StmtResult;
+    static auto evaluate_break_stmt(const AST::BreakStmtPtr &stmt) -> StmtResult;
+    static auto evaluate_continue_stmt(const AST::ContinueStmtPtr &stmt)
+        -> StmtResult;
+
+    auto run_script(const Program &program) -> void;
+    // the pool spawned calls go to, started if need be
+    auto task_pool() -> TaskPool &;
+    // runs `body` on a native stack deep enough for max_call_depth (see
+    // EvaluatorOptions::dedicated_stack) and flushes the output
+    auto on_native_stack(const std::function<void()> &body) -> void;
+
+    // reports a runtime error if an operand isn't a number (double or int)
+    auto check_number(const Token &token, const BoopObject &right) -> Status;
+    auto check_numbers(const Token &token, const BoopObject &left,
+                       const BoopObject &right) -> Status;
+    auto bind_instance(const FunctionPtr &method, BoopInstancePtr instance)
+        -> FunctionPtr;
+    // bounds-checks `index` against a sequence of `size` elements; negative
+    // indices count from the end. A slice bound may also be `size` itself.
+    auto check_index(const Token &bracket, const BoopObject &index,
+                     size_t size, bool is_slice_bound) -> Result<size_t>;
+    auto check_map_key(const Token &token, const BoopObject &key) -> Status;
+};
+
+}
+
 #endif // __EVALUATOR_H__
\ No newline at end of file
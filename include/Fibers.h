@@ -0,0 +1,198 @@
+#ifndef __FIBERS_H__
+#define __FIBERS_H__
+
+/**
+ * @file Fibers.h
+ * @brief user-space fibers and the channels they talk through. `go f(args)`
+ * starts the call as a fiber of the running evaluator and evaluates to nil,
+ * `async f(args)` does too but evaluates to a future the call's result can
+ * be awaited from. Fibers take turns on the evaluator's thread, switching
+ * only when one of them blocks on a channel, a future or I/O (see
+ * Streams.h), yields or ends. Once they all block, the thread sleeps until
+ * one of the streams they wait on is ready.
+ *
+ * Since only one of them runs at a time, fibers share globals, objects and
+ * captured variables freely, like the code that started them. Each has its
+ * own native stack (reserved, not committed, so thousands are cheap), value
+ * stack and call depth. The script's own code counts as the main fiber: once
+ * it's done, the evaluator runs the other fibers until they end or all wait
+ * on channels nobody will use any more, and then abandons those.
+ *
+ * Every evaluator (so every isolate and task) has fibers of its own; several
+ * of them give fibers as many threads to run on.
+ *
+ */
+
+#include "Environment.h"
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace boop {
+
+class Evaluator;
+
+/**
+ * @brief what a fiber has of the evaluator's state. Only the running fiber's
+ * is in the evaluator, the others' are parked in their fibers.
+ *
+ */
+struct FiberState {
+  EnvironmentManager::Stack stack;
+  size_t call_depth{};
+  size_t max_call_depth{};
+  const ProgramPtr *program{nullptr}; // see Evaluator::m_program
+
+  FiberState() = default;
+  FiberState(size_t stack_slots, size_t max_depth)
+      : stack(stack_slots), max_call_depth(max_depth) {}
+};
+
+class FiberScheduler : public Uncopyable {
+public:
+  // native stack of a fiber, reserved up front but only committed as it's
+  // touched
+  static constexpr size_t STACK_BYTES = size_t{1} << 23;
+  static constexpr size_t STACK_SLOTS = size_t{1} << 12;
+
+  struct Fiber; // see Fibers.cpp
+
+private:
+  Evaluator &m_evaluator;
+  const size_t m_max_call_depth; // of every fiber but the main one
+  std::unique_ptr<Fiber> m_main;
+  // all fibers started and not yet ended, the main one aside
+  std::vector<std::unique_ptr<Fiber>> m_fibers;
+  std::deque<Fiber *> m_ready;
+  // fibers waiting for a local future, by the future
+  std::unordered_map<const BoopFuture *, std::vector<Fiber *>> m_awaiting;
+  // fibers waiting for a descriptor to be ready, by the descriptor
+  struct IoWaiters {
+    Fiber *reader{nullptr};
+    Fiber *writer{nullptr};
+    bool registered{false}; // with m_epoll
+  };
+  std::unordered_map<int, IoWaiters> m_io;
+  int m_epoll{-1}; // created by the first wait for I/O
+  Fiber *m_running;
+  Fiber *m_ended{nullptr}; // freed by the next fiber to run
+  std::exception_ptr m_failure; // thrown by a fiber, rethrown by the main one
+
+public:
+  FiberScheduler(Evaluator &evaluator, size_t max_call_depth);
+  // abandons the fibers still alive (after unwinding their stacks)
+  ~FiberScheduler();
+
+  // queues `callee(args)` as a new fiber; it first runs when the running
+  // fiber blocks or yields. `result`, a local future, is set when it ends.
+  auto go(ErrorHandler &error_handler, const Token &call_site,
+          BoopObject callee, std::vector<BoopObject> args,
+          FuturePtr result = nullptr) -> Status;
+  auto running() const noexcept -> Fiber *;
+
+  /**
+   * @brief blocks the running fiber until `wake` is called on it. If no
+   * fiber could ever wake it, a deadlock error is reported at `site`.
+   *
+   */
+  auto park(ErrorHandler &error_handler, const Token &site) -> Status;
+  // makes a parked fiber runnable again; false if it wasn't parked
+  static auto wake(Fiber *fiber) -> bool;
+  // lets every other runnable fiber take a turn; false if there was none
+  auto yield() -> bool;
+  // blocks the running fiber until the local `future` is set
+  auto await(ErrorHandler &error_handler, const Token &site,
+             const BoopFuture &future) -> Status;
+
+  /**
+   * @brief blocks the running fiber until the non-blocking descriptor `fd`
+   * can be read from (or written to). Only one fiber at a time may wait to
+   * read a descriptor, and one to write it.
+   *
+   */
+  auto wait_io(ErrorHandler &error_handler, const Token &site, int fd,
+               bool for_write) -> Status;
+  // wakes the fibers waiting on `fd`, which is about to be closed
+  auto forget_io(int fd) -> void;
+
+  /**
+   * @brief called by the main fiber once its own code is done: runs the
+   * other fibers until they end or all wait forever, and abandons those.
+   * Rethrows what a fiber was abandoned by (too many errors).
+   *
+   */
+  auto finish() -> void;
+
+private:
+  auto switch_away() -> void;
+  // abandons a cancelled fiber, or rethrows a failure in the main one
+  auto resumed(Fiber *self) -> void;
+  auto reap() -> void;
+  // sets the future of an async fiber that ended
+  auto settle(Fiber &fiber, bool ok, BoopObject value) -> void;
+  // wakes the fibers whose descriptors are ready, waiting up to `timeout`
+  // milliseconds (-1 for as long as it takes) for one to be
+  auto poll_io(int timeout) -> void;
+  // sleeps until a fiber waiting on I/O can run, unless one already can
+  auto wait_for_io() -> void;
+  // brings m_epoll in line with the waiters of `fd`; 0 or an errno value
+  auto update_io(int fd) -> int;
+  auto cancel_all() -> void;
+  static auto start() -> void;
+};
+
+/**
+ * @brief bounded channel between fibers of one evaluator. Values are
+ * received in the order they were sent; sending to a full channel and
+ * receiving from an empty one block the fiber. Once a channel is closed it
+ * refuses new values, and receiving gives nil after the buffered ones.
+ *
+ */
+class BoopChannel : public Uncopyable {
+private:
+  const size_t m_capacity;
+  std::deque<BoopObject> m_buffer;
+  // parked fibers waiting for a value or for room
+  std::vector<FiberScheduler::Fiber *> m_receivers;
+  std::vector<FiberScheduler::Fiber *> m_senders;
+  bool m_closed{false};
+
+public:
+  explicit BoopChannel(size_t capacity);
+
+  auto capacity() const noexcept -> size_t;
+  auto size() const noexcept -> size_t;
+  auto is_closed() const noexcept -> bool;
+
+  auto send(FiberScheduler &fibers, ErrorHandler &error_handler,
+            const Token &site, BoopObject value) -> Status;
+  // the next value, or nil once the channel is closed and empty
+  auto recv(FiberScheduler &fibers, ErrorHandler &error_handler,
+            const Token &site) -> Result<BoopObject>;
+  auto close() -> void;
+
+  /**
+   * @brief receives from whichever of `channels` has a value first, taking
+   * turns between those that have one. `which` is set to its index, or to
+   * `channels.size()` (with nil as the value) once all are closed and empty.
+   *
+   */
+  static auto select(FiberScheduler &fibers, ErrorHandler &error_handler,
+                     const Token &site, const std::vector<ChannelPtr> &channels,
+                     size_t &which) -> Result<BoopObject>;
+
+private:
+  auto take() -> BoopObject;
+  static auto wake_one(std::vector<FiberScheduler::Fiber *> &waiting) -> void;
+};
+
+} // namespace boop
+
+#endif // __FIBERS_H__
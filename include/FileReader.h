@@ -1,28 +1,43 @@
-#ifndef FILEREADER_H
-#define FILEREADER_H
-
-#include <fstream>
-#include <string>
-
-class FileReader {
-private:
-    std::fstream m_handler;
-
-    FileReader () = delete;
-    FileReader(const FileReader&) = delete;
-    FileReader(FileReader&&) = delete;
-
-public : 
-    FileReader(std::string_view fname);
-    ~FileReader();
-
-    /**
-     * @brief returns the content of `fname`
-     * 
-     * @return std::string 
-     */
-    auto content() -> std::string;
-};
-
-
+#ifndef FILEREADER_H
+#define FILEREADER_H
+
+#include <fstream>
+#include <string>
+#include <string_view>
+
+class FileReader {
+private:
+    std::fstream m_handler;
+
+    FileReader () = delete;
+    FileReader(const FileReader&) = delete;
+    FileReader(FileReader&&) = delete;
+
+public : 
+    FileReader(std::string_view fname);
+    ~FileReader();
+
+    /**
+     * @brief whether `fname` could be opened for reading
+     * 
+     * @return bool 
+     */
+    auto is_open() const -> bool;
+
+    /**
+     * @brief returns the content of `fname`
+     * 
+     * @return std::string 
+     */
+    auto content() -> std::string;
+
+    /**
+     * @brief replaces the content of `fname` with `data`
+     * 
+     * @return whether all of `data` was written
+     */
+    static auto write(std::string_view fname, std::string_view data) -> bool;
+};
+
+
 #endif // FILEREADER_H
\ No newline at end of file
@@ -1,5 +1,5 @@
-#ifndef __INTERPRETERMODULE_H__
-#define __INTERPRETERMODULE_H__
-
-
+#ifndef __INTERPRETERMODULE_H__
+#define __INTERPRETERMODULE_H__
+
+
 #endif // __INTERPRETERMODULE_H__
\ No newline at end of file
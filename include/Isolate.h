@@ -0,0 +1,98 @@
+#ifndef __ISOLATE_H__
+#define __ISOLATE_H__
+
+/**
+ * @file Isolate.h
+ * @brief independent interpreters, for running many scripts in one process
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "Evaluator.h"
+#include "Program.h"
+#include "ThreadPool.h"
+#include "Types.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace boop {
+
+/**
+ * @brief one interpreter with everything a script can reach: its error
+ * handler, globals, value stack, objects and output sink. Nothing mutable is
+ * shared between isolates but the ports their host gives them (see Ports.h),
+ * so different isolates may run on different threads at the same time, even
+ * the same Program. A single isolate must only be used by one thread at a
+ * time.
+ *
+ */
+class Isolate : public Uncopyable {
+private:
+  ErrorHandler m_error_handler;
+  Evaluator m_evaluator;
+
+public:
+  explicit Isolate(EvaluatorOptions options = EvaluatorOptions{});
+
+  /**
+   * @brief compiles and evaluates `source`, or evaluates `program`. Globals
+   * defined by earlier runs are still there. Returns whether the script ran
+   * without any error; the errors of the last run are in `get_errors`.
+   *
+   */
+  auto run(std::string_view source) -> bool;
+  auto run(const ProgramPtr &program) -> bool;
+
+  // compiles `source` for running here or in any other isolate; nullptr if
+  // it has errors, which are then in `get_errors`
+  auto compile(std::string_view source) -> ProgramPtr;
+  // calls the global function `name`; nullopt if that failed, with the
+  // errors in `get_errors`
+  auto call(const std::string &name, ArgSpan args)
+      -> std::optional<BoopObject>;
+  // makes `native` a global of this isolate
+  auto define_native(BuiltinFunctionPtr native) -> void;
+  // makes `value` a global of this isolate; only a shareable value (see
+  // Sharing.h), such as a port, may be given to other isolates as well
+  auto define_global(const std::string &name, BoopObject value) -> void;
+
+  auto get_errors() const noexcept -> const std::vector<std::string> &;
+};
+
+struct ScriptResult {
+  bool ok{false};
+  std::vector<std::string> errors;
+};
+
+/**
+ * @brief runs every one of `sources` in a fresh isolate of its own, as many
+ * at a time as `pool` has workers, and waits for all of them. The results are
+ * in the order of `sources`. Must not be called from one of `pool`'s
+ * workers.
+ *
+ * All isolates write to `options.output`; each one's output is buffered and
+ * written in large chunks, so concurrent scripts printing to the same
+ * descriptor interleave at chunk boundaries. Isolates evaluate on the worker's
+ * own stack when the pool's is big enough for `options.max_call_depth`.
+ *
+ */
+auto run_isolates(ThreadPool &pool, const std::vector<std::string> &sources,
+                  const EvaluatorOptions &options = EvaluatorOptions{})
+    -> std::vector<ScriptResult>;
+
+/**
+ * @brief runs each of `programs` in a fresh isolate of its own, like the
+ * above; a Program may appear any number of times and is shared, not copied,
+ * between the isolates running it.
+ *
+ */
+auto run_isolates(ThreadPool &pool, const std::vector<ProgramPtr> &programs,
+                  const EvaluatorOptions &options = EvaluatorOptions{})
+    -> std::vector<ScriptResult>;
+
+} // namespace boop
+
+#endif // __ISOLATE_H__
@@ -0,0 +1,47 @@
+#ifndef __JSON_H__
+#define __JSON_H__
+
+/**
+ * @file Json.h
+ * @brief JSON to and from script values. Objects are maps, arrays lists,
+ * numbers integers when they are written without a fraction or an exponent
+ * and fit an int64_t, doubles otherwise.
+ *
+ * Parsing takes two passes, in the style of simdjson. The first classifies
+ * 64 bytes at a time (with SSE2 where available, byte by byte otherwise)
+ * into bitmasks of quotes, backslashes, operators and whitespace, works out
+ * from them which bytes are inside strings without looking at a single byte
+ * again, and records where every token starts. The second walks that index
+ * building values, so it never scans for the end of a string or a number.
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <string>
+#include <string_view>
+
+namespace boop {
+
+// arrays and objects nested deeper than this are refused both ways
+constexpr size_t JSON_MAX_DEPTH = 1024;
+
+// the value `text` encodes; nests up to JSON_MAX_DEPTH arrays and objects
+auto parse_json(ErrorHandler &error_handler, const Token &site,
+                std::string_view text) -> Result<BoopObject>;
+
+/**
+ * @brief appends the JSON encoding of `value` to `out`. Lists and
+ * Float64Arrays become arrays and maps objects, whose keys are written as
+ * strings even when they are numbers or booleans. Anything else a script can
+ * hold but JSON can't (functions, instances, NaN...) fails.
+ *
+ */
+auto write_json(ErrorHandler &error_handler, const Token &site,
+                const BoopObject &value, std::string &out) -> Status;
+
+} // namespace boop
+
+#endif // __JSON_H__
@@ -0,0 +1,69 @@
+#ifndef __JSONINDEX_H__
+#define __JSONINDEX_H__
+
+/**
+ * @file JsonIndex.h
+ * @brief stage 1 of the JSON parser (see Json.h): classifying 64 byte blocks
+ * into bitmasks and indexing where every token starts.
+ *
+ * Every step that has a vector version also has a portable one, compiled
+ * everywhere. The parser uses the fastest the build allows; the others are
+ * there for checking that they all agree.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// prefix_xor_clmul is compiled for PCLMUL even when the build isn't
+#define BOOP_JSON_CLMUL 1
+#endif
+
+namespace boop::json {
+
+constexpr size_t BLOCK_BYTES = 64;
+
+// bit i stands for byte i of a block
+struct BlockMasks {
+  uint64_t quote{};
+  uint64_t backslash{};
+  uint64_t op{};    // { } [ ] : ,
+  uint64_t space{}; // the whitespace JSON allows between tokens
+};
+
+// the masks of BLOCK_BYTES bytes from `block`
+auto classify(const char *block) noexcept -> BlockMasks;
+auto classify_portable(const char *block) noexcept -> BlockMasks;
+#if defined(__SSE2__)
+auto classify_sse2(const char *block) noexcept -> BlockMasks;
+#endif
+
+// bit i is the xor of bits 0 to i of `bits`: set between an opening quote
+// and the quote closing it
+auto prefix_xor(uint64_t bits) noexcept -> uint64_t;
+auto prefix_xor_portable(uint64_t bits) noexcept -> uint64_t;
+#ifdef BOOP_JSON_CLMUL
+// only to be called when the CPU has PCLMUL
+auto prefix_xor_clmul(uint64_t bits) noexcept -> uint64_t;
+#endif
+
+// the bytes a backslash escapes in a block whose backslashes are
+// `backslash`; `carry` is 1 when the previous block ended in an odd run of
+// backslashes, and is updated for the next one
+auto find_escaped(uint64_t backslash, uint64_t &carry) noexcept -> uint64_t;
+
+/**
+ * @brief appends to `index` the offset of every token of `text`, i.e. of
+ * every operator, of both quotes of every string and of the first byte of
+ * every other value. False if a string is left open.
+ *
+ */
+auto index_tokens(std::string_view text, std::vector<uint32_t> &index)
+    -> bool;
+
+} // namespace boop::json
+
+#endif // __JSONINDEX_H__
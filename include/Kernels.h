@@ -0,0 +1,68 @@
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+/**
+ * @file Kernels.h
+ * @brief bulk math over contiguous doubles, the native side of Float64Array.
+ *
+ * On x86-64 every kernel has an AVX2/FMA version that is picked at runtime
+ * when the CPU supports it; otherwise a plain loop (which the compiler is
+ * free to vectorize for the baseline instruction set) runs instead. The
+ * binary isn't built with -mavx2, so it still runs on older CPUs.
+ *
+ * Reductions keep several partial results, so they may differ in the last
+ * bits from a strictly sequential loop. min and max, and the element-wise
+ * minimum and maximum, are NaN wherever an operand is NaN, whichever version
+ * runs. Setting BOOP_NO_AVX2 in the environment turns the AVX2 versions off.
+ *
+ */
+
+#include <cstddef>
+
+namespace boop::kernels {
+
+// whether the AVX2 versions are in use
+auto has_avx2() noexcept -> bool;
+
+// out[i] = a[i] op b[i]; `out` may alias `a` or `b`
+auto add(const double *a, const double *b, double *out, size_t n) -> void;
+auto sub(const double *a, const double *b, double *out, size_t n) -> void;
+auto mul(const double *a, const double *b, double *out, size_t n) -> void;
+auto div(const double *a, const double *b, double *out, size_t n) -> void;
+
+// out[i] = a[i] op s, or s op a[i] for the r- variants
+auto add_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto sub_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto rsub_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto mul_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto div_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto rdiv_scalar(const double *a, double s, double *out, size_t n) -> void;
+
+// element-wise min and max of two arrays or of an array and s
+auto minimum(const double *a, const double *b, double *out, size_t n) -> void;
+auto maximum(const double *a, const double *b, double *out, size_t n) -> void;
+auto minimum_scalar(const double *a, double s, double *out, size_t n) -> void;
+auto maximum_scalar(const double *a, double s, double *out, size_t n) -> void;
+
+// out[i] = f(a[i]); `out` may alias `a`
+auto sqrt(const double *a, double *out, size_t n) -> void;
+auto floor(const double *a, double *out, size_t n) -> void;
+auto ceil(const double *a, double *out, size_t n) -> void;
+auto abs(const double *a, double *out, size_t n) -> void;
+
+// out[i] = a[i] * b[i] + c[i], rounded once where FMA is available
+auto fma(const double *a, const double *b, const double *c, double *out,
+         size_t n) -> void;
+
+auto dot(const double *a, const double *b, size_t n) -> double;
+auto sum(const double *a, size_t n) -> double;
+// n must not be 0
+auto min(const double *a, size_t n) -> double;
+auto max(const double *a, size_t n) -> double;
+
+// out[i] = a[0] + ... + a[i]; `out` may alias `a`
+auto cumsum(const double *a, double *out, size_t n) -> void;
+
+} // namespace boop::kernels
+
+#endif // __KERNELS_H__
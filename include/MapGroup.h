@@ -0,0 +1,85 @@
+#ifndef __MAPGROUP_H__
+#define __MAPGROUP_H__
+
+/**
+ * @file MapGroup.h
+ * @brief the control words of BoopMap's slots (see BoopMap.h) and the groups
+ * of them a lookup compares at once. The portable group is compiled
+ * everywhere; the SSE2 one is used where it's available.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace boop::map_group {
+
+// control words; a full slot holds the 7 low bits of its hash instead, so
+// only the special values have the sign bit set
+constexpr int8_t EMPTY = -128; // 0b10000000
+constexpr int8_t DELETED = -2; // 0b11111110
+
+// the control words of 8 consecutive slots, compared within a 64-bit word
+struct PortableGroup {
+  static constexpr size_t WIDTH = 8;
+  static constexpr int SHIFT = 3; // bit 8i+7 of a match is slot i
+  static constexpr uint64_t LSBS = 0x0101010101010101ULL;
+  static constexpr uint64_t MSBS = 0x8080808080808080ULL;
+
+  uint64_t ctrl;
+
+  explicit PortableGroup(const int8_t *pos) {
+    std::memcpy(&ctrl, pos, sizeof(ctrl));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    ctrl = __builtin_bswap64(ctrl);
+#endif
+  }
+
+  // may report a full slot that doesn't match (the keys get compared
+  // anyway), never misses one that does
+  auto match(int8_t h2) const noexcept -> uint64_t {
+    const uint64_t x = ctrl ^ (LSBS * static_cast<uint8_t>(h2));
+    return (x - LSBS) & ~x & MSBS;
+  }
+  auto match_empty() const noexcept -> uint64_t {
+    return ctrl & ~(ctrl << 6) & MSBS;
+  }
+  auto match_empty_or_deleted() const noexcept -> uint64_t {
+    return ctrl & ~(ctrl << 7) & MSBS;
+  }
+};
+
+#if defined(__SSE2__)
+// the control words of 16 consecutive slots
+struct Sse2Group {
+  static constexpr size_t WIDTH = 16;
+  static constexpr int SHIFT = 0; // bit i of a match is slot i
+
+  __m128i ctrl;
+
+  explicit Sse2Group(const int8_t *pos)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))) {}
+
+  auto match(int8_t h2) const noexcept -> uint64_t {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+  }
+  auto match_empty() const noexcept -> uint64_t { return match(EMPTY); }
+  auto match_empty_or_deleted() const noexcept -> uint64_t {
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+  }
+};
+
+using Group = Sse2Group;
+#else
+using Group = PortableGroup;
+#endif
+
+} // namespace boop::map_group
+
+#endif // __MAPGROUP_H__
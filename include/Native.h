@@ -0,0 +1,236 @@
+#ifndef __NATIVE_H__
+#define __NATIVE_H__
+
+/**
+ * @file Native.h
+ * @brief interface between the evaluator and functions implemented in C++.
+ *
+ * A builtin either derives from BuiltinFunction and works on the raw ArgSpan,
+ * or is a plain C++ function wrapped by `make_native`:
+ *
+ *   auto hypot2(double x, double y) -> double { return x * x + y * y; }
+ *   evaluator.define_native(make_native<&hypot2>("hypot2"));
+ *
+ * The wrapper's arity and argument conversions are generated at compile time
+ * from the function's signature.
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "OutputSink.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace boop {
+
+class Evaluator;
+
+/**
+ * @brief the parts of the running interpreter a builtin may use
+ *
+ */
+struct NativeContext {
+  ErrorHandler &error_handler;
+  const Token &call_site; // the call's closing paren, for error positions
+  OutputSink &output;
+  Evaluator &evaluator; // for builtins calling back into scripts
+
+  // reports `msg` as a runtime error of the call
+  auto error(const std::string &msg) const -> Status {
+    return report_runtime_error(error_handler, call_site, msg);
+  }
+};
+
+namespace native {
+
+/**
+ * @brief how an argument of type T is checked and unboxed. Each
+ * specialization has a NAME for error messages, `matches` and `get`.
+ *
+ */
+template <typename T> struct ArgTraits;
+
+template <> struct ArgTraits<double> {
+  static constexpr const char *NAME = "number";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<double>(object) ||
+           std::holds_alternative<int64_t>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> double {
+    if (const auto *integer = std::get_if<int64_t>(&object))
+      return static_cast<double>(*integer);
+    return *std::get_if<double>(&object);
+  }
+};
+
+template <> struct ArgTraits<int64_t> {
+  static constexpr const char *NAME = "integer";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<int64_t>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> int64_t {
+    return *std::get_if<int64_t>(&object);
+  }
+};
+
+template <> struct ArgTraits<bool> {
+  static constexpr const char *NAME = "boolean";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<bool>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> bool {
+    return *std::get_if<bool>(&object);
+  }
+};
+
+template <> struct ArgTraits<BoopString> {
+  static constexpr const char *NAME = "string";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<BoopString>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> const BoopString & {
+    return *std::get_if<BoopString>(&object);
+  }
+};
+
+// borrows the (flattened) contents for the duration of the call
+template <> struct ArgTraits<std::string_view> {
+  static constexpr const char *NAME = "string";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<BoopString>(object);
+  }
+  static auto get(const BoopObject &object) -> std::string_view {
+    return std::get_if<BoopString>(&object)->str();
+  }
+};
+
+template <> struct ArgTraits<BoopListPtr> {
+  static constexpr const char *NAME = "list";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<BoopListPtr>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> const BoopListPtr & {
+    return *std::get_if<BoopListPtr>(&object);
+  }
+};
+
+template <> struct ArgTraits<BoopMapPtr> {
+  static constexpr const char *NAME = "map";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<BoopMapPtr>(object);
+  }
+  static auto get(const BoopObject &object) noexcept -> const BoopMapPtr & {
+    return *std::get_if<BoopMapPtr>(&object);
+  }
+};
+
+template <> struct ArgTraits<Float64ArrayPtr> {
+  static constexpr const char *NAME = "Float64Array";
+  static auto matches(const BoopObject &object) noexcept -> bool {
+    return std::holds_alternative<Float64ArrayPtr>(object);
+  }
+  static auto get(const BoopObject &object) noexcept
+      -> const Float64ArrayPtr & {
+    return *std::get_if<Float64ArrayPtr>(&object);
+  }
+};
+
+// any value, unchecked
+template <> struct ArgTraits<BoopObject> {
+  static constexpr const char *NAME = "value";
+  static auto matches(const BoopObject & /*object*/) noexcept -> bool {
+    return true;
+  }
+  static auto get(const BoopObject &object) noexcept -> const BoopObject & {
+    return object;
+  }
+};
+
+// parameters may be taken by value or by const reference
+template <typename T>
+using ArgTraitsOf = ArgTraits<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+/**
+ * @brief boxes the return value of a wrapped function
+ *
+ */
+template <typename R> auto box(R &&value) -> BoopObject {
+  using Value = std::remove_cv_t<std::remove_reference_t<R>>;
+  if constexpr (std::is_same_v<Value, std::string>)
+    return BoopObject(BoopString(std::forward<R>(value)));
+  else if constexpr (std::is_same_v<Value, bool> ||
+                     std::is_same_v<Value, int64_t> ||
+                     std::is_same_v<Value, double> ||
+                     std::is_same_v<Value, BoopString> ||
+                     std::is_same_v<Value, BoopListPtr> ||
+                     std::is_same_v<Value, BoopMapPtr> ||
+                     std::is_same_v<Value, Float64ArrayPtr> ||
+                     std::is_same_v<Value, BoopObject>)
+    return BoopObject(std::forward<R>(value));
+  else
+    static_assert(!sizeof(Value),
+                  "unsupported return type for a native function");
+}
+
+template <auto Fn, typename Signature = decltype(Fn)> class TypedBuiltin;
+
+/**
+ * @brief BuiltinFunction generated from `R Fn(Args...)`. The arity is
+ * `sizeof...(Args)`; every argument is checked against its parameter type
+ * before any is unboxed, and a void function returns nil.
+ *
+ */
+template <auto Fn, typename R, typename... Args>
+class TypedBuiltin<Fn, R (*)(Args...)> final : public BuiltinFunction {
+public:
+  explicit TypedBuiltin(std::string name)
+      : BuiltinFunction(std::move(name), sizeof...(Args)) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    return invoke(context, args, std::index_sequence_for<Args...>{});
+  }
+
+private:
+  template <size_t... I>
+  auto invoke(NativeContext &context, ArgSpan args,
+              std::index_sequence<I...> /*indices*/) -> Result<BoopObject> {
+    // the trailing entries keep the arrays non-empty for nullary functions
+    static constexpr const char *expected[] = {ArgTraitsOf<Args>::NAME...,
+                                               ""};
+    const bool matches[] = {ArgTraitsOf<Args>::matches(args[I])..., true};
+    for (size_t i = 0; i < sizeof...(Args); ++i)
+      if (__builtin_expect(!matches[i], 0))
+        return context.error("Argument " + std::to_string(i + 1) + " of " +
+                             get_name() + " must be a " + expected[i] + ".");
+
+    if constexpr (std::is_void_v<R>) {
+      Fn(ArgTraitsOf<Args>::get(args[I])...);
+      return BoopObject(nullptr);
+    } else {
+      return box(Fn(ArgTraitsOf<Args>::get(args[I])...));
+    }
+  }
+};
+
+} // namespace native
+
+/**
+ * @brief wraps the plain C++ function `Fn` as a builtin called `name`
+ *
+ */
+template <auto Fn> auto make_native(std::string name) -> BuiltinFunctionPtr {
+  return std::make_shared<native::TypedBuiltin<Fn>>(std::move(name));
+}
+
+} // namespace boop
+
+#endif // __NATIVE_H__
@@ -0,0 +1,60 @@
+#ifndef __OUTPUTSINK_H__
+#define __OUTPUTSINK_H__
+
+#include "Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace boop {
+
+enum class FlushPolicy : uint8_t {
+  AUTO, // LINE if the descriptor is a terminal, FULL otherwise
+  LINE, // also flush after every completed line
+  FULL, // only flush when the buffer is full or on request
+};
+
+struct OutputOptions {
+  static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+  int fd{1}; // stdout
+  size_t buffer_size{DEFAULT_BUFFER_SIZE};
+  FlushPolicy policy{FlushPolicy::AUTO};
+};
+
+/**
+ * @brief buffered writer for everything a script prints. Output is collected
+ * in a large buffer and written to the file descriptor in one go when the
+ * buffer fills up, when `flush` is called and when the sink is destroyed.
+ *
+ */
+class OutputSink : public Uncopyable {
+private:
+  int m_fd;
+  FlushPolicy m_policy;
+  std::vector<char> m_buffer;
+  size_t m_used{};
+
+public:
+  explicit OutputSink(OutputOptions options = OutputOptions{});
+  ~OutputSink() override;
+
+  auto write(std::string_view text) -> void;
+  auto put(char c) -> void;
+  // numbers are formatted straight into the buffer
+  auto write_number(double value) -> void;
+  auto write_number(int64_t value) -> void;
+  // ends the current line, flushing it under the LINE policy
+  auto end_line() -> void;
+  auto flush() -> void;
+
+  auto get_policy() const noexcept -> FlushPolicy;
+
+private:
+  auto reserve(size_t size) -> char *;
+};
+
+} // namespace boop
+
+#endif // __OUTPUTSINK_H__
@@ -0,0 +1,90 @@
+#ifndef __PORTS_H__
+#define __PORTS_H__
+
+/**
+ * @file Ports.h
+ * @brief channels between threads, for isolates (given the same port by
+ * their host) and tasks (passed a port when spawned) to stream values to
+ * each other. A port is a bounded queue any number of threads may send to
+ * and receive from, which never takes a lock unless a thread has to sleep on
+ * it.
+ *
+ * Sent values are handed over as described in Sharing.h: whatever nobody
+ * can change any more (numbers, strings, frozen containers...) goes through
+ * by reference, anything else is copied for the receiver.
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace boop {
+
+class FiberScheduler;
+
+class BoopPort : public Uncopyable {
+private:
+  // keeps the ends of the queue and its slots from sharing cache lines
+  static constexpr size_t CACHE_LINE = 64;
+
+  // a slot holds a value once its sequence is one past its position, and is
+  // free for the position a lap later once its sequence is that position
+  struct alignas(CACHE_LINE) Slot {
+    std::atomic<size_t> sequence;
+    BoopObject value{nullptr};
+  };
+
+  const size_t m_mask; // capacity - 1
+  std::unique_ptr<Slot[]> m_slots;
+  alignas(CACHE_LINE) std::atomic<size_t> m_tail{0}; // next position to send to
+  alignas(CACHE_LINE) std::atomic<size_t> m_head{0}; // next one to receive from
+  alignas(CACHE_LINE) std::atomic<bool> m_closed{false};
+  // threads sleeping until a value or room shows up
+  std::atomic<size_t> m_sleepers{0};
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+
+public:
+  // the capacity is rounded up to a power of two, and to at least 2
+  explicit BoopPort(size_t capacity);
+
+  auto capacity() const noexcept -> size_t;
+  auto is_closed() const noexcept -> bool;
+
+  /**
+   * @brief queues a transfer of `value`. While the port is full, the other
+   * fibers of the sending thread run; once none of them can, the thread
+   * sleeps until a receiver makes room.
+   *
+   */
+  auto send(FiberScheduler &fibers, ErrorHandler &error_handler,
+            const Token &site, const BoopObject &value) -> Status;
+  // the next value, or nil once the port is closed and empty; waits like
+  // `send` does
+  auto recv(FiberScheduler &fibers) -> BoopObject;
+  // refuses further sends and wakes every sleeping thread
+  auto close() -> void;
+
+  // lock-free; `value` is only moved from if there was room
+  auto try_send(BoopObject &value) -> bool;
+  // lock-free; false if the port is empty
+  auto try_recv(BoopObject &value) -> bool;
+
+private:
+  auto is_empty() const noexcept -> bool;
+  auto is_full() const noexcept -> bool;
+  // wakes the threads sleeping on the port, if there are any
+  auto notify() -> void;
+  auto sleep(bool for_room) -> void;
+};
+
+} // namespace boop
+
+#endif // __PORTS_H__
@@ -0,0 +1,55 @@
+#ifndef __PROGRAM_H__
+#define __PROGRAM_H__
+
+#include "ASTNodes.h"
+#include "ErrorHandler.h"
+#include "Resolver.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace boop {
+
+/**
+ * @brief a scanned, parsed and resolved script: the source, its tokens, the
+ * AST and the script's frame layout. The literal values the Resolver builds
+ * into the AST are its constant pool.
+ *
+ * A Program never changes once `compile` has returned it (the quickening
+ * state of binary nodes aside, which is updated with relaxed atomics and is
+ * only ever a hint). It is handed around as a ProgramPtr; every function
+ * declared in it holds on to it, so it lives as long as anything can still
+ * run its code. Any number of evaluators may run one Program concurrently on
+ * different threads without copying it.
+ *
+ */
+class Program : public Uncopyable {
+private:
+  std::string m_source;
+  std::vector<Token> m_tokens;
+  std::vector<AST::StmtPtrVariant> m_stmts;
+  ScriptLayout m_layout;
+
+  explicit Program(std::string source);
+
+public:
+  /**
+   * @brief compiles `source`; returns nullptr if there were errors, which have
+   * been added to `error_handler`
+   *
+   */
+  static auto compile(std::string source, ErrorHandler &error_handler)
+      -> ProgramPtr;
+
+  auto get_source() const noexcept -> std::string_view;
+  auto get_stmts() const noexcept -> const std::vector<AST::StmtPtrVariant> &;
+  auto get_layout() const noexcept -> ScriptLayout;
+};
+
+} // namespace boop
+
+#endif // __PROGRAM_H__
@@ -0,0 +1,88 @@
+#ifndef __RESOLVER_H__
+#define __RESOLVER_H__
+
+#include "ASTNodes.h"
+#include "ErrorHandler.h"
+#include "Token.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boop {
+
+/**
+ * @brief frame layout of the top-level script. Its block-scoped locals live in
+ * a frame of their own; top-level declarations outside of blocks are globals.
+ *
+ */
+struct ScriptLayout {
+  uint32_t frame_size{};
+};
+
+/**
+ * @brief static pass run between the Parser and the Evaluator. Every local is
+ * given a slot in the frame of its enclosing function (nested blocks share
+ * that frame and reuse the slots of blocks that have ended) and every variable
+ * reference is annotated with the slot or upvalue it resolves to. A function
+ * only captures the variables of enclosing functions that it (or a function
+ * nested in it) actually refers to.
+ *
+ */
+class Resolver {
+private:
+  struct Scope {
+    std::unordered_map<std::string, uint32_t> locals;
+    uint32_t first_slot{};
+  };
+
+  struct FunctionScope {
+    AST::ExprFunction *function{nullptr}; // nullptr for the script
+    std::vector<Scope> scopes;
+    uint32_t next_slot{};
+    uint32_t frame_size{};
+    std::vector<AST::UpvalueDescriptor> upvalues;
+    bool is_initializer{false};
+  };
+
+  ErrorHandler &m_error_handler;
+  std::vector<FunctionScope> m_functions;
+  int m_class_depth{}; // number of class bodies enclosing the current node
+
+public:
+  explicit Resolver(ErrorHandler &error_handler);
+
+  /**
+   * @brief annotates `stmts` in place and returns the layout of the script
+   * frame
+   *
+   * @return ScriptLayout
+   */
+  auto resolve(const std::vector<AST::StmtPtrVariant> &stmts) -> ScriptLayout;
+
+private:
+  auto resolve_expr(const AST::ExprPtrVariant &expr) -> void;
+  auto resolve_stmt(const AST::StmtPtrVariant &stmt) -> void;
+  auto resolve_stmts(const std::vector<AST::StmtPtrVariant> &stmts) -> void;
+  auto resolve_function(AST::ExprFunction &function, bool is_method,
+                        bool is_initializer = false) -> void;
+  auto resolve_class(const AST::ClassStmtPtr &stmt) -> void;
+
+  auto begin_scope() -> void;
+  auto end_scope() -> void;
+  auto declare(const Token &name) -> AST::ResolvedSlot;
+  auto declare(const std::string &name) -> AST::ResolvedSlot;
+  auto lookup(const std::string &name) -> AST::ResolvedSlot;
+  auto find_local(size_t level, const std::string &name)
+      -> std::optional<uint32_t>;
+  auto find_upvalue(size_t level, const std::string &name)
+      -> std::optional<uint32_t>;
+  auto add_upvalue(size_t level, AST::UpvalueDescriptor descriptor)
+      -> uint32_t;
+};
+
+} // namespace boop
+
+#endif // __RESOLVER_H__
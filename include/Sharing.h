@@ -0,0 +1,66 @@
+#ifndef __SHARING_H__
+#define __SHARING_H__
+
+/**
+ * @file Sharing.h
+ * @brief what may be handed from one interpreter thread to another, as the
+ * arguments and results of tasks (see Tasks.h) do.
+ *
+ * Objects are reference counted atomically but nothing else about them is
+ * synchronized, so a value may be used by several threads at once only if
+ * it's made for that (ports, the futures of tasks) or nobody can change it
+ * any more: numbers, booleans, nil, strings (once flattened), builtins,
+ * frozen lists, maps, Float64Arrays and instances, functions that capture no
+ * variables and classes whose methods capture none. Anything else is copied
+ * for the receiving thread, except channels, streams and the futures of
+ * async calls, which stay with the fibers of their evaluator (see Fibers.h).
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <vector>
+
+namespace boop {
+
+// whether `value` may be used by several threads as it is. Only looks at
+// `value` itself: whatever a frozen container holds is shareable as well.
+auto is_shareable(const BoopObject &value) -> bool;
+// whether `value` is a list, map, Float64Array or instance that was frozen
+auto is_frozen(const BoopObject &value) -> bool;
+
+/**
+ * @brief deep-freezes `value` in place: every list, map, Float64Array and
+ * instance it reaches is marked frozen and every string flattened. Fails,
+ * leaving everything as it was, on a closure that captures variables, which
+ * could still be assigned to.
+ *
+ */
+auto freeze(ErrorHandler &error_handler, const Token &site,
+            const BoopObject &value) -> Status;
+
+/**
+ * @brief `value` for another thread to own. Shareable values are handed
+ * over as they are, everything else is deep-copied, including the variables
+ * a closure captures, so the copy doesn't see later assignments to them.
+ * Values reachable more than once (and cycles) are copied once. Fails on a
+ * class whose methods capture variables.
+ *
+ */
+auto transfer(ErrorHandler &error_handler, const Token &site,
+              const BoopObject &value) -> Result<BoopObject>;
+// transfers all of `values` in place as one: a value reachable from several
+// of them is still copied only once
+auto transfer(ErrorHandler &error_handler, const Token &site,
+              std::vector<BoopObject> &values) -> Status;
+
+// like `transfer`, but frozen values are copied too, so the copy can be
+// modified again
+auto deep_copy(ErrorHandler &error_handler, const Token &site,
+               const BoopObject &value) -> Result<BoopObject>;
+
+} // namespace boop
+
+#endif // __SHARING_H__
@@ -0,0 +1,109 @@
+#ifndef __STREAMS_H__
+#define __STREAMS_H__
+
+/**
+ * @file Streams.h
+ * @brief files, pipes and Unix sockets for scripts. Every descriptor is
+ * non-blocking: a read or write that would block parks the fiber making it
+ * (see Fibers.h) until the descriptor is ready, so other fibers, such as
+ * the ones `async` calls run in, keep the thread busy meanwhile. Regular
+ * files are always ready, their reads and writes don't park.
+ *
+ * A stream made by `map` reads a regular file through a mapping of the
+ * whole file instead: lines are cut straight out of the page cache, with no
+ * read buffer in between.
+ *
+ */
+
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <sys/types.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace boop {
+
+class FiberScheduler;
+
+class BoopStream : public Uncopyable {
+public:
+  enum class Kind { FILE, PIPE, SOCKET, LISTENER };
+
+private:
+  // bytes read per system call
+  static constexpr size_t CHUNK_BYTES = size_t{1} << 16;
+
+  int m_fd;
+  const Kind m_kind;
+  // read ahead of what was returned, for `read_line`; consumed up to m_start
+  std::string m_buffer;
+  // the file, if mapped; read from in place of m_buffer
+  const char *m_map{nullptr};
+  size_t m_map_size{0};
+  size_t m_start{0};
+  bool m_at_end{false}; // no more input after m_buffer
+
+public:
+  // takes ownership of the non-blocking `fd`
+  BoopStream(int fd, Kind kind);
+  ~BoopStream();
+
+  // `mode` is "r" (read), "w" (truncate and write) or "a" (append)
+  static auto open(ErrorHandler &error_handler, const Token &site,
+                   const std::string &path, const std::string &mode)
+      -> Result<StreamPtr>;
+  // reads the file at `path` from a mapping of it, or like `open` does if
+  // it can't be mapped
+  static auto map(ErrorHandler &error_handler, const Token &site,
+                  const std::string &path) -> Result<StreamPtr>;
+  // the reading and the writing end of a new pipe
+  static auto make_pipe(ErrorHandler &error_handler, const Token &site)
+      -> Result<std::pair<StreamPtr, StreamPtr>>;
+  // two connected Unix sockets
+  static auto make_socket_pair(ErrorHandler &error_handler, const Token &site)
+      -> Result<std::pair<StreamPtr, StreamPtr>>;
+  // a socket accepting connections at `path`, which mustn't exist yet
+  static auto listen(ErrorHandler &error_handler, const Token &site,
+                     const std::string &path) -> Result<StreamPtr>;
+  static auto connect(FiberScheduler &fibers, ErrorHandler &error_handler,
+                      const Token &site, const std::string &path)
+      -> Result<StreamPtr>;
+  // the next connection made to a listening socket
+  auto accept(FiberScheduler &fibers, ErrorHandler &error_handler,
+              const Token &site) -> Result<StreamPtr>;
+
+  // up to `size` bytes, as few as one system call gives; nil once the end
+  // of the input is reached
+  auto read(FiberScheduler &fibers, ErrorHandler &error_handler,
+            const Token &site, size_t size) -> Result<BoopObject>;
+  // the next line without its "\n"; nil once the end of the input is reached
+  auto read_line(FiberScheduler &fibers, ErrorHandler &error_handler,
+                 const Token &site) -> Result<BoopObject>;
+  // writes all of `data`
+  auto write(FiberScheduler &fibers, ErrorHandler &error_handler,
+             const Token &site, std::string_view data) -> Status;
+  // wakes the fibers waiting on the stream, whose reads and writes then fail
+  auto close(FiberScheduler &fibers) -> void;
+  auto is_closed() const noexcept -> bool;
+
+private:
+  // the bytes read ahead but not returned yet
+  auto unread() const noexcept -> std::string_view;
+  auto unmap() noexcept -> void;
+  auto check_open(ErrorHandler &error_handler, const Token &site) const
+      -> Status;
+  // appends whatever one read gives to m_buffer; false at the end of input
+  auto fill(FiberScheduler &fibers, ErrorHandler &error_handler,
+            const Token &site) -> Result<bool>;
+  // takes `size` unread bytes
+  auto take(size_t size) -> BoopObject;
+  auto write_some(std::string_view data) -> ssize_t;
+};
+
+} // namespace boop
+
+#endif // __STREAMS_H__
@@ -0,0 +1,112 @@
+#ifndef __TASKS_H__
+#define __TASKS_H__
+
+/**
+ * @file Tasks.h
+ * @brief parallel tasks inside a script. `spawn f(args)` makes the call on a
+ * work-stealing thread pool and evaluates to a future right away; `await`
+ * waits for the future and evaluates to the call's result.
+ *
+ * A task runs in an evaluator of its own on the worker's thread, with its own
+ * value stack, frames and builtins, so tasks share nothing mutable with the
+ * script spawning them: the callee and arguments are handed over as described
+ * in Sharing.h, globals are read from a snapshot taken at the spawn, and the
+ * result is frozen before anyone else can see it.
+ *
+ */
+
+#include "Environment.h"
+#include "OutputSink.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace boop {
+
+struct EvaluatorOptions;
+
+/**
+ * @brief the result of a spawned call, set exactly once by the task. It never
+ * changes after that, so any number of threads may wait on it and read it.
+ *
+ * The future of an async call (see Fibers.h) is local instead: it's set by a
+ * fiber, and only the fibers of the same evaluator may await it.
+ *
+ */
+class BoopFuture : public Uncopyable {
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_done_cv;
+  std::atomic<bool> m_done{false};
+  const bool m_local{false};
+  BoopObject m_value{nullptr}; // frozen, unless the future is local
+  std::string m_error;         // the task's errors, if it failed
+
+public:
+  BoopFuture() = default;
+  explicit BoopFuture(bool local);
+
+  auto is_local() const noexcept -> bool { return m_local; }
+  auto is_done() const noexcept -> bool;
+  auto complete(BoopObject value) -> void;
+  auto fail(std::string error) -> void;
+  // blocks until the future is done
+  auto wait() -> void;
+
+  // only meaningful once the future is done
+  auto failed() const noexcept -> bool;
+  auto get_value() const noexcept -> const BoopObject &;
+  auto get_error() const noexcept -> const std::string &;
+
+private:
+  auto finish() -> void;
+};
+
+/**
+ * @brief a call for a task to make. The callee and arguments have already
+ * been made safe for another thread (see Sharing.h).
+ *
+ */
+struct TaskCall {
+  BoopObject callee;
+  std::vector<BoopObject> args;
+  EnvironmentManager::SharedGlobalsPtr globals; // of the spawning script
+  Token call_site;                              // for error positions
+  OutputOptions output;                         // where the task prints
+  // whether anyone but the spawner may read the result, which then has to be
+  // frozen; a result kept for the spawner alone is handed over as it is
+  bool share_result{true};
+};
+
+class TaskPool; // see Tasks.cpp
+
+/**
+ * @brief starts a pool for spawned calls: one worker per hardware thread,
+ * each with a native stack for the `max_call_depth` of `options`, which the
+ * tasks' evaluators are also given. Calls spawned by a task go to the pool
+ * it runs on. Destroying the pool waits for the tasks still queued.
+ *
+ */
+auto start_task_pool(const EvaluatorOptions &options)
+    -> std::shared_ptr<TaskPool>;
+// runs `call` on `pool` and returns its future
+auto spawn_task(TaskPool &pool, TaskCall call) -> FuturePtr;
+auto task_pool_size(const TaskPool &pool) -> size_t;
+
+/**
+ * @brief waits for `future`. A worker waiting on a task runs the tasks it
+ * spawned itself in the meantime (usually including the one it waits for)
+ * rather than block; any other thread simply blocks.
+ *
+ */
+auto await_future(BoopFuture &future) -> void;
+
+} // namespace boop
+
+#endif // __TASKS_H__
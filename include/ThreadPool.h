@@ -0,0 +1,94 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include "Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pthread.h>
+
+namespace boop {
+
+struct ThreadPoolOptions {
+  // 0 means one thread per hardware thread
+  size_t thread_count{};
+  // native stack of every worker, 0 for the platform's default. Sized like
+  // EvaluatorOptions::native_stack_bytes, it lets isolates evaluate right on
+  // the worker instead of starting a dedicated thread per script.
+  size_t stack_bytes{};
+};
+
+/**
+ * @brief fixed set of worker threads scheduling tasks by work stealing. Every
+ * worker has a deque of its own: tasks submitted by a worker (a task spawning
+ * more tasks) go to the bottom of its deque and it takes them back LIFO, so it
+ * keeps working on what's hot in its cache, while idle workers steal from the
+ * top of the others' deques, taking the oldest and usually largest pieces of
+ * work. Tasks submitted from outside the pool go to a shared FIFO queue.
+ *
+ * Tasks must not throw. The destructor runs whatever is still queued before
+ * joining the workers.
+ *
+ */
+class ThreadPool : public Uncopyable {
+public:
+  using Task = std::function<void()>;
+
+private:
+  class TaskDeque; // see ThreadPool.cpp
+
+  std::vector<pthread_t> m_threads;
+  std::vector<std::unique_ptr<TaskDeque>> m_deques; // one per worker
+  size_t m_stack_bytes{};
+  std::atomic<size_t> m_started{0}; // hands the workers their indices
+  std::mutex m_mutex;
+  std::condition_variable m_work_ready; // a task was queued, or stopping
+  std::condition_variable m_idle;       // every task has finished
+  std::deque<Task *> m_injected;        // submitted from outside the pool
+  std::atomic<size_t> m_queued{0};      // submitted, not yet taken by anyone
+  std::atomic<size_t> m_unfinished{0};  // submitted, not yet finished
+  std::atomic<size_t> m_sleeping{0};    // workers waiting for m_work_ready
+  bool m_stopping{false};
+
+public:
+  explicit ThreadPool(ThreadPoolOptions options = ThreadPoolOptions{});
+  ~ThreadPool() override;
+
+  auto submit(Task task) -> void;
+  // blocks until every submitted task has finished
+  auto wait_idle() -> void;
+
+  /**
+   * @brief runs the task a worker of this pool submitted last, if it has one
+   * it hasn't been robbed of. For a worker waiting on the result of its own
+   * tasks: it runs them itself instead of blocking. Returns false on any
+   * other thread and when the worker's deque is empty.
+   *
+   */
+  auto run_own_task() -> bool;
+  // whether the calling thread is one of this pool's workers
+  auto is_worker_thread() const noexcept -> bool;
+
+  auto size() const noexcept -> size_t;
+  // stack size the workers actually got; 0 if it's the platform's default
+  auto stack_bytes() const noexcept -> size_t;
+
+private:
+  // starts a worker with a `stack_bytes` stack (the default one if 0)
+  auto start_worker(size_t stack_bytes, pthread_t &thread) -> bool;
+  auto work() -> void;
+  // the next task for worker `index`: its own, a stolen or an injected one
+  auto find_task(size_t index) -> Task *;
+  auto run(Task *task) -> void;
+};
+
+} // namespace boop
+
+#endif // __THREADPOOL_H__
@@ -1,58 +1,69 @@
-#ifndef __TOKENTYPE_H__
-#define __TOKENTYPE_H__
-
-namespace boop {
-
-enum TokenType {
-  // Single-character tokens.
-  LEFT_PAREN,
-  RIGHT_PAREN,
-  LEFT_BRACE,
-  RIGHT_BRACE,
-  COMMA,
-  DOT,
-  MINUS,
-  PLUS,
-  SEMICOLON,
-  SLASH,
-  STAR,
-
-  // One or two character tokens.
-  BANG,
-  BANG_EQUAL,
-  EQUAL,
-  EQUAL_EQUAL,
-  GREATER,
-  GREATER_EQUAL,
-  LESS,
-  LESS_EQUAL,
-
-  // Literals.
-  IDENTIFIER,
-  STRING,
-  NUMBER,
-
-  // Keywords.
-  AND,
-  CLASS,
-  ELSE,
-  FALSE,
-  FUN,
-  FOR,
-  IF,
-  NIL,
-  OR,
-  PRINT,
-  RETURN,
-  SUPER,
-  THIS,
-  TRUE,
-  VAR,
-  WHILE,
-
-  EOF
-};
-
-}
-
-#endif // __TOKENTYPE_H__
+#ifndef __TOKENTYPE_H__
+#define __TOKENTYPE_H__
+
+namespace boop {
+
+enum TokenType {
+  // Single-character tokens.
+  LEFT_PAREN,
+  RIGHT_PAREN,
+  LEFT_BRACE,
+  RIGHT_BRACE,
+  LEFT_BRACKET,
+  RIGHT_BRACKET,
+  COMMA,
+  COLON,
+  DOT,
+  MINUS,
+  PLUS,
+  SEMICOLON,
+  SLASH,
+  STAR,
+
+  // One or two character tokens.
+  BANG,
+  BANG_EQUAL,
+  EQUAL,
+  EQUAL_EQUAL,
+  GREATER,
+  GREATER_EQUAL,
+  LESS,
+  LESS_EQUAL,
+  PLUS_PLUS,
+  MINUS_MINUS,
+
+  // Literals.
+  IDENTIFIER,
+  STRING,
+  NUMBER,
+
+  // Keywords.
+  AND,
+  ASYNC,
+  AWAIT,
+  BREAK,
+  CLASS,
+  CONTINUE,
+  ELSE,
+  FALSE,
+  FUN,
+  FOR,
+  GO,
+  IF,
+  NIL,
+  OR,
+  PRINT,
+  RETURN,
+  SPAWN,
+  SUPER,
+  THIS,
+  TRUE,
+  VAR,
+  WHILE,
+
+  END_OF_FILE // EOF is a macro of <cstdio>
+};
+
+}
+
+#endif // __TOKENTYPE_H__
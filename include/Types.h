@@ -1,139 +1,349 @@
-#ifndef __TYPES_H__
-#define __TYPES_H__
-
-/**
- * @file Types.h
- * @author ddamiana
- * @brief contains core types of the language
- * @version 0.1
- * @date 2022-07-18
- *
- * @copyright Copyright (c) 2022
- *
- */
-
-#include "Environment.h"
-#include "ASTNodes.h"
-#include "Token.h"
-
-#include <memory>
-#include <optional>
-#include <string>
-#include <variant>
-#include <utility>
-#include <map>
-
-namespace boop {
-
-struct Uncopyable {
-  explicit Uncopyable() = default;
-  Uncopyable(const Uncopyable &) = delete;
-  Uncopyable(Uncopyable &&) = delete;
-
-  virtual ~Uncopyable() = default;
-
-  auto operator=(const Uncopyable &) noexcept -> Uncopyable & = delete;
-  auto operator=(Uncopyable &&) noexcept -> Uncopyable & = delete;
-};
-
-using LiteralType = std::variant<std::string, double, float, int>;
-using OptionalLiteral = std::optional<LiteralType>;
-
-auto get_literal_string(const LiteralType &value) -> std::string;
-auto make_optional_literal(double value) -> OptionalLiteral;
-auto make_optional_literal(const std::string &lexeme) -> OptionalLiteral;
-
-// forward declaration of types
-struct Functor;
-struct BuiltinFunction;
-struct BoopClass;
-struct BoopInstance;
-
-using FunctionPtr = std::shared_ptr<Functor>;
-using BuiltinFunctionPtr = std::shared_ptr<BuiltinFunction>;
-using BoopClassPtr = std::shared_ptr<BoopClass>;
-using BoopInstancePtr = std::shared_ptr<BoopInstance>;
-
-using BoopObject = std::variant<std::string, double, bool, std::nullptr_t,
-                                FunctionPtr, BuiltinFunctionPtr, BoopClassPtr,
-                                BoopClassPtr, BoopInstancePtr>;
-
-// external functions
-auto are_equals(const BoopObject& left, const BoopObject& right) -> bool;
-auto get_object_string(const BoopObject& object) -> std::string;
-auto is_true(const BoopObject& object) -> bool;
-
-// type declarations
-struct Functor : public Uncopyable {
-private:
-  const AST::ExprFunctionPtr &m_declaration;
-  const std::string m_name{};
-  std::shared_ptr<Environment> m_closure;
-  bool m_is_method{false};
-  bool m_is_initializer{false};
-
-public:
-  explicit Functor(const AST::ExprFunctionPtr &declaration, std::string name,
-                   std::shared_ptr<Environment> closure);
-
-  auto arity() const noexcept -> size_t;
-  auto get_closure() const noexcept -> std::shared_ptr<Environment>;
-  const auto get_declaration() const noexcept -> AST::ExprFunctionPtr&;
-  const auto get_name() const noexcept -> std::string&; // see if this can be optimized using std::string_view 
-  const auto get_body_stmt() const -> std::vector<AST::StmtPtrVariant>&; 
-  
-  auto is_method() const noexcept -> bool;
-  auto is_initializer() const noexcept -> bool;
-  
-  auto get_params() const noexcept -> std::vector<Token>&;
-};
-
-struct BuiltinFunction: public Uncopyable {
-private: 
-  std::string m_name{};
-  std::shared_ptr<Environment> m_closure;
-
-public:
-  explicit BuiltinFunction(std::string name, std::shared_ptr<Environment> closure);
-
-  // abstract methods for communicating with built-in functions
-  virtual auto arity() -> size_t = 0;
-  virtual auto run() -> BoopObject = 0;
-  virtual auto get_name() -> std::string = 0;
-};
-
-struct BoopClass: public Uncopyable {
-private:
-  const std::string m_name;
-  std::optional<BoopClassPtr> m_super_class;
-  std::hash<std::string> m_hasher;
-  std::map<size_t, BoopObject> m_methods;
-
-public:
-  explicit BoopClass(
-      std::string name, std::optional<BoopClassPtr> super,
-      const std::vector<std::pair<std::string, BoopObject>> &method_pairs);
-
-  auto get_name() -> std::string;
-  auto get_super_class() -> std::optional<BoopClassPtr>;
-
-  auto find_methods(const std::string &name) -> std::optional<BoopObject>;
-};
-
-struct BoopInstance: public Uncopyable {
-private: 
-  const BoopClassPtr m_class;
-  std::hash<std::string> m_hasher;
-  std::map<size_t, BoopObject> m_fields;
-
-public:
-  explicit BoopInstance(BoopClassPtr _class);
-
-  auto to_string() -> std::string;
-  auto get(const std::string& name) -> BoopObject;
-  auto set(const std::string& name, BoopObject value) -> void;
-};
-
-} // namespace boop
-
+#ifndef __TYPES_H__
+#define __TYPES_H__
+
+/**
+ * @file Types.h
+ * @author ddamiana
+ * @brief contains core types of the language
+ * @version 0.1
+ * @date 2022-07-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <utility>
+#include <map>
+#include <vector>
+
+namespace boop {
+
+struct Uncopyable {
+  explicit Uncopyable() = default;
+  Uncopyable(const Uncopyable &) = delete;
+  Uncopyable(Uncopyable &&) = delete;
+
+  virtual ~Uncopyable() = default;
+
+  auto operator=(const Uncopyable &) noexcept -> Uncopyable & = delete;
+  auto operator=(Uncopyable &&) noexcept -> Uncopyable & = delete;
+};
+
+using LiteralType = std::variant<std::string, double, float, int64_t>;
+using OptionalLiteral = std::optional<LiteralType>;
+
+auto get_literal_string(const LiteralType &value) -> std::string;
+// shortest text that reads back as the same double, "0.1" rather than
+// "0.100000"; integral values print without a fraction
+auto format_number(double value) -> std::string;
+auto make_optional_literal(double value) -> OptionalLiteral;
+auto make_optional_literal(int64_t value) -> OptionalLiteral;
+auto make_optional_literal(const std::string &lexeme) -> OptionalLiteral;
+
+/**
+ * @brief immutable, reference-counted string value. Copies share one buffer,
+ * so passing strings around costs a reference count rather than a copy of the
+ * contents. The hash is computed on first use and cached in the buffer.
+ *
+ * Concatenation builds a rope node pointing at both halves, so appending to
+ * an accumulator doesn't copy it. The rope is flattened into a single buffer
+ * the first time its contents are needed (`str()` or `hash()`). Flattening
+ * isn't synchronized, so a string is flattened before it is handed to
+ * another thread (see Sharing.h).
+ *
+ */
+class BoopString {
+private:
+  struct Rep {
+    mutable std::string text; // the contents, once flat
+    // halves of a concatenation that hasn't been flattened yet
+    mutable std::shared_ptr<const Rep> left;
+    mutable std::shared_ptr<const Rep> right;
+    const size_t length;
+    mutable std::atomic<size_t> hash{0}; // 0 until computed
+
+    explicit Rep(std::string value);
+    Rep(std::shared_ptr<const Rep> left, std::shared_ptr<const Rep> right);
+    ~Rep();
+    Rep(const Rep &) = delete;
+    auto operator=(const Rep &) -> Rep & = delete;
+
+    auto is_flat() const noexcept -> bool { return left == nullptr; }
+    auto flatten() const -> void;
+  };
+  // concatenations shorter than this are copied right away; a rope node
+  // costs more than copying a few bytes
+  static const size_t MIN_ROPE_LENGTH = 64;
+  std::shared_ptr<const Rep> m_rep;
+
+  explicit BoopString(std::shared_ptr<const Rep> rep);
+
+public:
+  BoopString(); // the empty string; shares a single buffer
+  explicit BoopString(std::string text);
+
+  static auto concat(const BoopString &left, const BoopString &right)
+      -> BoopString;
+
+  auto str() const -> const std::string &;
+  auto size() const noexcept -> size_t;
+  auto hash() const -> size_t;
+  auto shares_buffer(const BoopString &other) const noexcept -> bool;
+};
+
+// same buffer, then length and hash mismatches, then a full compare
+auto operator==(const BoopString &left, const BoopString &right) -> bool;
+auto operator!=(const BoopString &left, const BoopString &right) -> bool;
+
+// forward declaration of types
+namespace AST {
+struct ExprFunction;
+using ExprFunctionPtr = std::unique_ptr<ExprFunction>;
+} // namespace AST
+class Token;
+template <typename T> struct Result;
+struct NativeContext;
+struct Functor;
+struct BuiltinFunction;
+struct BoopClass;
+struct BoopInstance;
+struct BoopList;
+class BoopMap;
+struct Float64Array;
+struct Upvalue;
+class Program;
+class BoopFuture;
+class BoopChannel;
+class BoopPort;
+class BoopStream;
+
+using FunctionPtr = std::shared_ptr<Functor>;
+using BuiltinFunctionPtr = std::shared_ptr<BuiltinFunction>;
+using BoopClassPtr = std::shared_ptr<BoopClass>;
+using BoopInstancePtr = std::shared_ptr<BoopInstance>;
+using BoopListPtr = std::shared_ptr<BoopList>;
+using BoopMapPtr = std::shared_ptr<BoopMap>;
+using Float64ArrayPtr = std::shared_ptr<Float64Array>;
+using UpvaluePtr = std::shared_ptr<Upvalue>;
+using ProgramPtr = std::shared_ptr<const Program>;
+using FuturePtr = std::shared_ptr<BoopFuture>;
+using ChannelPtr = std::shared_ptr<BoopChannel>;
+using PortPtr = std::shared_ptr<BoopPort>;
+using StreamPtr = std::shared_ptr<BoopStream>;
+
+// integers are int64_t; arithmetic that overflows them is promoted to double
+using BoopObject = std::variant<BoopString, double, bool, std::nullptr_t,
+                                FunctionPtr, BuiltinFunctionPtr, BoopClassPtr,
+                                BoopInstancePtr, int64_t, BoopListPtr,
+                                BoopMapPtr, Float64ArrayPtr, FuturePtr,
+                                ChannelPtr, PortPtr, StreamPtr>;
+
+// external functions
+auto are_equals(const BoopObject& left, const BoopObject& right) -> bool;
+auto get_object_string(const BoopObject& object) -> std::string;
+auto is_true(const BoopObject& object) -> bool;
+// -1, 0 or 1 as `integer` is less than, equal to or greater than `number`,
+// compared exactly rather than after rounding `integer` to a double; 2 if
+// `number` is NaN
+auto compare_int_double(int64_t integer, double number) noexcept -> int;
+// runtime value of a literal; the string literals "true", "false" and "nil"
+// stand for those values
+auto make_boop_object(const OptionalLiteral &literal) -> BoopObject;
+
+// type declarations
+
+/**
+ * @brief base of the values that can be frozen (see Sharing.h). A frozen
+ * value never changes again, so any number of threads may read it at once;
+ * everything that would modify it fails with a runtime error instead.
+ *
+ */
+class Freezable {
+private:
+  std::atomic<bool> m_frozen{false};
+
+public:
+  auto is_frozen() const noexcept -> bool {
+    return m_frozen.load(std::memory_order_acquire);
+  }
+  // set once whatever the value holds has been frozen as well
+  auto mark_frozen() noexcept -> void {
+    m_frozen.store(true, std::memory_order_release);
+  }
+};
+
+/**
+ * @brief a variable captured by a closure. While the declaring frame is live
+ * the upvalue is open and points at its stack slot; once the variable goes out
+ * of scope the value is moved into the upvalue itself.
+ *
+ */
+struct Upvalue : public Uncopyable {
+  BoopObject *location{nullptr};
+  BoopObject closed{nullptr};
+  size_t stack_index{}; // only meaningful while open
+
+  explicit Upvalue(BoopObject *slot, size_t index)
+      : location(slot), stack_index(index) {}
+
+  auto is_open() const noexcept -> bool { return location != &closed; }
+  auto close() -> void {
+    closed = std::move(*location);
+    location = &closed;
+  }
+};
+
+struct Functor : public Uncopyable {
+private:
+  const ProgramPtr m_program; // owns the AST m_declaration points into
+  const AST::ExprFunctionPtr &m_declaration;
+  const std::string m_name{};
+  std::vector<UpvaluePtr> m_upvalues;
+  bool m_is_method{false};
+  bool m_is_initializer{false};
+  BoopInstancePtr m_receiver{nullptr}; // 'this' of a bound method
+
+public:
+  explicit Functor(ProgramPtr program,
+                   const AST::ExprFunctionPtr &declaration, std::string name,
+                   std::vector<UpvaluePtr> upvalues, bool is_method = false,
+                   bool is_initializer = false,
+                   BoopInstancePtr receiver = nullptr);
+
+  auto arity() const noexcept -> size_t;
+  auto get_program() const noexcept -> const ProgramPtr &;
+  auto get_upvalues() const noexcept -> const std::vector<UpvaluePtr> &;
+  auto get_declaration() const noexcept -> const AST::ExprFunctionPtr &;
+  auto get_name() const noexcept -> const std::string &;
+  
+  auto is_method() const noexcept -> bool;
+  auto is_initializer() const noexcept -> bool;
+  auto get_receiver() const noexcept -> const BoopInstancePtr &;
+  
+  auto get_params() const noexcept -> const std::vector<Token> &;
+};
+
+/**
+ * @brief non-owning view of the arguments of a native call. They stay on the
+ * evaluator's value stack for the duration of the call; nothing is copied
+ * into a container of their own.
+ *
+ */
+class ArgSpan {
+private:
+  const BoopObject *m_data{nullptr};
+  size_t m_size{};
+
+public:
+  ArgSpan() = default;
+  ArgSpan(const BoopObject *data, size_t size) : m_data(data), m_size(size) {}
+
+  auto operator[](size_t index) const noexcept -> const BoopObject & {
+    return m_data[index];
+  }
+  auto size() const noexcept -> size_t { return m_size; }
+  auto begin() const noexcept -> const BoopObject * { return m_data; }
+  auto end() const noexcept -> const BoopObject * { return m_data + m_size; }
+};
+
+/**
+ * @brief function implemented in C++. The evaluator checks the arity (unless
+ * it is VARIADIC) before calling it; see Native.h for the context it gets and
+ * for wrapping plain C++ functions.
+ *
+ */
+struct BuiltinFunction: public Uncopyable {
+  static constexpr size_t VARIADIC = SIZE_MAX;
+
+private: 
+  std::string m_name{};
+  size_t m_arity{};
+
+public:
+  explicit BuiltinFunction(std::string name, size_t arity);
+
+  auto arity() const noexcept -> size_t;
+  auto get_name() const noexcept -> const std::string &;
+
+  virtual auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> = 0;
+};
+
+struct BoopClass: public Uncopyable {
+private:
+  const std::string m_name;
+  std::optional<BoopClassPtr> m_super_class;
+  std::hash<std::string> m_hasher;
+  std::map<size_t, BoopObject> m_methods;
+
+public:
+  explicit BoopClass(
+      std::string name, std::optional<BoopClassPtr> super,
+      const std::vector<std::pair<std::string, BoopObject>> &method_pairs);
+
+  auto get_name() -> std::string;
+  auto get_super_class() -> std::optional<BoopClassPtr>;
+
+  auto find_methods(const std::string &name) -> std::optional<BoopObject>;
+  // the class's own methods, keyed by the hash of their names
+  auto get_methods() const noexcept -> const std::map<size_t, BoopObject> &;
+};
+
+struct BoopInstance: public Uncopyable, public Freezable {
+private: 
+  const BoopClassPtr m_class;
+  std::hash<std::string> m_hasher;
+  std::map<size_t, BoopObject> m_fields;
+
+public:
+  explicit BoopInstance(BoopClassPtr _class);
+
+  auto to_string() -> std::string;
+  auto get(const std::string& name) -> std::optional<BoopObject>;
+  auto set(const std::string& name, BoopObject value) -> void;
+
+  auto get_class() const noexcept -> const BoopClassPtr &;
+  auto get_fields() const noexcept -> const std::map<size_t, BoopObject> &;
+  // replaces every field at once, for filling in a copy
+  auto set_fields(std::map<size_t, BoopObject> fields) -> void;
+};
+
+/**
+ * @brief list value. The elements are stored contiguously, so appending is
+ * amortized O(1) and indexing is a bounds check plus an offset; nothing is
+ * hashed. Lists are shared by reference like instances.
+ *
+ */
+struct BoopList : public Uncopyable, public Freezable {
+  std::vector<BoopObject> elements;
+
+  BoopList() = default;
+  explicit BoopList(std::vector<BoopObject> _elements);
+
+  auto size() const noexcept -> size_t { return elements.size(); }
+};
+
+/**
+ * @brief fixed-size array of unboxed doubles. Arithmetic operators and the
+ * array builtins run over the whole array in native kernels (see Kernels.h)
+ * instead of element by element in the interpreter.
+ *
+ */
+struct Float64Array : public Uncopyable, public Freezable {
+  std::vector<double> data;
+
+  explicit Float64Array(size_t size) : data(size, 0.0) {}
+  explicit Float64Array(std::vector<double> _data) : data(std::move(_data)) {}
+
+  auto size() const noexcept -> size_t { return data.size(); }
+};
+
+} // namespace boop
+
 #endif // __TYPES_H__
\ No newline at end of file
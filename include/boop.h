@@ -0,0 +1,142 @@
+#ifndef __BOOP_H__
+#define __BOOP_H__
+
+/**
+ * @file boop.h
+ * @brief C API of libboop, for embedding the interpreter in C and C++ hosts.
+ *
+ * An interpreter is an isolate: it has its own globals and objects and may be
+ * used by one thread at a time, while different interpreters run in parallel.
+ * A compiled program is immutable and may be run by any number of
+ * interpreters, on any threads, without being compiled again.
+ *
+ * Every function reports failure through its return value; the messages are
+ * then available from boop_last_error until the next call on the same
+ * interpreter. No C++ exception ever crosses this API.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define BOOP_API __attribute__((visibility("default")))
+#else
+#define BOOP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct boop_interpreter boop_interpreter;
+typedef struct boop_program boop_program;
+typedef struct boop_call boop_call; /* a running host function call */
+typedef struct boop_port boop_port; /* a channel between interpreters */
+
+typedef enum boop_status {
+  BOOP_OK = 0,
+  BOOP_COMPILE_ERROR,
+  BOOP_RUNTIME_ERROR,
+  BOOP_INVALID_ARGUMENT
+} boop_status;
+
+typedef enum boop_type {
+  BOOP_NIL,
+  BOOP_BOOL,
+  BOOP_INT,
+  BOOP_NUMBER,
+  BOOP_STRING,
+  /* functions, classes, instances and containers; `string` holds the text
+     `print` would show for them */
+  BOOP_OTHER
+} boop_type;
+
+/**
+ * @brief a value crossing the API. Strings are not owned by the value:
+ * arguments handed to a host function are valid until it returns, results
+ * until the next call on the interpreter that produced them, and strings the
+ * host passes in are copied before the call returns.
+ *
+ */
+typedef struct boop_value {
+  boop_type type;
+  union {
+    int boolean;
+    int64_t integer;
+    double number;
+    struct {
+      const char *data;
+      size_t length;
+    } string;
+  } as;
+} boop_value;
+
+typedef struct boop_options {
+  /* deeper calls fail with a "Stack overflow." error; 0 for the default */
+  size_t max_call_depth;
+  /* descriptor `print` writes to; 0 (standard input, never written to) for
+     the default, standard output, so zeroed options stay the defaults */
+  int output_fd;
+} boop_options;
+
+/* NULL options give the defaults: standard output and the default depth */
+BOOP_API boop_interpreter *boop_new(const boop_options *options);
+BOOP_API void boop_free(boop_interpreter *interpreter);
+
+/* the errors of the last failed call on `interpreter`, one per line */
+BOOP_API const char *boop_last_error(const boop_interpreter *interpreter);
+
+/* compiles `source`; errors are reported to `interpreter`, but the program
+   may be run by any interpreter */
+BOOP_API boop_status boop_compile(boop_interpreter *interpreter,
+                                  const char *source, size_t length,
+                                  boop_program **program);
+BOOP_API void boop_program_free(boop_program *program);
+
+/* runs a whole script; the globals it defines stay for later runs and calls */
+BOOP_API boop_status boop_run(boop_interpreter *interpreter,
+                              const boop_program *program);
+BOOP_API boop_status boop_run_source(boop_interpreter *interpreter,
+                                     const char *source, size_t length);
+
+/* calls the global function `name`; `result` may be NULL. The call runs on
+   the calling thread's stack. */
+BOOP_API boop_status boop_call_function(boop_interpreter *interpreter,
+                                        const char *name,
+                                        const boop_value *args, size_t count,
+                                        boop_value *result);
+
+/**
+ * @brief host function callable from scripts. `result` starts out nil. On
+ * failure return anything but BOOP_OK, after boop_call_error if the script
+ * should see a specific message.
+ *
+ */
+typedef boop_status (*boop_host_function)(boop_call *call,
+                                          const boop_value *args, size_t count,
+                                          boop_value *result, void *userdata);
+
+/* makes `function` the global `name`; a negative arity takes any number of
+   arguments */
+BOOP_API boop_status boop_define_function(boop_interpreter *interpreter,
+                                          const char *name, int arity,
+                                          boop_host_function function,
+                                          void *userdata);
+BOOP_API void boop_call_error(boop_call *call, const char *message);
+
+/* a port buffering at least `capacity` values, which scripts use with send,
+   recv and close; NULL if out of memory */
+BOOP_API boop_port *boop_port_new(size_t capacity);
+/* drops the host's reference; interpreters given the port keep it alive */
+BOOP_API void boop_port_free(boop_port *port);
+/* makes `port` the global `name` of `interpreter`. Interpreters given the
+   same port can stream values to each other from any threads. */
+BOOP_API boop_status boop_define_port(boop_interpreter *interpreter,
+                                      const char *name, const boop_port *port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOP_H__ */
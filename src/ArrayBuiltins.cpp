@@ -0,0 +1,151 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Kernels.h"
+#include "../include/Native.h"
+#include "../include/Types.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+using ArrayArg = native::ArgTraits<Float64ArrayPtr>;
+
+auto to_list(const Float64ArrayPtr &array) -> BoopListPtr {
+  auto list = std::make_shared<BoopList>();
+  list->elements.reserve(array->size());
+  for (const double value : array->data)
+    list->elements.emplace_back(value);
+  return list;
+}
+
+auto sum(const Float64ArrayPtr &array) -> double {
+  return kernels::sum(array->data.data(), array->size());
+}
+
+auto scale(const Float64ArrayPtr &array, double factor) -> Float64ArrayPtr {
+  auto result = std::make_shared<Float64Array>(array->size());
+  kernels::mul_scalar(array->data.data(), factor, result->data.data(),
+                      array->size());
+  return result;
+}
+
+auto cumsum(const Float64ArrayPtr &array) -> Float64ArrayPtr {
+  auto result = std::make_shared<Float64Array>(array->size());
+  kernels::cumsum(array->data.data(), result->data.data(), array->size());
+  return result;
+}
+
+// checks that every argument is an array as long as the first
+auto check_arrays(NativeContext &context, const std::string &name,
+                  ArgSpan args) -> Status {
+  for (size_t i = 0; i < args.size(); ++i)
+    if (EXPECT_FALSE(!ArrayArg::matches(args[i])))
+      return context.error("Argument " + std::to_string(i + 1) + " of " +
+                           name + " must be a Float64Array.");
+  const size_t size = ArrayArg::get(args[0])->size();
+  for (size_t i = 1; i < args.size(); ++i)
+    if (EXPECT_FALSE(ArrayArg::get(args[i])->size() != size))
+      return context.error("The arrays passed to " + name +
+                           " differ in length.");
+  return Status::OK;
+}
+
+struct MakeArray final : public BuiltinFunction {
+  MakeArray() : BuiltinFunction("Float64Array", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (const auto *size = std::get_if<int64_t>(&args[0])) {
+      if (EXPECT_FALSE(*size < 0))
+        return context.error("A Float64Array can't have a negative length.");
+      return BoopObject(
+          std::make_shared<Float64Array>(static_cast<size_t>(*size)));
+    }
+    if (const auto *array = std::get_if<Float64ArrayPtr>(&args[0]))
+      return BoopObject(std::make_shared<Float64Array>((*array)->data));
+    if (const auto *list = std::get_if<BoopListPtr>(&args[0])) {
+      std::vector<double> data;
+      data.reserve((*list)->size());
+      for (const auto &element : (*list)->elements) {
+        if (EXPECT_FALSE(!native::ArgTraits<double>::matches(element)))
+          return context.error("A Float64Array can only hold numbers.");
+        data.push_back(native::ArgTraits<double>::get(element));
+      }
+      return BoopObject(std::make_shared<Float64Array>(std::move(data)));
+    }
+    return context.error("Argument 1 of Float64Array must be a length, a "
+                         "list or a Float64Array.");
+  }
+};
+
+struct Dot final : public BuiltinFunction {
+  Dot() : BuiltinFunction("dot", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    RETURN_IF_ERROR(check_arrays(context, get_name(), args));
+    const auto &a = ArrayArg::get(args[0]);
+    return BoopObject(kernels::dot(a->data.data(),
+                                   ArrayArg::get(args[1])->data.data(),
+                                   a->size()));
+  }
+};
+
+struct Fma final : public BuiltinFunction {
+  Fma() : BuiltinFunction("fma", 3) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    RETURN_IF_ERROR(check_arrays(context, get_name(), args));
+    const size_t size = ArrayArg::get(args[0])->size();
+    auto result = std::make_shared<Float64Array>(size);
+    kernels::fma(ArrayArg::get(args[0])->data.data(),
+                 ArrayArg::get(args[1])->data.data(),
+                 ArrayArg::get(args[2])->data.data(), result->data.data(),
+                 size);
+    return BoopObject(std::move(result));
+  }
+};
+
+// amin and amax; an empty array has neither
+struct Extremum final : public BuiltinFunction {
+  using Kernel = double (*)(const double *, size_t);
+  const Kernel kernel;
+
+  Extremum(std::string name, Kernel _kernel)
+      : BuiltinFunction(std::move(name), 1), kernel(_kernel) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    RETURN_IF_ERROR(check_arrays(context, get_name(), args));
+    const auto &array = ArrayArg::get(args[0]);
+    if (EXPECT_FALSE(array->size() == 0))
+      return context.error("Argument 1 of " + get_name() +
+                           " must not be empty.");
+    return BoopObject(kernel(array->data.data(), array->size()));
+  }
+};
+} // namespace
+
+auto define_array_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<MakeArray>());
+  evaluator.define_native(make_native<&to_list>("to_list"));
+  evaluator.define_native(make_native<&sum>("sum"));
+  evaluator.define_native(std::make_shared<Dot>());
+  evaluator.define_native(std::make_shared<Extremum>("amin", &kernels::min));
+  evaluator.define_native(std::make_shared<Extremum>("amax", &kernels::max));
+  evaluator.define_native(make_native<&scale>("scale"));
+  evaluator.define_native(std::make_shared<Fma>());
+  evaluator.define_native(make_native<&cumsum>("cumsum"));
+}
+
+} // namespace boop
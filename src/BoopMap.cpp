@@ -0,0 +1,198 @@
+#include "../include/BoopMap.h"
+#include "../include/MapGroup.h"
+#include "../include/Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+using map_group::DELETED;
+using map_group::EMPTY;
+using map_group::Group;
+constexpr size_t GROUP_WIDTH = Group::WIDTH;
+
+auto lowest_slot(uint64_t bits) noexcept -> size_t {
+  return static_cast<size_t>(__builtin_ctzll(bits)) >> Group::SHIFT;
+}
+
+// at most 7/8 of the slots may be used before the table is rebuilt
+auto max_load(size_t capacity) noexcept -> size_t {
+  return capacity - capacity / 8;
+}
+
+auto h2_of(size_t hash) noexcept -> int8_t {
+  return static_cast<int8_t>(hash & 0x7F);
+}
+
+// the finalizer of MurmurHash3; spreads small integers over all the bits
+auto mix(uint64_t value) noexcept -> size_t {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return static_cast<size_t>(value);
+}
+
+// equal keys hash equally, in particular an integral double and the int64_t
+// of the same value
+auto hash_key(const BoopObject &key) -> size_t {
+  if (const auto *str = std::get_if<BoopString>(&key))
+    return mix(str->hash());
+  if (const auto *integer = std::get_if<int64_t>(&key))
+    return mix(static_cast<uint64_t>(*integer));
+  if (const auto *number = std::get_if<double>(&key)) {
+    if (std::trunc(*number) == *number && *number >= -0x1p63 &&
+        *number < 0x1p63)
+      return mix(static_cast<uint64_t>(static_cast<int64_t>(*number)));
+    uint64_t bits{};
+    std::memcpy(&bits, number, sizeof(bits));
+    return mix(bits);
+  }
+  return mix(std::get<bool>(key) ? 0x9e3779b97f4a7c15ULL : 0x7f4a7c159e3779b9ULL);
+}
+} // namespace
+
+auto BoopMap::is_valid_key(const BoopObject &key) noexcept -> bool {
+  if (const auto *number = std::get_if<double>(&key))
+    return !std::isnan(*number);
+  return std::holds_alternative<BoopString>(key) ||
+         std::holds_alternative<int64_t>(key) ||
+         std::holds_alternative<bool>(key);
+}
+
+auto BoopMap::capacity() const noexcept -> size_t {
+  return m_group_count * GROUP_WIDTH;
+}
+
+auto BoopMap::find_slot(const BoopObject &key, size_t hash) const -> size_t {
+  if (EXPECT_FALSE(m_group_count == 0))
+    return NOT_FOUND;
+  const int8_t h2 = h2_of(hash);
+  const size_t mask = m_group_count - 1;
+  size_t group = (hash >> 7) & mask;
+  // triangular steps visit every group once the count is a power of two
+  for (size_t step = 1; step <= m_group_count; ++step) {
+    const size_t base = group * GROUP_WIDTH;
+    const Group ctrl(&m_ctrl[base]);
+    for (uint64_t bits = ctrl.match(h2); bits != 0; bits &= bits - 1) {
+      const size_t slot = base + lowest_slot(bits);
+      const Entry &entry = m_entries[m_slots[slot]];
+      if (EXPECT_TRUE(entry.hash == hash) && are_equals(entry.key, key))
+        return slot;
+    }
+    // the key would have been put in this group's empty slot
+    if (EXPECT_TRUE(ctrl.match_empty() != 0))
+      return NOT_FOUND;
+    group = (group + step) & mask;
+  }
+  return NOT_FOUND;
+}
+
+auto BoopMap::find_insert_slot(size_t hash) const -> size_t {
+  const size_t mask = m_group_count - 1;
+  size_t group = (hash >> 7) & mask;
+  for (size_t step = 1;; ++step) {
+    const size_t base = group * GROUP_WIDTH;
+    const uint64_t bits = Group(&m_ctrl[base]).match_empty_or_deleted();
+    if (EXPECT_TRUE(bits != 0))
+      return base + lowest_slot(bits);
+    group = (group + step) & mask;
+  }
+}
+
+auto BoopMap::find(const BoopObject &key) const -> const BoopObject * {
+  if (!is_valid_key(key))
+    return nullptr;
+  const size_t slot = find_slot(key, hash_key(key));
+  return slot == NOT_FOUND ? nullptr : &m_entries[m_slots[slot]].value;
+}
+
+auto BoopMap::contains(const BoopObject &key) const -> bool {
+  return find(key) != nullptr;
+}
+
+auto BoopMap::set(const BoopObject &key, BoopObject value) -> void {
+  const size_t hash = hash_key(key);
+  const size_t found = find_slot(key, hash);
+  if (found != NOT_FOUND) {
+    m_entries[m_slots[found]].value = std::move(value);
+    return;
+  }
+
+  size_t slot = m_group_count == 0 ? NOT_FOUND : find_insert_slot(hash);
+  // reusing a tombstone doesn't take up any more of the table
+  if (slot == NOT_FOUND || (m_ctrl[slot] == EMPTY && m_growth_left == 0)) {
+    rehash(2 * (m_size + 1));
+    slot = find_insert_slot(hash);
+  }
+  if (m_ctrl[slot] == EMPTY)
+    --m_growth_left;
+  m_ctrl[slot] = h2_of(hash);
+  m_slots[slot] = static_cast<uint32_t>(m_entries.size());
+  m_entries.push_back(Entry{key, std::move(value), hash});
+  ++m_size;
+}
+
+auto BoopMap::erase(const BoopObject &key) -> bool {
+  if (!is_valid_key(key))
+    return false;
+  const size_t slot = find_slot(key, hash_key(key));
+  if (slot == NOT_FOUND)
+    return false;
+
+  // the slot may sit in the middle of some other key's probe sequence, so it
+  // can't simply become EMPTY
+  m_ctrl[slot] = DELETED;
+  Entry &entry = m_entries[m_slots[slot]];
+  entry.key = nullptr;
+  entry.value = nullptr;
+  --m_size;
+
+  // don't let iteration walk over mostly holes
+  if (m_entries.size() > 2 * m_size + GROUP_WIDTH)
+    rehash(2 * m_size);
+  return true;
+}
+
+auto BoopMap::reserve(size_t count) -> void {
+  if (count > m_size + m_growth_left)
+    rehash(count);
+  m_entries.reserve(count);
+}
+
+auto BoopMap::rehash(size_t min_size) -> void {
+  size_t group_count = 1;
+  while (max_load(group_count * GROUP_WIDTH) < std::max(min_size, m_size))
+    group_count *= 2;
+
+  // squeeze out the holes left by erased entries, keeping the order
+  if (m_entries.size() != m_size)
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [](const Entry &entry) -> bool {
+                                     return !entry.is_live();
+                                   }),
+                    m_entries.end());
+
+  m_group_count = group_count;
+  m_ctrl.assign(capacity(), EMPTY);
+  m_slots.assign(capacity(), 0);
+  m_growth_left = max_load(capacity()) - m_size;
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    const size_t slot = find_insert_slot(m_entries[i].hash);
+    m_ctrl[slot] = h2_of(m_entries[i].hash);
+    m_slots[slot] = static_cast<uint32_t>(i);
+  }
+}
+
+} // namespace boop
@@ -0,0 +1,151 @@
+#include "../include/Builtins.h"
+#include "../include/BoopMap.h"
+#include "../include/Evaluator.h"
+#include "../include/Native.h"
+#include "../include/Sharing.h"
+#include "../include/Types.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto clock_ms() -> double {
+  return static_cast<double>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::high_resolution_clock::now().time_since_epoch())
+          .count());
+}
+
+auto map_get(const BoopMapPtr &map, const BoopObject &key) -> BoopObject {
+  const BoopObject *value = map->find(key);
+  return value == nullptr ? BoopObject(nullptr) : *value;
+}
+
+auto map_has(const BoopMapPtr &map, const BoopObject &key) -> bool {
+  return map->contains(key);
+}
+
+auto map_keys(const BoopMapPtr &map) -> BoopListPtr {
+  auto keys = std::make_shared<BoopList>();
+  keys->elements.reserve(map->size());
+  for (const auto &entry : map->entries())
+    if (entry.is_live())
+      keys->elements.push_back(entry.key);
+  return keys;
+}
+
+auto map_values(const BoopMapPtr &map) -> BoopListPtr {
+  auto values = std::make_shared<BoopList>();
+  values->elements.reserve(map->size());
+  for (const auto &entry : map->entries())
+    if (entry.is_live())
+      values->elements.push_back(entry.value);
+  return values;
+}
+
+// takes any kind of sized value, so it can't be a typed builtin
+struct Len final : public BuiltinFunction {
+  Len() : BuiltinFunction("len", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (const auto *list = std::get_if<BoopListPtr>(&args[0]))
+      return BoopObject(static_cast<int64_t>((*list)->size()));
+    if (const auto *map = std::get_if<BoopMapPtr>(&args[0]))
+      return BoopObject(static_cast<int64_t>((*map)->size()));
+    if (const auto *array = std::get_if<Float64ArrayPtr>(&args[0]))
+      return BoopObject(static_cast<int64_t>((*array)->size()));
+    if (const auto *str = std::get_if<BoopString>(&args[0]))
+      return BoopObject(static_cast<int64_t>(str->size()));
+    return context.error(
+        "Argument 1 of len must be a list, map, Float64Array or string.");
+  }
+};
+
+// the builtins modifying a list or map in place fail on frozen ones
+struct Push final : public BuiltinFunction {
+  Push() : BuiltinFunction("push", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!native::ArgTraits<BoopListPtr>::matches(args[0])))
+      return context.error("Argument 1 of push must be a list.");
+    const BoopListPtr &list = native::ArgTraits<BoopListPtr>::get(args[0]);
+    if (EXPECT_FALSE(list->is_frozen()))
+      return context.error("Can't push to a frozen list.");
+    list->elements.push_back(args[1]);
+    return BoopObject(nullptr);
+  }
+};
+
+struct Pop final : public BuiltinFunction {
+  Pop() : BuiltinFunction("pop", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!native::ArgTraits<BoopListPtr>::matches(args[0])))
+      return context.error("Argument 1 of pop must be a list.");
+    if (EXPECT_FALSE(is_frozen(args[0])))
+      return context.error("Can't pop from a frozen list.");
+    auto &elements = native::ArgTraits<BoopListPtr>::get(args[0])->elements;
+    if (EXPECT_FALSE(elements.empty()))
+      return context.error("Can't pop from an empty list.");
+    BoopObject last = std::move(elements.back());
+    elements.pop_back();
+    return last;
+  }
+};
+// rejects keys the map can't hold rather than ignoring them
+struct MapSet final : public BuiltinFunction {
+  MapSet() : BuiltinFunction("set", 3) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!native::ArgTraits<BoopMapPtr>::matches(args[0])))
+      return context.error("Argument 1 of set must be a map.");
+    if (EXPECT_FALSE(is_frozen(args[0])))
+      return context.error("Can't set a key of a frozen map.");
+    if (EXPECT_FALSE(!BoopMap::is_valid_key(args[1])))
+      return context.error(
+          "Map keys must be strings, booleans or numbers other than NaN.");
+    native::ArgTraits<BoopMapPtr>::get(args[0])->set(args[1], args[2]);
+    return BoopObject(nullptr);
+  }
+};
+
+struct MapDelete final : public BuiltinFunction {
+  MapDelete() : BuiltinFunction("delete", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!native::ArgTraits<BoopMapPtr>::matches(args[0])))
+      return context.error("Argument 1 of delete must be a map.");
+    if (EXPECT_FALSE(is_frozen(args[0])))
+      return context.error("Can't delete a key of a frozen map.");
+    return BoopObject(
+        native::ArgTraits<BoopMapPtr>::get(args[0])->erase(args[1]));
+  }
+};
+} // namespace
+
+auto define_core_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(make_native<&clock_ms>("clock"));
+  evaluator.define_native(std::make_shared<Len>());
+  evaluator.define_native(std::make_shared<Push>());
+  evaluator.define_native(std::make_shared<Pop>());
+  evaluator.define_native(make_native<&map_get>("get"));
+  evaluator.define_native(std::make_shared<MapSet>());
+  evaluator.define_native(make_native<&map_has>("has"));
+  evaluator.define_native(std::make_shared<MapDelete>());
+  evaluator.define_native(make_native<&map_keys>("keys"));
+  evaluator.define_native(make_native<&map_values>("values"));
+}
+
+} // namespace boop
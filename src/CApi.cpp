@@ -0,0 +1,308 @@
+#include "../include/boop.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Isolate.h"
+#include "../include/Native.h"
+#include "../include/Ports.h"
+#include "../include/Program.h"
+#include "../include/Types.h"
+
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct boop_interpreter {
+  boop::Isolate isolate;
+  std::string last_error;
+  // the last result of boop_call_function, whose strings the host may still
+  // be reading
+  boop::BoopObject result{nullptr};
+  std::string result_text; // of a BOOP_OTHER result
+
+  explicit boop_interpreter(boop::EvaluatorOptions options)
+      : isolate(options) {}
+};
+
+struct boop_program {
+  boop::ProgramPtr program;
+};
+
+struct boop_call {
+  std::string message; // set by boop_call_error
+};
+
+struct boop_port {
+  boop::PortPtr port;
+};
+
+namespace {
+using boop::BoopObject;
+
+auto make_value(boop_type type) -> boop_value {
+  boop_value value{};
+  value.type = type;
+  return value;
+}
+
+// `text` holds the printed form of anything that isn't a plain value; the
+// strings of the result point into `object` or `text`
+auto to_value(const BoopObject &object, std::string &text) -> boop_value {
+  if (std::holds_alternative<std::nullptr_t>(object))
+    return make_value(BOOP_NIL);
+  if (const auto *boolean = std::get_if<bool>(&object)) {
+    boop_value value = make_value(BOOP_BOOL);
+    value.as.boolean = *boolean ? 1 : 0;
+    return value;
+  }
+  if (const auto *integer = std::get_if<int64_t>(&object)) {
+    boop_value value = make_value(BOOP_INT);
+    value.as.integer = *integer;
+    return value;
+  }
+  if (const auto *number = std::get_if<double>(&object)) {
+    boop_value value = make_value(BOOP_NUMBER);
+    value.as.number = *number;
+    return value;
+  }
+  boop_value value = make_value(BOOP_OTHER);
+  const std::string *contents = &text;
+  if (const auto *str = std::get_if<boop::BoopString>(&object)) {
+    value.type = BOOP_STRING;
+    contents = &str->str();
+  } else {
+    text = boop::get_object_string(object);
+  }
+  value.as.string.data = contents->data();
+  value.as.string.length = contents->size();
+  return value;
+}
+
+// nullopt for values the host can't hand in (BOOP_OTHER)
+auto to_object(const boop_value &value) -> std::optional<BoopObject> {
+  switch (value.type) {
+  case BOOP_NIL:
+    return BoopObject(nullptr);
+  case BOOP_BOOL:
+    return BoopObject(value.as.boolean != 0);
+  case BOOP_INT:
+    return BoopObject(value.as.integer);
+  case BOOP_NUMBER:
+    return BoopObject(value.as.number);
+  case BOOP_STRING:
+    if (value.as.string.data == nullptr && value.as.string.length != 0)
+      return std::nullopt;
+    return BoopObject(boop::BoopString(
+        std::string(value.as.string.data == nullptr ? "" : value.as.string.data,
+                    value.as.string.length)));
+  default:
+    return std::nullopt;
+  }
+}
+
+auto join_errors(const std::vector<std::string> &errors) -> std::string {
+  std::string joined;
+  for (const auto &error : errors) {
+    if (!joined.empty())
+      joined += '\n';
+    joined += error;
+  }
+  return joined;
+}
+
+auto fail(boop_interpreter *interpreter, boop_status status) -> boop_status {
+  interpreter->last_error = join_errors(interpreter->isolate.get_errors());
+  return status;
+}
+
+auto fail(boop_interpreter *interpreter, std::string message) -> boop_status {
+  interpreter->last_error = std::move(message);
+  return BOOP_INVALID_ARGUMENT;
+}
+
+auto fail(boop_interpreter *interpreter, const std::exception &e)
+    -> boop_status {
+  interpreter->last_error = std::string("Error: ") + e.what();
+  return BOOP_RUNTIME_ERROR;
+}
+
+struct HostFunction final : public boop::BuiltinFunction {
+  const boop_host_function function;
+  void *const userdata;
+
+  HostFunction(std::string name, size_t arity, boop_host_function _function,
+               void *_userdata)
+      : BuiltinFunction(std::move(name), arity), function(_function),
+        userdata(_userdata) {}
+
+  auto call(boop::NativeContext &context, boop::ArgSpan args)
+      -> boop::Result<BoopObject> override {
+    std::vector<std::string> texts(args.size());
+    std::vector<boop_value> values;
+    values.reserve(args.size());
+    for (size_t i = 0; i < args.size(); ++i)
+      values.push_back(to_value(args[i], texts[i]));
+
+    boop_call call;
+    boop_value result = make_value(BOOP_NIL);
+    if (function(&call, values.data(), values.size(), &result, userdata) !=
+        BOOP_OK)
+      return context.error(call.message.empty()
+                               ? "The host function " + get_name() +
+                                     " failed."
+                               : call.message);
+    std::optional<BoopObject> object = to_object(result);
+    if (!object.has_value())
+      return context.error("The host function " + get_name() +
+                           " returned a value scripts can't use.");
+    return std::move(object.value());
+  }
+};
+} // namespace
+
+extern "C" {
+
+boop_interpreter *boop_new(const boop_options *options) {
+  boop::EvaluatorOptions evaluator_options;
+  if (options != nullptr) {
+    if (options->max_call_depth != 0)
+      evaluator_options.max_call_depth = options->max_call_depth;
+    if (options->output_fd != 0)
+      evaluator_options.output.fd = options->output_fd;
+  }
+  try {
+    return new boop_interpreter(evaluator_options);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void boop_free(boop_interpreter *interpreter) { delete interpreter; }
+
+const char *boop_last_error(const boop_interpreter *interpreter) {
+  return interpreter->last_error.c_str();
+}
+
+boop_status boop_compile(boop_interpreter *interpreter, const char *source,
+                         size_t length, boop_program **program) {
+  if (source == nullptr || program == nullptr)
+    return fail(interpreter, "boop_compile: source and program are required.");
+  try {
+    boop::ProgramPtr compiled =
+        interpreter->isolate.compile(std::string_view(source, length));
+    if (compiled == nullptr)
+      return fail(interpreter, BOOP_COMPILE_ERROR);
+    *program = new boop_program{std::move(compiled)};
+    return BOOP_OK;
+  } catch (const std::exception &e) {
+    return fail(interpreter, e);
+  }
+}
+
+void boop_program_free(boop_program *program) { delete program; }
+
+boop_status boop_run(boop_interpreter *interpreter,
+                     const boop_program *program) {
+  if (program == nullptr)
+    return fail(interpreter, "boop_run: program is required.");
+  try {
+    if (!interpreter->isolate.run(program->program))
+      return fail(interpreter, BOOP_RUNTIME_ERROR);
+    return BOOP_OK;
+  } catch (const std::exception &e) {
+    return fail(interpreter, e);
+  }
+}
+
+boop_status boop_run_source(boop_interpreter *interpreter, const char *source,
+                            size_t length) {
+  boop_program *program = nullptr;
+  const boop_status status =
+      boop_compile(interpreter, source, length, &program);
+  if (status != BOOP_OK)
+    return status;
+  const std::unique_ptr<boop_program> owned{program};
+  return boop_run(interpreter, program);
+}
+
+boop_status boop_call_function(boop_interpreter *interpreter,
+                               const char *name, const boop_value *args,
+                               size_t count, boop_value *result) {
+  if (name == nullptr || (args == nullptr && count != 0))
+    return fail(interpreter,
+                "boop_call_function: name and arguments are required.");
+  try {
+    std::vector<BoopObject> objects;
+    objects.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      std::optional<BoopObject> object = to_object(args[i]);
+      if (!object.has_value())
+        return fail(interpreter, "boop_call_function: argument " +
+                                     std::to_string(i + 1) +
+                                     " can't be passed to a script.");
+      objects.push_back(std::move(object.value()));
+    }
+
+    std::optional<BoopObject> value = interpreter->isolate.call(
+        name, boop::ArgSpan(objects.data(), objects.size()));
+    if (!value.has_value())
+      return fail(interpreter, BOOP_RUNTIME_ERROR);
+    interpreter->result = std::move(value.value());
+    if (result != nullptr)
+      *result = to_value(interpreter->result, interpreter->result_text);
+    return BOOP_OK;
+  } catch (const std::exception &e) {
+    return fail(interpreter, e);
+  }
+}
+
+boop_status boop_define_function(boop_interpreter *interpreter,
+                                 const char *name, int arity,
+                                 boop_host_function function,
+                                 void *userdata) {
+  if (name == nullptr || function == nullptr)
+    return fail(interpreter,
+                "boop_define_function: name and function are required.");
+  try {
+    const size_t native_arity = arity < 0
+                                    ? boop::BuiltinFunction::VARIADIC
+                                    : static_cast<size_t>(arity);
+    interpreter->isolate.define_native(std::make_shared<HostFunction>(
+        name, native_arity, function, userdata));
+    return BOOP_OK;
+  } catch (const std::exception &e) {
+    return fail(interpreter, e);
+  }
+}
+
+void boop_call_error(boop_call *call, const char *message) {
+  call->message = message == nullptr ? "" : message;
+}
+
+boop_port *boop_port_new(size_t capacity) {
+  try {
+    return new boop_port{
+        std::make_shared<boop::BoopPort>(capacity == 0 ? 1 : capacity)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void boop_port_free(boop_port *port) { delete port; }
+
+boop_status boop_define_port(boop_interpreter *interpreter, const char *name,
+                             const boop_port *port) {
+  if (name == nullptr || port == nullptr)
+    return fail(interpreter, "boop_define_port: name and port are required.");
+  try {
+    interpreter->isolate.define_global(name, port->port);
+    return BOOP_OK;
+  } catch (const std::exception &e) {
+    return fail(interpreter, e);
+  }
+}
+
+} // extern "C"
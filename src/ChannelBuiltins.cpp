@@ -0,0 +1,171 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Fibers.h"
+#include "../include/Native.h"
+#include "../include/Ports.h"
+#include "../include/Streams.h"
+#include "../include/Types.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto channel_error(NativeContext &context, const std::string &name)
+    -> Status {
+  return context.error("Argument 1 of " + name +
+                       " must be a channel or a port.");
+}
+
+// the capacity argument of `channel` and `port`
+auto get_capacity(NativeContext &context, const std::string &name,
+                  const BoopObject &capacity) -> Result<size_t> {
+  const auto *count = std::get_if<int64_t>(&capacity);
+  if (EXPECT_FALSE(count == nullptr || *count < 1))
+    return context.error("The capacity of a " + name +
+                         " must be an integer of at least 1.");
+  return static_cast<size_t>(*count);
+}
+
+struct MakeChannel final : public BuiltinFunction {
+  MakeChannel() : BuiltinFunction("channel", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const size_t capacity,
+                     get_capacity(context, get_name(), args[0]));
+    return BoopObject(std::make_shared<BoopChannel>(capacity));
+  }
+};
+
+struct MakePort final : public BuiltinFunction {
+  MakePort() : BuiltinFunction("port", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const size_t capacity,
+                     get_capacity(context, get_name(), args[0]));
+    return BoopObject(std::make_shared<BoopPort>(capacity));
+  }
+};
+
+struct Send final : public BuiltinFunction {
+  Send() : BuiltinFunction("send", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (const auto *port = std::get_if<PortPtr>(&args[0])) {
+      RETURN_IF_ERROR((*port)->send(context.evaluator.fibers(),
+                                    context.error_handler, context.call_site,
+                                    args[1]));
+      return BoopObject(nullptr);
+    }
+    const auto *channel = std::get_if<ChannelPtr>(&args[0]);
+    if (EXPECT_FALSE(channel == nullptr))
+      return channel_error(context, get_name());
+    RETURN_IF_ERROR((*channel)->send(context.evaluator.fibers(),
+                                     context.error_handler, context.call_site,
+                                     args[1]));
+    return BoopObject(nullptr);
+  }
+};
+
+struct Recv final : public BuiltinFunction {
+  Recv() : BuiltinFunction("recv", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (const auto *port = std::get_if<PortPtr>(&args[0]))
+      return (*port)->recv(context.evaluator.fibers());
+    const auto *channel = std::get_if<ChannelPtr>(&args[0]);
+    if (EXPECT_FALSE(channel == nullptr))
+      return channel_error(context, get_name());
+    return (*channel)->recv(context.evaluator.fibers(), context.error_handler,
+                            context.call_site);
+  }
+};
+
+struct Close final : public BuiltinFunction {
+  Close() : BuiltinFunction("close", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (const auto *port = std::get_if<PortPtr>(&args[0])) {
+      (*port)->close();
+      return BoopObject(nullptr);
+    }
+    if (const auto *stream = std::get_if<StreamPtr>(&args[0])) {
+      (*stream)->close(context.evaluator.fibers());
+      return BoopObject(nullptr);
+    }
+    const auto *channel = std::get_if<ChannelPtr>(&args[0]);
+    if (EXPECT_FALSE(channel == nullptr))
+      return context.error("Argument 1 of close must be a channel, a port or "
+                           "a stream.");
+    (*channel)->close();
+    return BoopObject(nullptr);
+  }
+};
+
+struct Select final : public BuiltinFunction {
+  Select() : BuiltinFunction("select", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    const auto *list = std::get_if<BoopListPtr>(&args[0]);
+    std::vector<ChannelPtr> channels;
+    if (list != nullptr) {
+      channels.reserve((*list)->size());
+      for (const BoopObject &element : (*list)->elements) {
+        const auto *channel = std::get_if<ChannelPtr>(&element);
+        if (EXPECT_FALSE(channel == nullptr))
+          break;
+        channels.push_back(*channel);
+      }
+    }
+    if (EXPECT_FALSE(list == nullptr || channels.size() != (*list)->size()))
+      return context.error("Argument 1 of select must be a list of "
+                           "channels.");
+
+    size_t which = 0;
+    ASSIGN_OR_RETURN(BoopObject value,
+                     BoopChannel::select(context.evaluator.fibers(),
+                                         context.error_handler,
+                                         context.call_site, channels, which));
+    if (which == channels.size())
+      return BoopObject(nullptr);
+    auto pair = std::make_shared<BoopList>();
+    pair->elements = {BoopObject(channels[which]), std::move(value)};
+    return BoopObject(std::move(pair));
+  }
+};
+
+struct Yield final : public BuiltinFunction {
+  Yield() : BuiltinFunction("yield", 0) {}
+
+  auto call(NativeContext &context, ArgSpan /*args*/)
+      -> Result<BoopObject> override {
+    context.evaluator.fibers().yield();
+    return BoopObject(nullptr);
+  }
+};
+} // namespace
+
+auto define_channel_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<MakeChannel>());
+  evaluator.define_native(std::make_shared<MakePort>());
+  evaluator.define_native(std::make_shared<Send>());
+  evaluator.define_native(std::make_shared<Recv>());
+  evaluator.define_native(std::make_shared<Close>());
+  evaluator.define_native(std::make_shared<Select>());
+  evaluator.define_native(std::make_shared<Yield>());
+}
+
+} // namespace boop
@@ -1,124 +1,247 @@
-#include "../include/Environment.h"
-#include "../include/ErrorHandler.h"
-
-#include <map>
-#include <memory>
-#include <stdexcept>
-#include <string>
-
-
-#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
-#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
-
-namespace boop {
-
-namespace {
-class UndefinedVarAccess : public std::exception {};
-class UninitializedVarAccess : public std::exception {};
-} // namespace
-
-// Environment definitions
-Environment::Environment(EnvironmentPtr parent_env)
-    : m_parent_env(parent_env) {}
-
-auto Environment::assign(size_t hashed_var_name, BoopObject object) -> bool {
-  auto iter = objects.find(hashed_var_name);
-  if (iter != objects.end()) {
-    objects.insert_or_assign(hashed_var_name, object);
-    return true;
-  }
-  if (EXPECT_TRUE(m_parent_env != nullptr))
-    return m_parent_env->assign(hashed_var_name, std::move(object));
-
-  throw UndefinedVarAccess();
-}
-
-auto Environment::define(size_t hashed_var_name, BoopObject object) -> void {
-  m_objects.insert_or_assign(hashed_var_name, object);
-}
-
-auto Environment::get(size_t hashed_var_name) -> BoopObject {
-  auto iter = objects.find(hashedVarName);
-  if (EXPECT_TRUE(iter != objects.end())) {
-    if (EXPECT_FALSE(std::holds_alternative<std::nullptr_t>(iter->second)))
-      throw UninitializedVarAccess();
-    return iter->second;
-  }
-  if (EXPECT_TRUE(parentEnviron != nullptr))
-    return parentEnviron->get(hashedVarName);
-
-  throw UndefinedVarAccess(); // throws only in the global env
-}
-
-auto Environment::get_parent_env() -> EnvironmentPtr { return m_parent_env; }
-
-auto Environment::is_global() -> bool { return (m_parent_env == nullptr); }
-
-// EnvironmentManagement definitions
-EnvironmentManager::EnvironmentManager(ErrorHandler &reporter)
-    : m_error_handler(reporter),
-      m_current_env(std::make_shared<Environment>(nullptr)) {}
-
-auto EnvironmentManager::assign(const Token &variable, BoopObject object)
-    -> void {
-  try {
-    m_current_env->assign(hasher(variable.get_lexeme()), std::move(object));
-  } catch (const UndefinedVarAccess &e) {
-    throw report_runtime_error(m_error_handler, variable,
-                               "Can't assign to an undefined variable.");
-  }
-}
-
-auto EnvironmentManager::create_new_env(
-    const std::string &caller = __builtin_FUNCTION()) -> void {
-  m_current_env = std::make_shared<Environment>(m_current_env);
-}
-
-auto EnvironmentManager::discard_envs_till(
-    const Environment::EnvironmentPtr &env_to_restore,
-    const std::string &caller = __builtin_FUNCTION()) -> void {
-
-  while (EXPECT_TRUE(!m_current_env->is_global() &&
-                     m_current_env.get() != env_to_restore.get())) {
-    m_current_env = m_current_env->get_parent_env();
-  }
-}
-
-auto EnvironmentManager::define(const std::string &token_str, BoopObject object)
-    -> void {
-        m_current_env->define(hasher(token_str), std::move(object));
-}
-
-auto EnvironmentManager::define(const Token &var_token, BoopObject object)
-    -> void {
-        m_current_env->define(hasher(var_token.get_lexeme()), std::move(object));
-}
-
-auto EnvironmentManager::get(const Token &var_token) -> BoopObject{
-  try {
-    return m_current_env->get(hasher(var_token.get_lexeme()));
-  } catch (const UndefinedVarAccess &e) {
-    throw report_runtime_error(
-        eReporter, var_token, "Attempted to access an undefined variable.");
-  } catch (const UninitializedVarAccess &e) {
-    throw report_runtime_error(
-        eReporter, var_token, "Attempted to access an uninitialized variable.");
-  }
-}
-
-// auto EnvironmentManager::get(const std::string &var_token) -> BoopObject {
-    
-// }
-
-auto EnvironmentManager::get_current_env() -> Environment::EnvironmentPtr{
-    return m_current_env;
-}
-
-auto EnvironmentManager::set_current_env(
-    Environment::EnvironmentPtr new_current,
-    const std::string &callee = __builtin_FUNCTION()) -> void{
-
-    m_current_env = std::move(next_current);
-}
-
-} // namespace boop
\ No newline at end of file
+#include "../include/Environment.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Sharing.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+// EnvironmentManagement definitions
+EnvironmentManager::EnvironmentManager(ErrorHandler &reporter)
+    : m_error_handler(reporter) {
+  m_stack.reserve(MAX_STACK_SLOTS);
+}
+
+auto EnvironmentManager::stack_top() const noexcept -> size_t {
+  return m_stack.size();
+}
+
+auto EnvironmentManager::push_value(BoopObject value) -> Status {
+  if (EXPECT_FALSE(m_stack.size() == m_max_slots))
+    return Status::STACK_OVERFLOW;
+  m_stack.push_back(std::move(value));
+  return Status::OK;
+}
+
+auto EnvironmentManager::truncate_stack(size_t top) -> void {
+  m_stack.erase(m_stack.begin() + static_cast<std::ptrdiff_t>(top),
+                m_stack.end());
+}
+
+auto EnvironmentManager::stack_at(size_t index) noexcept
+    -> const BoopObject * {
+  return m_stack.data() + index;
+}
+
+auto EnvironmentManager::push_frame(size_t base, size_t frame_size,
+                                    const std::vector<UpvaluePtr> *upvalues,
+                                    Frame &caller) -> Status {
+  if (EXPECT_FALSE(base + frame_size > m_max_slots))
+    return Status::STACK_OVERFLOW;
+  m_stack.resize(base + frame_size, BoopObject(nullptr));
+
+  caller = m_frame;
+  m_frame.slots = m_stack.data() + base;
+  m_frame.upvalues = upvalues;
+  m_frame.base = base;
+  return Status::OK;
+}
+
+auto EnvironmentManager::pop_frame(Frame caller) -> void {
+  close_upvalues(m_frame.base);
+  truncate_stack(m_frame.base);
+  m_frame = caller;
+}
+
+auto EnvironmentManager::pop_frame_keeping(Frame caller, size_t keep_begin)
+    -> void {
+  close_upvalues(m_frame.base);
+  auto kept = m_stack.begin() + static_cast<std::ptrdiff_t>(keep_begin);
+  auto moved_end = std::move(kept, m_stack.end(),
+                             m_stack.begin() +
+                                 static_cast<std::ptrdiff_t>(m_frame.base));
+  m_stack.erase(moved_end, m_stack.end());
+  m_frame = caller;
+}
+
+auto EnvironmentManager::get_frame() const noexcept -> Frame {
+  return m_frame;
+}
+
+auto EnvironmentManager::swap_stack(Stack &stack) noexcept -> void {
+  m_stack.swap(stack.values);
+  m_open_upvalues.swap(stack.open_upvalues);
+  std::swap(m_frame, stack.frame);
+  std::swap(m_max_slots, stack.max_slots);
+}
+
+auto EnvironmentManager::unwind(Frame frame, size_t top) -> void {
+  close_upvalues(top);
+  if (m_stack.size() > top)
+    truncate_stack(top);
+  m_frame = frame;
+}
+
+auto EnvironmentManager::capture(
+    const std::vector<AST::UpvalueDescriptor> &descriptors)
+    -> std::vector<UpvaluePtr> {
+  std::vector<UpvaluePtr> upvalues;
+  upvalues.reserve(descriptors.size());
+  for (const AST::UpvalueDescriptor &descriptor : descriptors) {
+    if (!descriptor.is_local) {
+      upvalues.push_back((*m_frame.upvalues)[descriptor.index]);
+      continue;
+    }
+    const size_t stack_index = m_frame.base + descriptor.index;
+    // closures capturing the same variable must share its upvalue
+    auto iter = std::lower_bound(
+        m_open_upvalues.begin(), m_open_upvalues.end(), stack_index,
+        [](const UpvaluePtr &upvalue, size_t index) {
+          return upvalue->stack_index < index;
+        });
+    if (iter == m_open_upvalues.end() || (*iter)->stack_index != stack_index)
+      iter = m_open_upvalues.insert(
+          iter, std::make_shared<Upvalue>(&m_stack[stack_index], stack_index));
+    upvalues.push_back(*iter);
+  }
+  return upvalues;
+}
+
+auto EnvironmentManager::close_upvalues(size_t stack_index) -> void {
+  while (!m_open_upvalues.empty() &&
+         m_open_upvalues.back()->stack_index >= stack_index) {
+    m_open_upvalues.back()->close();
+    m_open_upvalues.pop_back();
+  }
+}
+
+auto EnvironmentManager::close_slots(size_t begin, size_t end) -> void {
+  close_upvalues(m_frame.base + begin);
+  for (size_t slot = begin; slot < end; ++slot)
+    m_frame.slots[slot] = nullptr;
+}
+
+auto EnvironmentManager::slot_at(const AST::ResolvedSlot &resolved)
+    -> BoopObject & {
+  if (EXPECT_TRUE(resolved.kind == AST::ResolvedSlot::Kind::LOCAL))
+    return m_frame.slots[resolved.index];
+  return *(*m_frame.upvalues)[resolved.index]->location;
+}
+
+auto EnvironmentManager::assign(const Token &variable,
+                                const AST::ResolvedSlot &resolved,
+                                BoopObject object) -> Status {
+  if (EXPECT_TRUE(!resolved.is_global())) {
+    slot_at(resolved) = std::move(object);
+    return Status::OK;
+  }
+  auto iter = m_globals.find(m_hasher(variable.get_lexeme()));
+  if (EXPECT_FALSE(iter == m_globals.end())) {
+    if (find_shared_global(variable) != nullptr)
+      return report_runtime_error(
+          m_error_handler, variable,
+          "A task can't assign to the globals of the script spawning it.");
+    return report_runtime_error(m_error_handler, variable,
+                                "Can't assign to an undefined variable.");
+  }
+  iter->second = std::move(object);
+  m_globals_snapshot = nullptr;
+  return Status::OK;
+}
+
+auto EnvironmentManager::define(const Token &var_token,
+                                const AST::ResolvedSlot &resolved,
+                                BoopObject object) -> void {
+  if (EXPECT_TRUE(!resolved.is_global()))
+    slot_at(resolved) = std::move(object);
+  else
+    define_global(var_token.get_lexeme(), std::move(object));
+}
+
+auto EnvironmentManager::define_global(const std::string &token_str,
+                                       BoopObject object) -> void {
+  m_globals.insert_or_assign(m_hasher(token_str), std::move(object));
+  m_globals_snapshot = nullptr;
+}
+
+auto EnvironmentManager::find_global(const std::string &name) const
+    -> const BoopObject * {
+  auto iter = m_globals.find(m_hasher(name));
+  return iter == m_globals.end() ? nullptr : &iter->second;
+}
+
+auto EnvironmentManager::share_globals() -> SharedGlobalsPtr {
+  // a task hands on what it was given; its own globals are just builtins
+  if (m_shared_globals != nullptr)
+    return m_shared_globals;
+  if (m_globals_snapshot == nullptr) {
+    auto snapshot = std::make_shared<GlobalTable>();
+    snapshot->reserve(m_globals.size());
+    for (const auto &[hash, value] : m_globals) {
+      if (std::holds_alternative<BuiltinFunctionPtr>(value))
+        continue;
+      // only the tasks' threads read the snapshot; ropes must be flat first
+      if (const auto *str = std::get_if<BoopString>(&value))
+        str->str();
+      snapshot->emplace(hash, value);
+    }
+    m_globals_snapshot = std::move(snapshot);
+  }
+  return m_globals_snapshot;
+}
+
+auto EnvironmentManager::set_shared_globals(SharedGlobalsPtr globals)
+    -> SharedGlobalsPtr {
+  std::swap(m_shared_globals, globals);
+  return globals;
+}
+
+auto EnvironmentManager::find_shared_global(const Token &var_token)
+    -> const BoopObject * {
+  if (m_shared_globals == nullptr)
+    return nullptr;
+  auto iter = m_shared_globals->find(m_hasher(var_token.get_lexeme()));
+  return iter == m_shared_globals->end() ? nullptr : &iter->second;
+}
+
+auto EnvironmentManager::get(const Token &var_token,
+                             const AST::ResolvedSlot &resolved)
+    -> Result<BoopObject> {
+  const BoopObject *value = nullptr;
+  if (EXPECT_TRUE(!resolved.is_global())) {
+    value = &slot_at(resolved);
+  } else {
+    auto iter = m_globals.find(m_hasher(var_token.get_lexeme()));
+    if (EXPECT_TRUE(iter != m_globals.end())) {
+      value = &iter->second;
+    } else {
+      value = find_shared_global(var_token);
+      if (EXPECT_FALSE(value == nullptr))
+        return report_runtime_error(
+            m_error_handler, var_token,
+            "Attempted to access an undefined variable.");
+      // the spawning script may still be changing anything else
+      if (EXPECT_FALSE(!is_shareable(*value)))
+        return report_runtime_error(
+            m_error_handler, var_token,
+            "A task can only read globals that can't change: freeze() "
+            "containers and instances before spawning.");
+    }
+  }
+  if (EXPECT_FALSE(std::holds_alternative<std::nullptr_t>(*value)))
+    return report_runtime_error(
+        m_error_handler, var_token,
+        "Attempted to access an uninitialized variable.");
+  return *value;
+}
+
+} // namespace boop
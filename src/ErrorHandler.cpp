@@ -1,29 +1,51 @@
-#include "ErrorHandler.h"
-#include "Token.h"
-#include "Types.h"
-
-#include <iostream>
-#include <string>
-
-namespace boop {
-
-auto ErrorHandler::report() const -> void {
-  for (const auto& error : error_list) {
-    std::cerr << error << '\n';
-  }
-}
-
-auto ErrorHandler::add(int line, const std::string &msg) -> void {
-  error_list.emplace_back("[Line " + std::to_string(line) + "] Error: " + msg);
-  has_found_error = true;
-}
-
-auto ErrorHandler::clear() -> void { error_list.clear(); }
-
-auto report_runtime_error(ErrorHandler &reporter, const Token &token,
-                          const std::string &msg) -> RuntimeError {
-  reporter.add(token.get_line(), token.get_lexeme() + ": " + msg);
-  return RuntimeError();
-}
-
+#include "ErrorHandler.h"
+#include "Token.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+namespace boop {
+
+auto ErrorHandler::report() const -> void {
+  for (const auto& error : error_list) {
+    std::cerr << error << '\n';
+  }
+}
+
+auto ErrorHandler::add(int line, const std::string &msg) -> void {
+  error_list.emplace_back("[Line " + std::to_string(line) + "] Error: " + msg);
+  has_found_error = true;
+}
+
+auto ErrorHandler::clear() -> void {
+  error_list.clear();
+  has_found_error = false;
+}
+
+auto ErrorHandler::get_errors() const noexcept
+    -> const std::vector<std::string> & {
+  return error_list;
+}
+
+auto ErrorHandler::take_errors(size_t count) -> std::vector<std::string> {
+  std::vector<std::string> taken;
+  if (count < error_list.size()) {
+    taken.assign(std::make_move_iterator(error_list.begin() +
+                                         static_cast<std::ptrdiff_t>(count)),
+                 std::make_move_iterator(error_list.end()));
+    error_list.resize(count);
+  }
+  has_found_error = !error_list.empty();
+  return taken;
+}
+
+auto report_runtime_error(ErrorHandler &reporter, const Token &token,
+                          const std::string &msg) -> Status {
+  reporter.add(token.get_line(), token.get_lexeme() + ": " + msg);
+  return Status::RUNTIME_ERROR;
+}
+
 } // namespace boop
\ No newline at end of file
@@ -1,629 +1,1708 @@
-#include "../include/Evaluator.h"
-#include "../include/ErrorHandler.h"
-#include "../include/Types.h"
-
-#include <chrono>
-
-#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
-#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
-
-namespace boop {
-
-// throws RuntimeError is not double
-auto Evaluator::get_double(const Token &token, const BoopObject &right)
-    -> double {
-  if (EXPECT_FALSE(!std::holds_alternative<double>(right)))
-    throw report_runtime_error(
-        m_error_handler, token,
-        "Attempted to perform arithmetic operation on non-numeric literal " +
-            get_object_string(right));
-  return std::get<double>(right);
-}
-
-auto Evaluator::bind_instance(const FunctionPtr &method,
-                              BoopInstancePtr instance) -> FunctionPtr {
-  auto env_to_restore = m_env_manager.get_current_env();
-  // Set the current environment to the function's closure,
-  m_env_manager.set_current_env(method->get_closure());
-  // Create a new environment and define 'this' to point to the instance
-  m_env_manager.create_new_env();
-  auto method_closure = m_env_manager.get_current_env();
-  m_env_manager.define("this", instance);
-  // restore the environ.
-  m_env_manager.set_current_env(env_to_restore);
-  // create and return a new Functor that uses this new environ as its closure.
-  return std::make_shared<Functor>(
-      method->get_declaration(), method->get_name(), method_closure,
-      method->is_method(), method->is_initializer());
-}
-
-// definitions of Evaluator methods
-Evaluator::Evaluator(ErrorReporter &error_handler)
-    : m_error_handler(error_handler), m_env_manager(error_handler) {
-  m_env_manager.define(
-      Token(TokenType::FUN, "clock"),
-      static_cast<BuiltinFunctionPtr>(
-          std::make_shared<ClockBuiltin>(m_env_manager.get_current_env())));
-}
-
-auto Evaluator::evaluate_binary_expr(const AST::ExprBinaryPtr &expr)
-    -> BoopObject {
-  auto left = evaluate_expr(expr->left);
-  auto right = evaluate_expr(expr->right);
-  switch (expr->op.get_type()) {
-  case TokenType::COMMA:
-    return right;
-  case TokenType::BANG_EQUAL:
-    return !are_equals(left, right);
-  case TokenType::EQUAL_EQUAL:
-    return are_equals(left, right);
-  case TokenType::MINUS:
-    return get_double(expr->op, left) - get_double(expr->op, right);
-  case TokenType::SLASH: {
-    double denominator = get_double(expr->op, right);
-    if (EXPECT_FALSE(denominator == 0.0))
-      throw report_runtime_error(m_error_handler, expr->op,
-                                 "Division by zero is illegal");
-    return get_double(expr->op, left) / denominator;
-  }
-  case TokenType::STAR:
-    return get_double(expr->op, left) * get_double(expr->op, right);
-  case TokenType::LESS:
-    return get_double(expr->op, left) < get_double(expr->op, right);
-  case TokenType::LESS_EQUAL:
-    return get_double(expr->op, left) <= get_double(expr->op, right);
-  case TokenType::GREATER:
-    return get_double(expr->op, left) > get_double(expr->op, right);
-  case TokenType::GREATER_EQUAL:
-    return get_double(expr->op, left) >= get_double(expr->op, right);
-  case TokenType::PLUS: {
-    if (std::holds_alternative<double>(left) &&
-        std::holds_alternative<double>(right)) {
-      return std::get<double>(left) + std::get<double>(right);
-    }
-    if (std::holds_alternative<std::string>(left) ||
-        std::holds_alternative<std::string>(right)) {
-      return get_object_string(left) + get_object_string(right);
-    }
-    throw report_runtime_error(
-        m_error_handler, expr->op,
-        "Operands to 'plus' must be numbers or strings; This is invalid: " +
-            get_object_string(left) + " + " + get_object_string(right));
-  }
-  default:
-    throw report_runtime_error(
-        m_error_handler, expr->op,
-        "Attempted to apply invalid operator to binary expr: " +
-            expr->op.get_type_string());
-  }
-}
-
-auto Evaluator::evaluate_grouping_expr(const AST::ExprGroupingPtr &expr)
-    -> BoopObject {
-  return evaluate_expr(expr->expression);
-}
-
-namespace {
-auto boop_object_from_string_literal(const Literal &str_literal) -> BoopObject {
-  const auto &str = std::get<std::string>(str_literal);
-  if (str == "true")
-    return BoopObject(true);
-  if (str == "false")
-    return BoopObject(false);
-  if (str == "nil")
-    return BoopObject(nullptr);
-  return BoopObject(str);
-};
-} // namespace
-
-auto Evaluator::evaluate_literal_expr(const AST::ExprLiteralPtr &expr)
-    -> BoopObject {
-  return expr->literalVal.has_value()
-             ? std::holds_alternative<std::string>(expr->literalVal.value())
-                   ? boop_object_from_string_literal(expr->literalVal.value())
-                   : BoopObject(std::get<double>(expr->literalVal.value()))
-             : BoopObject(nullptr);
-}
-
-auto Evaluator::evaluate_unary_expr(const AST::ExprUnaryPtr &expr)
-    -> BoopObject {
-  BoopObject right = evaluate_expr(expr->right);
-  switch (expr->op.get_type()) {
-  case TokenType::BANG:
-    return !is_true(right);
-  case TokenType::MINUS:
-    return -get_double(expr->op, right);
-  case TokenType::PLUS_PLUS:
-    return get_double(expr->op, right) + 1;
-  case TokenType::MINUS_MINUS:
-    return get_double(expr->op, right) - 1;
-  default:
-    throw report_runtime_error(
-        m_error_handler, expr->op,
-        "Illegal unary expression: " + expr->op.get_lexeme() +
-            get_object_string(right));
-  }
-}
-
-auto Evaluator::evaluate_conditional_expr(const AST::ExprConditionalPtr &expr)
-    -> BoopObject {
-  if (is_true(evaluate_expr(expr->condition)))
-    return evaluate_expr(expr->then_branch);
-  return evaluate_expr(expr->else_branch);
-}
-
-auto Evaluator::evaluate_variable_expr(const AST::ExprVariablePtr &expr)
-    -> BoopObject {
-  return m_env_manager.get(expr->var_name);
-}
-
-auto Evaluator::evaluate_assignment_expr(const AST::ExprAssignmentPtr &expr)
-    -> BoopObject {
-  m_env_manager.assign(expr->var_name, evaluate_expr(expr->right));
-  return m_env_manager.get(expr->var_name);
-}
-
-namespace {
-auto match(const Token &token, TokenType tType) -> bool {
-  return token.get_type() == tType;
-}
-
-auto apply_post_fix_op(const Token &op, const BoopObject &val) -> BoopObject {
-  if (EXPECT_TRUE(std::holds_alternative<double>(val))) {
-    double dVal = std::get<double>(val);
-    if (match(op, TokenType::PLUS_PLUS))
-      return BoopObject(++dVal);
-    if (match(op, TokenType::MINUS_MINUS))
-      return BoopObject(--dVal);
-  }
-  throw RuntimeError();
-}
-} // namespace
-
-auto Evaluator::evaluate_postfix_expr(const AST::ExprPostfixPtr &expr)
-    -> BoopObject {
-  BoopObject lhs = evaluate_expr(expr->left);
-  if (EXPECT_TRUE(std::holds_alternative<AST::ExprVariablePtr>(expr->left))) {
-    m_env_manager.assign((std::get<AST::ExprVariablePtr>(expr->left))->varName,
-                         apply_post_fix_op(expr->op, lhs));
-  }
-  return lhs;
-}
-
-auto Evaluator::evaluate_logical_expr(const AST::ExprLogicalPtr &expr)
-    -> BoopObject {
-  BoopObject lhs = evaluate_expr(expr->left);
-  if (expr->op.get_type() == TokenType::OR)
-    return is_true(lhs) ? lhs : evaluate_expr(expr->right);
-  if (expr->op.get_type() == TokenType::AND)
-    return !is_true(lhs) ? lhs : evaluate_expr(expr->right);
-
-  throw report_runtime_error(m_error_handler, expr->op,
-                             "Illegal logical operator: " +
-                                 expr->op.get_lexeme());
-}
-
-auto Evaluator::evaluate_call_expr(const AST::ExprCallPtr &expr) -> BoopObject {
-  BoopObject callee = evaluate_expr(expr->callee);
-  if (EXPECT_FALSE(std::holds_alternative<BuiltinFunctionPtr>(callee))) {
-    return std::get<BuiltinFunctionPtr>(callee)->run();
-  }
-
-  BoopObject nullable_instance = ([&]() -> BoopObject {
-    if (EXPECT_FALSE(std::holds_alternative<BoopClassPtr>(callee)))
-      return BoopObject(
-          std::make_shared<BoopInstance>(std::get<BoopClassPtr>(callee)));
-    return BoopObject(nullptr);
-  })();
-
-  const FunctionPtr fun_obj = ([&]() -> FunctionPtr {
-    if (std::holds_alternative<BoopClassPtr>(callee)) {
-      auto instance = std::get<BoopInstancePtr>(nullable_instance);
-      try {
-        return bind_instance(std::get<FunctionPtr>(instance->get("init")),
-                             instance);
-      } catch (const RuntimeError &e) {
-        return nullptr;
-      }
-    }
-
-    if (EXPECT_TRUE(std::holds_alternative<FunctionPtr>(callee)))
-      return std::get<FunctionPtr>(callee);
-
-    throw report_runtime_error(m_error_handler, expr->paren,
-                               "Attempted to invoke a non-function");
-  })();
-
-  if (fun_obj.get() == nullptr) {
-    // exit early if there is no initializer
-    return nullable_instance;
-  }
-
-  // Throw error if arity doesn't match the number of arguments supplied
-  size_t arity = fun_obj->arity();
-  size_t arg_size = expr->arguments.size();
-
-  if (EXPECT_FALSE(arity != arg_size)) {
-    throw report_runtime_error(m_error_handler, expr->paren,
-                               "Expected " + std::to_string(arity) +
-                                   " arguments. Got " +
-                                   std::to_string(arg_size) + " arguments. ");
-  }
-
-  // Evaluate Arguments before switching to the next context as the arguments
-  // may rely on values in this context
-  std::vector<BoopObject> evaluated_args;
-  for (const auto &arg : expr->arguments) {
-    evaluated_args.push_back(evaluate_expr(arg));
-  }
-
-  // Save caller's environment so we can restore it later
-  auto environToRestore = m_env_manager.get_current_env();
-  // Set the m_current_env to the function's closure,
-  m_env_manager.set_current_env(fun_obj->get_closure());
-  // Create a new env for the function so it won't get cluttered with the
-  // closure.
-  m_env_manager.create_new_env();
-
-  { // Define each parameter with evaluated argument
-    const auto &params = fun_obj->get_params();
-    auto param = params.begin();
-    auto arg = evaluated_args.begin();
-    for (; param != params.end() && arg != evaluated_args.end();
-         ++param, ++arg) {
-      m_env_manager.define(*param, *arg);
-    }
-  }
-
-  // Evaluate the function
-  std::optional<BoopObject> fnRet = evaluate_stmts(fun_obj->get_body_stmt());
-
-  // Teardown any environments created by the function.
-  if (!fun_obj->is_method())
-    m_env_manager.discard_envs_till(fun_obj->get_closure());
-  else
-    m_env_manager.discard_envs_till(fun_obj->get_closure()->getParentEnv());
-  // Restore caller's environment.
-  m_env_manager.set_current_env(environToRestore);
-
-  // return result or BoopObject(nullptr);
-  if (fnRet.has_value()) {
-    if (EXPECT_FALSE(fun_obj->is_initializer()))
-      throw report_runtime_error(
-          m_error_handler, expr->paren,
-          "Initializer can't return a value other than 'this'");
-    return fnRet.value();
-  }
-  return nullable_instance;
-}
-
-auto Evaluator::evaluate_function_expr(const AST::ExprFunctionPtr &expr)
-    -> BoopObject {
-  // The current Environment becomes the closure for the function.
-  auto closure = m_env_manager.get_current_env();
-  // We also create a new environment because we don't want any redefinitions of
-  // variables that are later in the program lexical order to be visible to this
-  // function (in case it's stored and passed around). This environment creation
-  // isn't paired with a destruction in this function. The environment will be
-  // discarded when exiting wrapping scope this function is defined in (and the
-  // Functor goes out of scope.)
-  m_env_manager.create_new_env();
-  return std::make_shared<Functor>(expr, "BoopAnonFuncDoNotUseThisNameAADWAED",
-                                   std::move(closure));
-}
-
-auto Evaluator::evaluate_get_expr(const AST::ExprGetPtr &expr) -> BoopObject {
-  BoopObject inst_obj = evaluate_expr(expr->expr);
-  if (EXPECT_FALSE(!std::holds_alternative<BoopInstancePtr>(inst_obj))) {
-    throw report_runtime_error(m_error_handler, expr->name,
-                               "Only instances have properties");
-  }
-  try {
-    BoopObject property =
-        std::get<BoopInstancePtr>(inst_obj)->get(expr->name.get_lexeme());
-    if (std::holds_alternative<FunctionPtr>(property)) {
-      // if it's a method that we just looked up, then we need to create a
-      // binding for 'this'
-      property = BoopObject(bind_instance(std::get<FunctionPtr>(property),
-                                          std::get<BoopInstancePtr>(inst_obj)));
-    }
-    return property;
-  } catch (const RuntimeError &e) {
-    throw report_runtime_error(
-        m_error_handler, expr->name,
-        "Attempted to access undefined property: " + expr->name.get_lexeme() +
-            " on " + std::get<BoopInstancePtr>(inst_obj)->toString());
-  }
-}
-
-auto Evaluator::evaluate_set_expr(const AST::AST::ExprSetPtr &expr)
-    -> BoopObject {
-  BoopObject object = evaluate_expr(expr->expr);
-  if (EXPECT_FALSE(!std::holds_alternative<BoopInstancePtr>(object)))
-    throw report_runtime_error(m_error_handler, expr->name,
-                               "Only instances have fields.");
-  BoopObject value = evaluate_expr(expr->value);
-  std::get<BoopInstancePtr>(object)->set(expr->name.get_lexeme(), value);
-  return value;
-}
-
-auto Evaluator::evaluate_this_expr(const AST::ExprThisPtr &expr) -> BoopObject {
-  return m_env_manager.get(expr->keyword);
-}
-
-auto Evaluator::evaluate_super_expr(const AST::ExprSuperPtr &expr)
-    -> BoopObject {
-  BoopClassPtr super_class =
-      std::get<BoopClassPtr>(m_env_manager.get(expr->keyword));
-  auto optionalMethod = super_class->findMethod(expr->method.get_lexeme());
-  if (!optionalMethod.has_value())
-    throw report_runtime_error(m_error_handler, expr->keyword,
-                               "Attempted to access undefined property " +
-                                   expr->keyword.get_lexeme() + " on super.");
-
-  return bind_instance(std::get<FunctionPtr>(optionalMethod.value()),
-                       std::get<BoopInstancePtr>(
-                           m_env_manager.get(Token(TokenType::THIS, "this"))));
-}
-
-auto Evaluator::evaluate_expr(const ExprPtrVariant &expr) -> BoopObject {
-  switch (expr.index()) {
-  case 0: // AST::ExprBinaryPtr
-    return evaluate_binary_expr(std::get<0>(expr));
-  case 1: // AST::ExprGroupingPtr
-    return evaluate_grouping_expr(std::get<1>(expr));
-  case 2: // AST::ExprLiteralPtr
-    return evaluate_literal_expr(std::get<2>(expr));
-  case 3: // AST::ExprUnaryPtr
-    return evaluate_unary_expr(std::get<3>(expr));
-  case 4: // AST::ExprConditionalPtr
-    return evaluate_conditional_expr(std::get<4>(expr));
-  case 5: // AST::ExprPostfixPtr
-    return evaluate_postfix_expr(std::get<5>(expr));
-  case 6: // AST::ExprVariablePtr
-    return evaluate_variable_expr(std::get<6>(expr));
-  case 7: // AST::ExprAssignmentPtr
-    return evaluate_assignment_expr(std::get<7>(expr));
-  case 8: // AST::ExprLogicalPtr
-    return evaluate_logical_expr(std::get<8>(expr));
-  case 9: // AST::ExprCallPtr
-    return evaluate_call_expr(std::get<9>(expr));
-  case 10: // AST::ExprFunctionPtr
-    return evaluate_function_expr(std::get<10>(expr));
-  case 11: // AST::ExprGetPtr
-    return evaluate_get_expr(std::get<11>(expr));
-  case 12: // AST::ExprSetPtr
-    return evaluate_set_expr(std::get<12>(expr));
-  case 13: // AST::ExprThisPtr
-    return evaluate_this_expr(std::get<13>(expr));
-  case 14: // AST::ExprSuperPtr
-    return evaluate_super_expr(std::get<14>(expr));
-  default:
-    static_assert(std::variant_size_v<ExprPtrVariant> == 15,
-                  "Looks like you forgot to update the cases in "
-                  "Evaluator::Evaluate(const ExptrVariant&)!");
-    return "";
-  }
-}
-
-//==============================//
-// Statement Evaluation Methods //
-//==============================//
-auto Evaluator::evaluate_expr_stmt(const AST::ExprStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  BoopObject result = evaluate_expr(stmt->expression);
-
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_print_stmt(const AST::PrintStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  BoopObject obj_to_print = evaluate_expr(stmt->expression);
-  std::cout << "> " << get_object_string(obj_to_print) << '\n';
-
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_block_stmt(const AST::BlockStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-
-  auto current_env = m_env_manager.get_current_env();
-  m_env_manager.create_new_env();
-  
-  std::optional<BoopObject> result = evaluate_stmts(stmt->statements);
-  
-  m_env_manager.discard_envs_till(current_env);
-  return result;
-}
-
-auto Evaluator::evaluate_var_stmt(const AST::VarStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  if (stmt->initializer.has_value()) {
-    m_env_manager.define(stmt->varName,
-                         evaluate_expr(stmt->initializer.value()));
-  } else {
-    m_env_manager.define(stmt->varName, BoopObject(nullptr));
-  }
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_if_stmt(const AST::IfStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  if (is_true(evaluate_expr(stmt->condition)))
-    return evaluate_stmt(stmt->then_branch);
-  if (stmt->else_branch.has_value())
-    return evaluate_stmt(stmt->else_branch.value());
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_while_stmt(const AST::WhileStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  std::optional<BoopObject> result = std::nullopt;
-  while (is_true(evaluate_expr(stmt->condition)) && !result.has_value()) {
-    result = evaluate_stmt(stmt->loop_body);
-  }
-  return result;
-}
-
-auto Evaluator::evaluate_for_stmt(const AST::ForStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  std::optional<BoopObject> result = std::nullopt;
-  if (stmt->initializer.has_value())
-    evaluate_stmt(stmt->initializer.value());
-  while (true) {
-    if (stmt->condition.has_value() &&
-        !is_true(evaluate_expr(stmt->condition.value())))
-      break;
-    result = evaluate_stmt(stmt->loop_body);
-    if (result.has_value())
-      break;
-    if (stmt->increment.has_value())
-      evaluate_expr(stmt->increment.value());
-  }
-  return result;
-}
-
-auto Evaluator::evaluate_function_stmt(const AST::FuncStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  // The current Environment becomes the closure for the function.
-  std::shared_ptr<Environment> closure = m_env_manager.get_current_env();
-  // Create a Functor for the function, and hand it off to environment to store
-  m_env_manager.define(stmt->function_name,
-                       std::make_shared<Functor>(stmt->funcExpr,
-                                                 stmt->function_name.get_lexeme(),
-                                                 std::move(closure)));
-  // We also create a new environment because we don't want any redefinitions of
-  // variables that are later in the program lexical order to be visible to this
-  // function (in case it's stored and passed around). This environment creation
-  // isn't paired with a destruction in this function. The environment will be
-  // discarded when exiting wrapping scope this function is defined in (and the
-  // Functor goes out of scope.)
-  m_env_manager.create_new_env();
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_return_stmt(const AST::RetStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  return stmt->value.has_value()
-             ? std::make_optional(evaluate_expr(stmt->value.value()))
-             : std::nullopt;
-}
-
-auto Evaluator::evaluate_class_stmt(const AST::ClassStmtPtr &stmt)
-    -> std::optional<BoopObject> {
-  // Determine if this class has a super class or not;
-  auto superClass = [&]() -> std::optional<BoopClassPtr> {
-    if (stmt->superClass.has_value()) {
-      auto superclass_obj = evaluate_expr(stmt->superClass.value());
-      if (!std::holds_alternative<BoopClassPtr>(superclass_obj))
-        throw report_runtime_error(
-            m_error_handler, stmt->class_name,
-            "Superclass must be a class; Can't inherit from non-class");
-      return std::get<BoopClassPtr>(superclass_obj);
-    }
-    return std::nullopt;
-  }();
-
-  // Define the class name in the current environment
-  m_env_manager.define(stmt->class_name, BoopObject(nullptr));
-
-  // If there is a super class, create a new environ and define 'super' there
-  if (superClass.has_value()) {
-    m_env_manager.create_new_env();
-    m_env_manager.define("super", superClass.value());
-  }
-
-  std::vector<std::pair<std::string, BoopObject>> methods;
-  std::shared_ptr<Environment> closure = m_env_manager.get_current_env();
-  for (const auto &stmt : stmt->methods) {
-    const auto &functionStmt = std::get<AST::FuncStmtPtr>(stmt);
-    bool isInitializer = functionStmt->function_name.get_lexeme() == "init";
-    BoopObject method = std::make_shared<Functor>(
-        functionStmt->funcExpr, functionStmt->function_name.get_lexeme(), closure,
-        true, isInitializer);
-    methods.emplace_back(functionStmt->function_name.get_lexeme(), method);
-  }
-
-  // Discard the environment created for defining 'super'
-  if (superClass.has_value()) {
-    m_env_manager.set_current_env(
-        m_env_manager.get_current_env()->getParentEnv());
-  }
-
-  // Declare the class
-  m_env_manager.assign(stmt->class_name,
-                       std::make_shared<BoopClass>(stmt->class_name.get_lexeme(),
-                                                   superClass, methods));
-
-  // Create a new environment so changes that occur afterwards in lexical order
-  // aren't visible to the class defn.
-  m_env_manager.create_new_env();
-
-  return std::nullopt;
-}
-
-auto Evaluator::evaluate_stmt(const AST::StmtPtrVariant &stmt)
-    -> std::optional<BoopObject> {
-  switch (stmt.index()) {
-  case 0: // AST::ExprStmtPtr
-    return evaluate_expr_stmt(std::get<0>(stmt));
-  case 1: // AST::PrintStmtPtr
-    return evaluate_print_stmt(std::get<1>(stmt));
-  case 2: // AST::BlockStmtPtr
-    return evaluate_block_stmt(std::get<2>(stmt));
-  case 3: // AST::VarStmtPtr
-    return evaluate_var_stmt(std::get<3>(stmt));
-  case 4: // AST::IfStmtPtr
-    return evaluate_if_stmt(std::get<4>(stmt));
-  case 5: // AST::WhileStmtPtr
-    return evaluate_while_stmt(std::get<5>(stmt));
-  case 6: // AST::ForStmtPtr
-    return evaluate_for_stmt(std::get<6>(stmt));
-  case 7: // AST::FuncStmtPtr
-    return evaluate_function_stmt(std::get<7>(stmt));
-  case 8: // AST::RetStmtPtr
-    return evaluate_return_stmt(std::get<8>(stmt));
-  case 9: // AST::ClassStmtPtr
-    return evaluate_class_stmt(std::get<9>(stmt));
-  default:
-    static_assert(std::variant_size_v<StmtPtrVariant> == 10,
-                  "Looks like you forgot to update the cases in "
-                  "PrettyPrinter::toString(const StmtPtrVariant& statement)!");
-    return std::nullopt;
-  }
-}
-
-auto Evaluator::evaluate_stmts(const std::vector<AST::StmtPtrVariant> &stmts)
-    -> std::optional<BoopObject> {
-  std::optional<BoopObject> result = std::nullopt;
-  for (const AST::StmtPtrVariant &stmt : stmts) {
-    try {
-      result = evaluate_stmt(stmt);
-      if (result.has_value())
-        break;
-    } catch (const RuntimeError &e) {
-      if (EXPECT_FALSE(++numRunTimeErr > MAX_RUNTIME_ERR)) {
-        std::cerr << "Too many errors occurred. Exiting evaluation."
-                  << std::endl;
-        throw e;
-      }
-    }
-  }
-  return result;
-}
-
-class ClockBuiltin : public BuiltinFunction {
-public:
-  explicit ClockBuiltin(Environment::EnvironmentPtr closure)
-      : BuiltinFunction("clock", std::move(closure)) {}
-  auto arity() -> size_t override { return 0; }
-  auto run() -> BoopObject override {
-    return static_cast<double>(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::high_resolution_clock::now().time_since_epoch())
-            .count());
-  }
-  auto get_name() -> std::string override { return "< builtin-fn_clock >"; }
-};
-
+#include "../include/Evaluator.h"
+#include "../include/BoopMap.h"
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Fibers.h"
+#include "../include/Kernels.h"
+#include "../include/Native.h"
+#include "../include/Program.h"
+#include "../include/Sharing.h"
+#include "../include/Tasks.h"
+#include "../include/ThreadPool.h"
+#include "../include/Types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto is_number(const BoopObject &object) -> bool {
+  return std::holds_alternative<double>(object) ||
+         std::holds_alternative<int64_t>(object);
+}
+
+// callers make sure object holds a number
+auto as_double(const BoopObject &object) -> double {
+  if (const auto *integer = std::get_if<int64_t>(&object))
+    return static_cast<double>(*integer);
+  return std::get<double>(object);
+}
+
+auto is_array_operand(const BoopObject &object) -> bool {
+  return std::holds_alternative<Float64ArrayPtr>(object) || is_number(object);
+}
+
+auto is_arithmetic(TokenType type) -> bool {
+  return type == TokenType::PLUS || type == TokenType::MINUS ||
+         type == TokenType::STAR || type == TokenType::SLASH;
+}
+
+// strings are shared as is, anything else is converted to its printed form
+auto as_boop_string(const BoopObject &object) -> BoopString {
+  if (const auto *str = std::get_if<BoopString>(&object))
+    return *str;
+  return BoopString(get_object_string(object));
+}
+
+// int64 arithmetic; a result that overflows is promoted to double
+auto int_add(int64_t left, int64_t right) -> BoopObject {
+  int64_t result{};
+  if (EXPECT_FALSE(__builtin_add_overflow(left, right, &result)))
+    return static_cast<double>(left) + static_cast<double>(right);
+  return result;
+}
+
+auto int_sub(int64_t left, int64_t right) -> BoopObject {
+  int64_t result{};
+  if (EXPECT_FALSE(__builtin_sub_overflow(left, right, &result)))
+    return static_cast<double>(left) - static_cast<double>(right);
+  return result;
+}
+
+auto int_mul(int64_t left, int64_t right) -> BoopObject {
+  int64_t result{};
+  if (EXPECT_FALSE(__builtin_mul_overflow(left, right, &result)))
+    return static_cast<double>(left) * static_cast<double>(right);
+  return result;
+}
+
+// callers make sure both operands are numbers. Two integers stay integers,
+// anything mixed with a double is computed in double.
+auto apply_numeric_op(TokenType op, const BoopObject &left,
+                      const BoopObject &right) -> BoopObject {
+  const auto *lhs = std::get_if<int64_t>(&left);
+  const auto *rhs = std::get_if<int64_t>(&right);
+  if (lhs != nullptr && rhs != nullptr) {
+    switch (op) {
+    case TokenType::PLUS:
+      return int_add(*lhs, *rhs);
+    case TokenType::MINUS:
+      return int_sub(*lhs, *rhs);
+    case TokenType::STAR:
+      return int_mul(*lhs, *rhs);
+    case TokenType::LESS:
+      return *lhs < *rhs;
+    case TokenType::LESS_EQUAL:
+      return *lhs <= *rhs;
+    case TokenType::GREATER:
+      return *lhs > *rhs;
+    case TokenType::GREATER_EQUAL:
+      return *lhs >= *rhs;
+    default:
+      break;
+    }
+  }
+  // an integer against a double compares exactly; rounding the integer to a
+  // double would make 2^53 + 1 equal to 2^53
+  if ((lhs != nullptr || rhs != nullptr) && !is_arithmetic(op)) {
+    const int order = lhs != nullptr
+                          ? compare_int_double(*lhs, std::get<double>(right))
+                          : -compare_int_double(*rhs, std::get<double>(left));
+    switch (op) {
+    case TokenType::LESS:
+      return order == -1;
+    case TokenType::LESS_EQUAL:
+      return order == -1 || order == 0;
+    case TokenType::GREATER:
+      return order == 1;
+    case TokenType::GREATER_EQUAL:
+      return order == 1 || order == 0;
+    default:
+      return nullptr;
+    }
+  }
+
+  const double left_value = as_double(left);
+  const double right_value = as_double(right);
+  switch (op) {
+  case TokenType::PLUS:
+    return left_value + right_value;
+  case TokenType::MINUS:
+    return left_value - right_value;
+  case TokenType::STAR:
+    return left_value * right_value;
+  case TokenType::SLASH: // always true division
+    return left_value / right_value;
+  case TokenType::LESS:
+    return left_value < right_value;
+  case TokenType::LESS_EQUAL:
+    return left_value <= right_value;
+  case TokenType::GREATER:
+    return left_value > right_value;
+  case TokenType::GREATER_EQUAL:
+    return left_value >= right_value;
+  default:
+    return nullptr;
+  }
+}
+} // namespace
+
+auto Evaluator::check_number(const Token &token, const BoopObject &right)
+    -> Status {
+  if (EXPECT_FALSE(!is_number(right)))
+    return report_runtime_error(
+        m_error_handler, token,
+        "Attempted to perform arithmetic operation on non-numeric literal " +
+            get_object_string(right));
+  return Status::OK;
+}
+
+auto Evaluator::check_numbers(const Token &token, const BoopObject &left,
+                              const BoopObject &right) -> Status {
+  RETURN_IF_ERROR(check_number(token, left));
+  return check_number(token, right);
+}
+
+auto Evaluator::check_index(const Token &bracket, const BoopObject &index,
+                            size_t size, bool is_slice_bound)
+    -> Result<size_t> {
+  if (EXPECT_FALSE(!std::holds_alternative<int64_t>(index)))
+    return report_runtime_error(m_error_handler, bracket,
+                                "Indices must be integers.");
+  const int64_t requested = std::get<int64_t>(index);
+  const auto length = static_cast<int64_t>(size);
+  const int64_t position = requested < 0 ? requested + length : requested;
+  const int64_t last = is_slice_bound ? length : length - 1;
+  if (EXPECT_FALSE(position < 0 || position > last))
+    return report_runtime_error(m_error_handler, bracket,
+                                "Index " + std::to_string(requested) +
+                                    " is out of range for a length of " +
+                                    std::to_string(size) + ".");
+  return static_cast<size_t>(position);
+}
+
+auto Evaluator::check_map_key(const Token &token, const BoopObject &key)
+    -> Status {
+  if (EXPECT_FALSE(!BoopMap::is_valid_key(key)))
+    return report_runtime_error(
+        m_error_handler, token,
+        "Map keys must be strings, booleans or numbers other than NaN.");
+  return Status::OK;
+}
+
+auto Evaluator::bind_instance(const FunctionPtr &method,
+                              BoopInstancePtr instance) -> FunctionPtr {
+  // the receiver is placed in slot 0 of the method's frame on every call, so
+  // binding doesn't need an environment of its own
+  return std::make_shared<Functor>(
+      method->get_program(), method->get_declaration(), method->get_name(),
+      method->get_upvalues(),
+      method->is_method(), method->is_initializer(), std::move(instance));
+}
+
+namespace {
+// native stack reserved for evaluating a script on a dedicated stack, plus a
+// generous estimate of what each nested Boop call takes
+constexpr size_t NATIVE_STACK_BASE = 1 << 20;
+constexpr size_t NATIVE_STACK_PER_CALL = 8 * 1024;
+// deepest call a fiber can make on its (fixed size) native stack, keeping a
+// margin for the builtin running at the top
+constexpr size_t FIBER_MAX_CALL_DEPTH =
+    (FiberScheduler::STACK_BYTES - (256 << 10)) / NATIVE_STACK_PER_CALL;
+
+// counts a Boop call for as long as it is running
+struct CallDepthGuard {
+  size_t &depth;
+  explicit CallDepthGuard(size_t &call_depth) : depth(call_depth) { ++depth; }
+  CallDepthGuard(const CallDepthGuard &) = delete;
+  auto operator=(const CallDepthGuard &) -> CallDepthGuard & = delete;
+  ~CallDepthGuard() { --depth; }
+};
+
+// makes `program` the running one until the scope ends
+struct ProgramGuard {
+  const ProgramPtr *&current;
+  const ProgramPtr *const saved;
+  ProgramGuard(const ProgramPtr *&running, const ProgramPtr *program)
+      : current(running), saved(running) {
+    current = program;
+  }
+  ProgramGuard(const ProgramGuard &) = delete;
+  auto operator=(const ProgramGuard &) -> ProgramGuard & = delete;
+  ~ProgramGuard() { current = saved; }
+};
+
+// gives a task the globals of the script spawning it and an error limit of
+// its own, and drops whatever it leaves on the value stack if it's abandoned
+// by a throw; the enclosing task gets its state back when the scope ends
+struct TaskScope {
+  EnvironmentManager &env_manager;
+  int &err_count;
+  const EnvironmentManager::Frame frame;
+  const size_t stack_top;
+  EnvironmentManager::SharedGlobalsPtr saved_globals;
+  const int saved_err_count;
+
+  TaskScope(EnvironmentManager &env, int &runtime_err_count,
+            EnvironmentManager::SharedGlobalsPtr globals)
+      : env_manager(env), err_count(runtime_err_count),
+        frame(env.get_frame()), stack_top(env.stack_top()),
+        saved_globals(env.set_shared_globals(std::move(globals))),
+        saved_err_count(std::exchange(runtime_err_count, 0)) {}
+  TaskScope(const TaskScope &) = delete;
+  auto operator=(const TaskScope &) -> TaskScope & = delete;
+  ~TaskScope() {
+    env_manager.unwind(frame, stack_top);
+    env_manager.set_shared_globals(std::move(saved_globals));
+    err_count = saved_err_count;
+  }
+};
+
+// drops the frames and values a script or host call leaves on the stack, and
+// closes their upvalues, if it's abandoned by a throw; a no-op otherwise
+struct StackScope {
+  EnvironmentManager &env_manager;
+  const EnvironmentManager::Frame frame;
+  const size_t stack_top;
+
+  explicit StackScope(EnvironmentManager &env)
+      : env_manager(env), frame(env.get_frame()), stack_top(env.stack_top()) {}
+  StackScope(const StackScope &) = delete;
+  auto operator=(const StackScope &) -> StackScope & = delete;
+  ~StackScope() { env_manager.unwind(frame, stack_top); }
+};
+
+// gives a script, host call or task fibers of its own, which `finish` runs
+// to the end once its own code is done; the enclosing one's come back when
+// the scope ends, after abandoning whatever fibers were left
+struct FiberScope {
+  std::unique_ptr<FiberScheduler> &current;
+  std::unique_ptr<FiberScheduler> saved;
+
+  explicit FiberScope(std::unique_ptr<FiberScheduler> &fibers)
+      : current(fibers), saved(std::move(fibers)) {}
+  FiberScope(const FiberScope &) = delete;
+  auto operator=(const FiberScope &) -> FiberScope & = delete;
+  ~FiberScope() { current = std::move(saved); }
+
+  auto finish() -> void {
+    if (current != nullptr)
+      current->finish();
+  }
+};
+} // namespace
+
+auto EvaluatorOptions::native_stack_bytes() const noexcept -> size_t {
+  return NATIVE_STACK_BASE + max_call_depth * NATIVE_STACK_PER_CALL;
+}
+
+// definitions of Evaluator methods
+Evaluator::Evaluator(ErrorHandler &error_handler, EvaluatorOptions options)
+    : m_error_handler(error_handler), m_env_manager(error_handler),
+      m_options(options), m_output(options.output),
+      m_max_call_depth(options.max_call_depth) {
+  define_core_builtins(*this);
+  define_array_builtins(*this);
+  define_math_builtins(*this);
+  define_task_builtins(*this);
+  define_channel_builtins(*this);
+  define_stream_builtins(*this);
+  define_file_builtins(*this);
+  define_json_builtins(*this);
+}
+
+Evaluator::~Evaluator() = default;
+
+auto Evaluator::define_native(BuiltinFunctionPtr native) -> void {
+  const std::string name = native->get_name();
+  m_env_manager.define_global(name, std::move(native));
+}
+
+auto Evaluator::define_global(const std::string &name, BoopObject value)
+    -> void {
+  m_env_manager.define_global(name, std::move(value));
+}
+
+auto Evaluator::run(const ProgramPtr &program) -> void {
+  m_runtime_err_count = 0; // the limit is per script
+  // The functions the script declares hold this evaluator's own reference to
+  // the program rather than copies of `program`: creating closures would
+  // otherwise bump a reference count shared with every other thread running
+  // the same Program.
+  const auto handle = std::make_shared<ProgramPtr>(program);
+  const ProgramPtr local{handle, program.get()};
+  ProgramGuard program_guard{m_program, &local};
+
+  on_native_stack([&] { run_script(*program); });
+}
+
+auto Evaluator::on_native_stack(const std::function<void()> &body) -> void {
+  if (!m_options.dedicated_stack) {
+    body();
+    m_output.flush();
+    return;
+  }
+  // the evaluator recurses natively for every non-tail call, so it runs on a
+  // thread whose stack is big enough to reach max_call_depth before the host
+  // stack would run out. The thread is started by the first run or call and
+  // kept for the next ones; errors are handed back to the calling thread.
+  if (m_stack_thread == nullptr) {
+    try {
+      m_stack_thread = std::make_unique<ThreadPool>(
+          ThreadPoolOptions{1, m_options.native_stack_bytes()});
+    } catch (const std::runtime_error &) {
+      // no thread at all: everything runs on the caller's stack
+    }
+    // a default sized stack can't take max_call_depth nested calls
+    if (m_stack_thread == nullptr || m_stack_thread->stack_bytes() == 0)
+      m_max_call_depth = std::min<size_t>(
+          m_max_call_depth, EvaluatorOptions::DEFAULT_MAX_CALL_DEPTH / 10);
+  }
+  if (m_stack_thread == nullptr || m_stack_thread->is_worker_thread()) {
+    body();
+    m_output.flush();
+    return;
+  }
+  std::exception_ptr failure;
+  m_stack_thread->submit([&] {
+    try {
+      body();
+    } catch (...) {
+      failure = std::current_exception();
+    }
+  });
+  m_stack_thread->wait_idle();
+  m_output.flush();
+  if (failure)
+    std::rethrow_exception(failure);
+}
+
+auto Evaluator::call(const std::string &name, ArgSpan args) -> EvalResult {
+  m_runtime_err_count = 0;
+  const Token call_site{TokenType::IDENTIFIER, name, std::nullopt, 0};
+  const BoopObject *global = m_env_manager.find_global(name);
+  if (EXPECT_FALSE(global == nullptr))
+    return report_runtime_error(m_error_handler, call_site,
+                                "Attempted to call an undefined function.");
+  // a copy: the call may redefine the global
+  const BoopObject callee = *global;
+  EvalResult result{Status::OK};
+  on_native_stack([&] {
+    StackScope stack{m_env_manager};
+    FiberScope fibers{m_fibers};
+    result = call_value(callee, args, call_site);
+    fibers.finish();
+  });
+  return result;
+}
+
+auto Evaluator::call_value(const BoopObject &callee, ArgSpan args,
+                           const Token &call_site) -> EvalResult {
+  if (const auto *native = std::get_if<BuiltinFunctionPtr>(&callee)) {
+    const size_t arity = (*native)->arity();
+    if (EXPECT_FALSE(arity != BuiltinFunction::VARIADIC &&
+                     arity != args.size()))
+      return report_runtime_error(
+          m_error_handler, call_site,
+          "Expected " + std::to_string(arity) + " arguments. Got " +
+              std::to_string(args.size()) + " arguments. ");
+    NativeContext context{m_error_handler, call_site, m_output, *this};
+    return (*native)->call(context, args);
+  }
+
+  BoopObject nullable_instance{nullptr};
+  FunctionPtr fun_obj{nullptr};
+  if (const auto *boop_class = std::get_if<BoopClassPtr>(&callee)) {
+    auto instance = std::make_shared<BoopInstance>(*boop_class);
+    nullable_instance = instance;
+    std::optional<BoopObject> init = (*boop_class)->find_methods("init");
+    if (!init.has_value())
+      return nullable_instance;
+    fun_obj = bind_instance(std::get<FunctionPtr>(init.value()), instance);
+  } else if (const auto *function = std::get_if<FunctionPtr>(&callee)) {
+    fun_obj = *function;
+  } else {
+    return report_runtime_error(m_error_handler, call_site,
+                                "Only functions and classes can be called.");
+  }
+
+  if (EXPECT_FALSE(fun_obj->arity() != args.size()))
+    return report_runtime_error(
+        m_error_handler, call_site,
+        "Expected " + std::to_string(fun_obj->arity()) + " arguments. Got " +
+            std::to_string(args.size()) + " arguments. ");
+  // the receiver of a bound method and the arguments become the first slots
+  // of the function's frame, as if a call expression had pushed them
+  const size_t frame_base = m_env_manager.stack_top();
+  Status status = Status::OK;
+  if (fun_obj->is_method())
+    status = m_env_manager.push_value(fun_obj->get_receiver());
+  for (size_t i = 0; status == Status::OK && i < args.size(); ++i)
+    status = m_env_manager.push_value(args[i]);
+  if (EXPECT_FALSE(status != Status::OK)) {
+    m_env_manager.truncate_stack(frame_base);
+    return report_runtime_error(m_error_handler, call_site, "Stack overflow.");
+  }
+  const bool is_initializer = fun_obj->is_initializer();
+  ASSIGN_OR_RETURN(BoopObject ret_value,
+                   call_function(std::move(fun_obj), frame_base, call_site));
+  if (EXPECT_FALSE(is_initializer &&
+                   !std::holds_alternative<std::nullptr_t>(ret_value)))
+    return report_runtime_error(
+        m_error_handler, call_site,
+        "Initializer can't return a value other than 'this'");
+  if (!is_initializer)
+    return ret_value;
+  return nullable_instance;
+}
+
+auto Evaluator::spawn(BoopObject callee, std::vector<BoopObject> args,
+                      const Token &call_site, bool share_result)
+    -> FuturePtr {
+  TaskCall task{std::move(callee), std::move(args),
+                m_env_manager.share_globals(), call_site,
+                m_options.output, share_result};
+  return spawn_task(task_pool(), std::move(task));
+}
+
+auto Evaluator::task_workers() -> size_t { return task_pool_size(task_pool()); }
+
+auto Evaluator::task_pool() -> TaskPool & {
+  if (m_options.task_pool == nullptr) {
+    m_own_task_pool = start_task_pool(m_options);
+    m_options.task_pool = m_own_task_pool.get();
+  }
+  return *m_options.task_pool;
+}
+
+auto Evaluator::run_task(const TaskCall &task) -> EvalResult {
+  TaskScope scope{m_env_manager, m_runtime_err_count, task.globals};
+  FiberScope fibers{m_fibers};
+  EvalResult result = call_value(
+      task.callee, ArgSpan(task.args.data(), task.args.size()),
+      task.call_site);
+  fibers.finish();
+  m_output.flush();
+  return result;
+}
+
+auto Evaluator::run_script(const Program &program) -> void {
+  StackScope stack{m_env_manager};
+  // block-scoped locals of the script get a frame like any function's
+  EnvironmentManager::Frame caller;
+  if (EXPECT_FALSE(m_env_manager.push_frame(m_env_manager.stack_top(),
+                                            program.get_layout().frame_size,
+                                            nullptr, caller) != Status::OK)) {
+    m_error_handler.add(0, "Stack overflow.");
+    return;
+  }
+  FiberScope fibers{m_fibers};
+  evaluate_stmts(program.get_stmts());
+  fibers.finish();
+  m_env_manager.pop_frame(std::move(caller));
+}
+
+auto Evaluator::fibers() -> FiberScheduler & {
+  if (m_fibers == nullptr)
+    m_fibers = std::make_unique<FiberScheduler>(
+        *this, std::min(m_max_call_depth, FIBER_MAX_CALL_DEPTH));
+  return *m_fibers;
+}
+
+auto Evaluator::swap_fiber_state(FiberState &state) noexcept -> void {
+  m_env_manager.swap_stack(state.stack);
+  std::swap(m_call_depth, state.call_depth);
+  std::swap(m_max_call_depth, state.max_call_depth);
+  std::swap(m_program, state.program);
+}
+
+auto Evaluator::flush_output() -> void { m_output.flush(); }
+
+namespace {
+// number of consecutive generic evaluations with identical operand types
+// before a binary node is rewritten to a specialized handler
+constexpr uint8_t QUICKEN_THRESHOLD = 8;
+// a node that deoptimizes this many times is considered polymorphic and stays
+// on the generic path for good
+constexpr uint8_t MAX_DEOPTS = 4;
+
+auto select_binary_handler(TokenType op, const BoopObject &left,
+                           const BoopObject &right) -> AST::BinaryHandler {
+  if (std::holds_alternative<double>(left) &&
+      std::holds_alternative<double>(right)) {
+    switch (op) {
+    case TokenType::PLUS:
+      return AST::BinaryHandler::DOUBLE_ADD;
+    case TokenType::MINUS:
+      return AST::BinaryHandler::DOUBLE_SUB;
+    case TokenType::STAR:
+      return AST::BinaryHandler::DOUBLE_MUL;
+    case TokenType::SLASH:
+      return AST::BinaryHandler::DOUBLE_DIV;
+    case TokenType::LESS:
+      return AST::BinaryHandler::DOUBLE_LESS;
+    case TokenType::LESS_EQUAL:
+      return AST::BinaryHandler::DOUBLE_LESS_EQUAL;
+    case TokenType::GREATER:
+      return AST::BinaryHandler::DOUBLE_GREATER;
+    case TokenType::GREATER_EQUAL:
+      return AST::BinaryHandler::DOUBLE_GREATER_EQUAL;
+    case TokenType::EQUAL_EQUAL:
+      return AST::BinaryHandler::DOUBLE_EQUAL_EQUAL;
+    case TokenType::BANG_EQUAL:
+      return AST::BinaryHandler::DOUBLE_BANG_EQUAL;
+    default:
+      return AST::BinaryHandler::GENERIC;
+    }
+  }
+  if (std::holds_alternative<int64_t>(left) &&
+      std::holds_alternative<int64_t>(right)) {
+    switch (op) {
+    case TokenType::PLUS:
+      return AST::BinaryHandler::INT_ADD;
+    case TokenType::MINUS:
+      return AST::BinaryHandler::INT_SUB;
+    case TokenType::STAR:
+      return AST::BinaryHandler::INT_MUL;
+    case TokenType::LESS:
+      return AST::BinaryHandler::INT_LESS;
+    case TokenType::LESS_EQUAL:
+      return AST::BinaryHandler::INT_LESS_EQUAL;
+    case TokenType::GREATER:
+      return AST::BinaryHandler::INT_GREATER;
+    case TokenType::GREATER_EQUAL:
+      return AST::BinaryHandler::INT_GREATER_EQUAL;
+    case TokenType::EQUAL_EQUAL:
+      return AST::BinaryHandler::INT_EQUAL_EQUAL;
+    case TokenType::BANG_EQUAL:
+      return AST::BinaryHandler::INT_BANG_EQUAL;
+    default: // integer division yields a double, leave it generic
+      return AST::BinaryHandler::GENERIC;
+    }
+  }
+  if (op == TokenType::PLUS && std::holds_alternative<BoopString>(left) &&
+      std::holds_alternative<BoopString>(right))
+    return AST::BinaryHandler::STRING_ADD;
+  return AST::BinaryHandler::GENERIC;
+}
+} // namespace
+
+auto Evaluator::evaluate_quickened_binary(AST::BinaryHandler handler,
+                                          const BoopObject &left,
+                                          const BoopObject &right,
+                                          BoopObject &result) -> Quickened {
+  if (handler == AST::BinaryHandler::STRING_ADD) {
+    if (EXPECT_FALSE(!std::holds_alternative<BoopString>(left) ||
+                     !std::holds_alternative<BoopString>(right)))
+      return Quickened::GUARD_FAILED;
+    result = BoopString::concat(std::get<BoopString>(left),
+                                std::get<BoopString>(right));
+    return Quickened::DONE;
+  }
+  if (handler >= AST::BinaryHandler::INT_ADD)
+    return evaluate_quickened_int_binary(handler, left, right, result);
+
+  const double *lhs = std::get_if<double>(&left);
+  const double *rhs = std::get_if<double>(&right);
+  if (EXPECT_FALSE(lhs == nullptr || rhs == nullptr))
+    return Quickened::GUARD_FAILED;
+
+  switch (handler) {
+  case AST::BinaryHandler::DOUBLE_ADD:
+    result = *lhs + *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_SUB:
+    result = *lhs - *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_MUL:
+    result = *lhs * *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_DIV:
+    // leave division by zero to the generic path so it gets reported
+    if (EXPECT_FALSE(*rhs == 0.0))
+      return Quickened::GENERIC_PATH;
+    result = *lhs / *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_LESS:
+    result = *lhs < *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_LESS_EQUAL:
+    result = *lhs <= *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_GREATER:
+    result = *lhs > *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_GREATER_EQUAL:
+    result = *lhs >= *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_EQUAL_EQUAL:
+    result = *lhs == *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::DOUBLE_BANG_EQUAL:
+    result = *lhs != *rhs;
+    return Quickened::DONE;
+  default:
+    return Quickened::GUARD_FAILED;
+  }
+}
+
+// the INT_* handlers of evaluate_quickened_binary; overflowing results are
+// promoted to double without failing the guard, which is on operand types
+auto Evaluator::evaluate_quickened_int_binary(AST::BinaryHandler handler,
+                                              const BoopObject &left,
+                                              const BoopObject &right,
+                                              BoopObject &result) -> Quickened {
+  const int64_t *lhs = std::get_if<int64_t>(&left);
+  const int64_t *rhs = std::get_if<int64_t>(&right);
+  if (EXPECT_FALSE(lhs == nullptr || rhs == nullptr))
+    return Quickened::GUARD_FAILED;
+
+  switch (handler) {
+  case AST::BinaryHandler::INT_ADD:
+    result = int_add(*lhs, *rhs);
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_SUB:
+    result = int_sub(*lhs, *rhs);
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_MUL:
+    result = int_mul(*lhs, *rhs);
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_LESS:
+    result = *lhs < *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_LESS_EQUAL:
+    result = *lhs <= *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_GREATER:
+    result = *lhs > *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_GREATER_EQUAL:
+    result = *lhs >= *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_EQUAL_EQUAL:
+    result = *lhs == *rhs;
+    return Quickened::DONE;
+  case AST::BinaryHandler::INT_BANG_EQUAL:
+    result = *lhs != *rhs;
+    return Quickened::DONE;
+  default:
+    return Quickened::GUARD_FAILED;
+  }
+}
+
+// records the operand types seen by the generic path and rewrites the node
+// once they have been stable for QUICKEN_THRESHOLD evaluations
+auto Evaluator::observe_binary_operands(const AST::ExprBinaryPtr &expr,
+                                        const BoopObject &left,
+                                        const BoopObject &right) -> void {
+  constexpr auto relaxed = std::memory_order_relaxed;
+  if (EXPECT_FALSE(expr->deopt_count.load(relaxed) >= MAX_DEOPTS))
+    return;
+
+  const auto left_type = static_cast<uint8_t>(left.index());
+  const auto right_type = static_cast<uint8_t>(right.index());
+  if (expr->observed_left.load(relaxed) != left_type ||
+      expr->observed_right.load(relaxed) != right_type) {
+    expr->observed_left.store(left_type, relaxed);
+    expr->observed_right.store(right_type, relaxed);
+    expr->stable_hits.store(0, relaxed);
+    return;
+  }
+
+  // a plain load and store rather than fetch_add: a lost count only delays
+  // quickening, and the node's cache line isn't locked on every run
+  const uint8_t stable_hits = expr->stable_hits.load(relaxed) + 1;
+  if (stable_hits < QUICKEN_THRESHOLD) {
+    expr->stable_hits.store(stable_hits, relaxed);
+    return;
+  }
+  const AST::BinaryHandler handler =
+      select_binary_handler(expr->op.get_type(), left, right);
+  expr->handler.store(handler, relaxed);
+  expr->stable_hits.store(0, relaxed);
+  // nothing to specialize for this operator and type pair
+  if (handler == AST::BinaryHandler::GENERIC)
+    expr->deopt_count.store(MAX_DEOPTS, relaxed);
+}
+
+auto Evaluator::evaluate_binary_expr(const AST::ExprBinaryPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject left, evaluate_expr(expr->left));
+  ASSIGN_OR_RETURN(BoopObject right, evaluate_expr(expr->right));
+
+  const AST::BinaryHandler handler =
+      expr->handler.load(std::memory_order_relaxed);
+  if (handler == AST::BinaryHandler::GENERIC) {
+    observe_binary_operands(expr, left, right);
+  } else {
+    BoopObject result;
+    const Quickened outcome =
+        evaluate_quickened_binary(handler, left, right, result);
+    if (EXPECT_TRUE(outcome == Quickened::DONE))
+      return result;
+    // the node stays quickened for operands it merely hands on
+    if (outcome == Quickened::GUARD_FAILED) {
+      // type guard failed; deoptimize back to the generic handler
+      expr->handler.store(AST::BinaryHandler::GENERIC,
+                          std::memory_order_relaxed);
+      expr->deopt_count.store(
+          expr->deopt_count.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      observe_binary_operands(expr, left, right);
+    }
+  }
+
+  if (EXPECT_FALSE(std::holds_alternative<Float64ArrayPtr>(left) ||
+                   std::holds_alternative<Float64ArrayPtr>(right)) &&
+      is_arithmetic(expr->op.get_type()) && is_array_operand(left) &&
+      is_array_operand(right))
+    return evaluate_array_binary(expr->op, left, right);
+
+  switch (expr->op.get_type()) {
+  case TokenType::COMMA:
+    return right;
+  case TokenType::BANG_EQUAL:
+    return !are_equals(left, right);
+  case TokenType::EQUAL_EQUAL:
+    return are_equals(left, right);
+  case TokenType::MINUS:
+  case TokenType::STAR:
+  case TokenType::LESS:
+  case TokenType::LESS_EQUAL:
+  case TokenType::GREATER:
+  case TokenType::GREATER_EQUAL:
+    RETURN_IF_ERROR(check_numbers(expr->op, left, right));
+    return apply_numeric_op(expr->op.get_type(), left, right);
+  case TokenType::SLASH: {
+    RETURN_IF_ERROR(check_numbers(expr->op, left, right));
+    if (EXPECT_FALSE(as_double(right) == 0.0))
+      return report_runtime_error(m_error_handler, expr->op,
+                                  "Division by zero is illegal");
+    return apply_numeric_op(TokenType::SLASH, left, right);
+  }
+  case TokenType::PLUS: {
+    if (is_number(left) && is_number(right)) {
+      return apply_numeric_op(TokenType::PLUS, left, right);
+    }
+    if (std::holds_alternative<BoopString>(left) ||
+        std::holds_alternative<BoopString>(right)) {
+      return BoopString::concat(as_boop_string(left), as_boop_string(right));
+    }
+    return report_runtime_error(
+        m_error_handler, expr->op,
+        "Operands to 'plus' must be numbers or strings; This is invalid: " +
+            get_object_string(left) + " + " + get_object_string(right));
+  }
+  default:
+    return report_runtime_error(
+        m_error_handler, expr->op,
+        "Attempted to apply invalid operator to binary expr: " +
+            expr->op.get_type_string());
+  }
+}
+
+auto Evaluator::evaluate_array_binary(const Token &op, const BoopObject &left,
+                                      const BoopObject &right) -> EvalResult {
+  const auto *lhs = std::get_if<Float64ArrayPtr>(&left);
+  const auto *rhs = std::get_if<Float64ArrayPtr>(&right);
+  const size_t size = (lhs != nullptr ? *lhs : *rhs)->size();
+  auto result = std::make_shared<Float64Array>(size);
+  double *out = result->data.data();
+
+  if (lhs != nullptr && rhs != nullptr) {
+    if (EXPECT_FALSE((*rhs)->size() != size))
+      return report_runtime_error(
+          m_error_handler, op,
+          "Float64Array operands differ in length: " + std::to_string(size) +
+              " and " + std::to_string((*rhs)->size()) + ".");
+    const double *a = (*lhs)->data.data();
+    const double *b = (*rhs)->data.data();
+    switch (op.get_type()) {
+    case TokenType::PLUS:
+      kernels::add(a, b, out, size);
+      break;
+    case TokenType::MINUS:
+      kernels::sub(a, b, out, size);
+      break;
+    case TokenType::STAR:
+      kernels::mul(a, b, out, size);
+      break;
+    default: // TokenType::SLASH
+      kernels::div(a, b, out, size);
+      break;
+    }
+    return BoopObject(std::move(result));
+  }
+
+  // the number is applied to every element; division by zero follows IEEE
+  // 754 here rather than being an error
+  const bool array_first = lhs != nullptr;
+  const double *a = (array_first ? *lhs : *rhs)->data.data();
+  const double scalar = as_double(array_first ? right : left);
+  switch (op.get_type()) {
+  case TokenType::PLUS:
+    kernels::add_scalar(a, scalar, out, size);
+    break;
+  case TokenType::MINUS:
+    if (array_first)
+      kernels::sub_scalar(a, scalar, out, size);
+    else
+      kernels::rsub_scalar(a, scalar, out, size);
+    break;
+  case TokenType::STAR:
+    kernels::mul_scalar(a, scalar, out, size);
+    break;
+  default: // TokenType::SLASH
+    if (array_first)
+      kernels::div_scalar(a, scalar, out, size);
+    else
+      kernels::rdiv_scalar(a, scalar, out, size);
+    break;
+  }
+  return BoopObject(std::move(result));
+}
+
+auto Evaluator::evaluate_grouping_expr(const AST::ExprGroupingPtr &expr)
+    -> EvalResult {
+  return evaluate_expr(expr->expression);
+}
+
+auto Evaluator::evaluate_literal_expr(const AST::ExprLiteralPtr &expr)
+    -> EvalResult {
+  return expr->value;
+}
+
+auto Evaluator::evaluate_unary_expr(const AST::ExprUnaryPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject right, evaluate_expr(expr->right));
+  switch (expr->op.get_type()) {
+  case TokenType::BANG:
+    return !is_true(right);
+  case TokenType::MINUS:
+    RETURN_IF_ERROR(check_number(expr->op, right));
+    if (const auto *integer = std::get_if<int64_t>(&right))
+      return int_sub(0, *integer);
+    return -std::get<double>(right);
+  case TokenType::PLUS_PLUS:
+    RETURN_IF_ERROR(check_number(expr->op, right));
+    if (const auto *integer = std::get_if<int64_t>(&right))
+      return int_add(*integer, 1);
+    return std::get<double>(right) + 1;
+  case TokenType::MINUS_MINUS:
+    RETURN_IF_ERROR(check_number(expr->op, right));
+    if (const auto *integer = std::get_if<int64_t>(&right))
+      return int_sub(*integer, 1);
+    return std::get<double>(right) - 1;
+  default:
+    return report_runtime_error(
+        m_error_handler, expr->op,
+        "Illegal unary expression: " + expr->op.get_lexeme() +
+            get_object_string(right));
+  }
+}
+
+auto Evaluator::evaluate_conditional_expr(const AST::ExprConditionalPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject condition, evaluate_expr(expr->condition));
+  if (is_true(condition))
+    return evaluate_expr(expr->then_branch);
+  return evaluate_expr(expr->else_branch);
+}
+
+auto Evaluator::evaluate_variable_expr(const AST::ExprVariablePtr &expr)
+    -> EvalResult {
+  return m_env_manager.get(expr->var_name, expr->resolved);
+}
+
+auto Evaluator::evaluate_assignment_expr(const AST::ExprAssignmentPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(expr->right));
+  RETURN_IF_ERROR(
+      m_env_manager.assign(expr->var_name, expr->resolved, value));
+  return value;
+}
+
+namespace {
+auto match(const Token &token, TokenType tType) -> bool {
+  return token.get_type() == tType;
+}
+
+// callers make sure val holds a number
+auto apply_post_fix_op(const Token &op, const BoopObject &val) -> BoopObject {
+  if (const auto *integer = std::get_if<int64_t>(&val))
+    return match(op, TokenType::PLUS_PLUS) ? int_add(*integer, 1)
+                                            : int_sub(*integer, 1);
+  double dVal = std::get<double>(val);
+  if (match(op, TokenType::PLUS_PLUS))
+    return BoopObject(++dVal);
+  return BoopObject(--dVal);
+}
+} // namespace
+
+auto Evaluator::evaluate_postfix_expr(const AST::ExprPostfixPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject lhs, evaluate_expr(expr->left));
+  if (EXPECT_TRUE(std::holds_alternative<AST::ExprVariablePtr>(expr->left))) {
+    RETURN_IF_ERROR(check_number(expr->op, lhs));
+    const auto &variable = std::get<AST::ExprVariablePtr>(expr->left);
+    RETURN_IF_ERROR(m_env_manager.assign(variable->var_name, variable->resolved,
+                                         apply_post_fix_op(expr->op, lhs)));
+  }
+  return lhs;
+}
+
+auto Evaluator::evaluate_logical_expr(const AST::ExprLogicalPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject lhs, evaluate_expr(expr->left));
+  if (expr->op.get_type() == TokenType::OR)
+    return is_true(lhs) ? lhs : evaluate_expr(expr->right);
+  if (expr->op.get_type() == TokenType::AND)
+    return !is_true(lhs) ? lhs : evaluate_expr(expr->right);
+
+  return report_runtime_error(m_error_handler, expr->op,
+                              "Illegal logical operator: " +
+                                  expr->op.get_lexeme());
+}
+
+auto Evaluator::evaluate_call_expr(const AST::ExprCallPtr &expr) -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject callee, evaluate_expr(expr->callee));
+  return invoke(expr, std::move(callee));
+}
+
+auto Evaluator::invoke(const AST::ExprCallPtr &expr, BoopObject callee)
+    -> EvalResult {
+  if (EXPECT_FALSE(std::holds_alternative<BuiltinFunctionPtr>(callee))) {
+    return call_native(expr, std::get<BuiltinFunctionPtr>(callee));
+  }
+
+  BoopObject nullable_instance{nullptr};
+  FunctionPtr fun_obj{nullptr};
+  if (EXPECT_FALSE(std::holds_alternative<BoopClassPtr>(callee))) {
+    const auto &boop_class = std::get<BoopClassPtr>(callee);
+    auto instance = std::make_shared<BoopInstance>(boop_class);
+    nullable_instance = instance;
+    // a class without an initializer is the common case, not an error; look
+    // the method up directly instead of going through a failed field access
+    std::optional<BoopObject> init = boop_class->find_methods("init");
+    if (!init.has_value())
+      return nullable_instance;
+    fun_obj = bind_instance(std::get<FunctionPtr>(init.value()), instance);
+  } else if (EXPECT_TRUE(std::holds_alternative<FunctionPtr>(callee))) {
+    fun_obj = std::get<FunctionPtr>(callee);
+  } else {
+    return report_runtime_error(m_error_handler, expr->paren,
+                                "Attempted to invoke a non-function");
+  }
+
+  const size_t frame_base = m_env_manager.stack_top();
+  RETURN_IF_ERROR(push_arguments(fun_obj, expr));
+  const bool is_initializer = fun_obj->is_initializer();
+  ASSIGN_OR_RETURN(BoopObject ret_value,
+                   call_function(std::move(fun_obj), frame_base, expr->paren));
+
+  if (EXPECT_FALSE(is_initializer &&
+                   !std::holds_alternative<std::nullptr_t>(ret_value)))
+    return report_runtime_error(
+        m_error_handler, expr->paren,
+        "Initializer can't return a value other than 'this'");
+  if (!is_initializer)
+    return ret_value;
+  return nullable_instance;
+}
+
+auto Evaluator::push_arguments(const FunctionPtr &fun_obj,
+                               const AST::ExprCallPtr &expr) -> Status {
+  // Report an error if arity doesn't match the number of arguments supplied
+  size_t arity = fun_obj->arity();
+  size_t arg_size = expr->arguments.size();
+  if (EXPECT_FALSE(arity != arg_size)) {
+    return report_runtime_error(m_error_handler, expr->paren,
+                                "Expected " + std::to_string(arity) +
+                                    " arguments. Got " +
+                                    std::to_string(arg_size) + " arguments. ");
+  }
+
+  // Evaluate Arguments before switching to the next context as the arguments
+  // may rely on values in this context. They are pushed straight onto the
+  // value stack where they become the first slots of the callee's frame.
+  const size_t args_begin = m_env_manager.stack_top();
+  if (fun_obj->is_method() &&
+      EXPECT_FALSE(m_env_manager.push_value(fun_obj->get_receiver()) !=
+                   Status::OK))
+    return report_runtime_error(m_error_handler, expr->paren,
+                                "Stack overflow.");
+  return push_argument_values(expr, args_begin);
+}
+
+auto Evaluator::push_argument_values(const AST::ExprCallPtr &expr,
+                                     size_t truncate_to) -> Status {
+  Status status = Status::OK;
+  for (auto arg = expr->arguments.begin();
+       status == Status::OK && arg != expr->arguments.end(); ++arg) {
+    EvalResult value = evaluate_expr(*arg);
+    status = value.ok() ? m_env_manager.push_value(std::move(value.value))
+                        : value.status;
+  }
+  if (EXPECT_FALSE(status != Status::OK)) {
+    m_env_manager.truncate_stack(truncate_to);
+    if (status == Status::STACK_OVERFLOW)
+      return report_runtime_error(m_error_handler, expr->paren,
+                                  "Stack overflow.");
+  }
+  return status;
+}
+
+auto Evaluator::call_native(const AST::ExprCallPtr &expr,
+                            const BuiltinFunctionPtr &native) -> EvalResult {
+  const size_t arity = native->arity();
+  const size_t arg_size = expr->arguments.size();
+  if (EXPECT_FALSE(arity != BuiltinFunction::VARIADIC && arity != arg_size)) {
+    return report_runtime_error(m_error_handler, expr->paren,
+                                "Expected " + std::to_string(arity) +
+                                    " arguments. Got " +
+                                    std::to_string(arg_size) + " arguments. ");
+  }
+
+  // the arguments go onto the value stack like a Boop call's and the builtin
+  // sees them in place
+  const size_t args_begin = m_env_manager.stack_top();
+  RETURN_IF_ERROR(push_argument_values(expr, args_begin));
+  NativeContext context{m_error_handler, expr->paren, m_output, *this};
+  EvalResult result = native->call(
+      context, ArgSpan(m_env_manager.stack_at(args_begin), arg_size));
+  m_env_manager.truncate_stack(args_begin);
+  return result;
+}
+
+auto Evaluator::call_function(FunctionPtr fun_obj, size_t frame_base,
+                              const Token &paren) -> EvalResult {
+  // tail calls don't count, they replace the call they're made from
+  if (EXPECT_FALSE(m_call_depth >= m_max_call_depth)) {
+    m_env_manager.truncate_stack(frame_base);
+    return report_runtime_error(m_error_handler, paren, "Stack overflow.");
+  }
+  CallDepthGuard depth_guard{m_call_depth};
+  ProgramGuard program_guard{m_program, &fun_obj->get_program()};
+
+  const Token *call_paren = &paren;
+  while (true) {
+    m_program = &fun_obj->get_program();
+    const auto &declaration = fun_obj->get_declaration();
+    EnvironmentManager::Frame caller;
+    if (EXPECT_FALSE(m_env_manager.push_frame(
+                         frame_base, declaration->frame_size,
+                         &fun_obj->get_upvalues(), caller) != Status::OK)) {
+      m_env_manager.truncate_stack(frame_base);
+      return report_runtime_error(m_error_handler, *call_paren,
+                                  "Stack overflow.");
+    }
+
+    // Evaluate the function
+    const Completion completion = evaluate_stmts(fun_obj->get_declaration()->body);
+
+    if (completion == Completion::TAIL_CALL) {
+      // The callee takes over this frame: its receiver and arguments move down
+      // to the frame base and the loop runs it without a native call.
+      m_env_manager.pop_frame_keeping(std::move(caller),
+                                      m_tail_call.args_begin);
+      fun_obj = std::move(m_tail_call.function);
+      call_paren = m_tail_call.paren;
+      continue;
+    }
+
+    // Popping the frame closes the upvalues pointing into it, drops its slots
+    // and returns to the caller's frame.
+    m_env_manager.pop_frame(std::move(caller));
+
+    // return result or BoopObject(nullptr);
+    if (completion == Completion::RETURN) {
+      BoopObject ret_value = std::move(m_return_value);
+      m_return_value = nullptr;
+      return ret_value;
+    }
+    return BoopObject(nullptr);
+  }
+}
+
+auto Evaluator::evaluate_function_expr(const AST::ExprFunctionPtr &expr)
+    -> EvalResult {
+  // The function captures only the variables the Resolver found it using.
+  return FunctionPtr(std::make_shared<Functor>(
+      *m_program, expr, "BoopAnonFuncDoNotUseThisNameAADWAED",
+      m_env_manager.capture(expr->upvalues)));
+}
+
+auto Evaluator::evaluate_get_expr(const AST::ExprGetPtr &expr) -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject inst_obj, evaluate_expr(expr->expr));
+  if (EXPECT_FALSE(!std::holds_alternative<BoopInstancePtr>(inst_obj))) {
+    return report_runtime_error(m_error_handler, expr->name,
+                                "Only instances have properties");
+  }
+  const auto &instance = std::get<BoopInstancePtr>(inst_obj);
+  std::optional<BoopObject> property = instance->get(expr->name.get_lexeme());
+  if (EXPECT_FALSE(!property.has_value())) {
+    return report_runtime_error(
+        m_error_handler, expr->name,
+        "Attempted to access undefined property: " + expr->name.get_lexeme() +
+            " on " + instance->to_string());
+  }
+  if (std::holds_alternative<FunctionPtr>(property.value())) {
+    // if it's a method that we just looked up, then we need to create a
+    // binding for 'this'
+    return bind_instance(std::get<FunctionPtr>(property.value()), instance);
+  }
+  return std::move(property.value());
+}
+
+auto Evaluator::evaluate_set_expr(const AST::ExprSetPtr &expr) -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject object, evaluate_expr(expr->expr));
+  if (EXPECT_FALSE(!std::holds_alternative<BoopInstancePtr>(object)))
+    return report_runtime_error(m_error_handler, expr->name,
+                                "Only instances have fields.");
+  if (EXPECT_FALSE(std::get<BoopInstancePtr>(object)->is_frozen()))
+    return report_runtime_error(m_error_handler, expr->name,
+                                "Can't modify a frozen instance.");
+  ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(expr->value));
+  std::get<BoopInstancePtr>(object)->set(expr->name.get_lexeme(), value);
+  return value;
+}
+
+auto Evaluator::evaluate_this_expr(const AST::ExprThisPtr &expr) -> EvalResult {
+  return m_env_manager.get(expr->keyword, expr->resolved);
+}
+
+auto Evaluator::evaluate_super_expr(const AST::ExprSuperPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject super_obj,
+                   m_env_manager.get(expr->keyword, expr->resolved));
+  BoopClassPtr super_class = std::get<BoopClassPtr>(super_obj);
+  auto optionalMethod = super_class->find_methods(expr->method.get_lexeme());
+  if (!optionalMethod.has_value())
+    return report_runtime_error(m_error_handler, expr->keyword,
+                                "Attempted to access undefined property " +
+                                    expr->keyword.get_lexeme() + " on super.");
+
+  ASSIGN_OR_RETURN(BoopObject this_obj,
+                   m_env_manager.get(expr->keyword, expr->this_resolved));
+  return bind_instance(std::get<FunctionPtr>(optionalMethod.value()),
+                       std::get<BoopInstancePtr>(this_obj));
+}
+
+auto Evaluator::evaluate_list_expr(const AST::ExprListPtr &expr) -> EvalResult {
+  auto list = std::make_shared<BoopList>();
+  list->elements.reserve(expr->elements.size());
+  for (const auto &element : expr->elements) {
+    ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(element));
+    list->elements.push_back(std::move(value));
+  }
+  return BoopObject(std::move(list));
+}
+
+auto Evaluator::evaluate_index_expr(const AST::ExprIndexPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject object, evaluate_expr(expr->object));
+  ASSIGN_OR_RETURN(BoopObject index, evaluate_expr(expr->index));
+  if (const auto *list = std::get_if<BoopListPtr>(&object)) {
+    ASSIGN_OR_RETURN(const size_t position,
+                     check_index(expr->bracket, index, (*list)->size(), false));
+    return (*list)->elements[position];
+  }
+  if (const auto *array = std::get_if<Float64ArrayPtr>(&object)) {
+    ASSIGN_OR_RETURN(const size_t position,
+                     check_index(expr->bracket, index, (*array)->size(), false));
+    return BoopObject((*array)->data[position]);
+  }
+  if (const auto *map = std::get_if<BoopMapPtr>(&object)) {
+    if (const BoopObject *value = (*map)->find(index))
+      return *value;
+    return report_runtime_error(m_error_handler, expr->bracket,
+                                "Key not found: " + get_object_string(index));
+  }
+  // strings are indexed by byte
+  if (const auto *str = std::get_if<BoopString>(&object)) {
+    ASSIGN_OR_RETURN(const size_t position,
+                     check_index(expr->bracket, index, str->size(), false));
+    return BoopObject(BoopString(std::string(1, str->str()[position])));
+  }
+  return report_runtime_error(m_error_handler, expr->bracket,
+                              "Only lists, maps, arrays and strings can be "
+                              "indexed.");
+}
+
+auto Evaluator::evaluate_index_set_expr(const AST::ExprIndexSetPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject object, evaluate_expr(expr->object));
+  if (EXPECT_FALSE(!std::holds_alternative<BoopListPtr>(object) &&
+                   !std::holds_alternative<BoopMapPtr>(object) &&
+                   !std::holds_alternative<Float64ArrayPtr>(object)))
+    return report_runtime_error(m_error_handler, expr->bracket,
+                                "Only list and array elements and map entries "
+                                "can be assigned to.");
+  if (EXPECT_FALSE(is_frozen(object)))
+    return report_runtime_error(m_error_handler, expr->bracket,
+                                "Can't modify a frozen value.");
+  ASSIGN_OR_RETURN(BoopObject index, evaluate_expr(expr->index));
+  ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(expr->value));
+  if (const auto *map = std::get_if<BoopMapPtr>(&object)) {
+    RETURN_IF_ERROR(check_map_key(expr->bracket, index));
+    (*map)->set(index, value);
+    return value;
+  }
+  if (const auto *array = std::get_if<Float64ArrayPtr>(&object)) {
+    RETURN_IF_ERROR(check_number(expr->bracket, value));
+    ASSIGN_OR_RETURN(const size_t position,
+                     check_index(expr->bracket, index, (*array)->size(), false));
+    (*array)->data[position] = as_double(value);
+    return value;
+  }
+  const auto &list = std::get<BoopListPtr>(object);
+  // the value may have grown or shrunk the list, so check against it now
+  ASSIGN_OR_RETURN(const size_t position,
+                   check_index(expr->bracket, index, list->size(), false));
+  list->elements[position] = value;
+  return value;
+}
+
+auto Evaluator::evaluate_slice_expr(const AST::ExprSlicePtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject object, evaluate_expr(expr->object));
+  size_t size{};
+  if (const auto *list = std::get_if<BoopListPtr>(&object))
+    size = (*list)->size();
+  else if (const auto *array = std::get_if<Float64ArrayPtr>(&object))
+    size = (*array)->size();
+  else if (const auto *str = std::get_if<BoopString>(&object))
+    size = str->size();
+  else
+    return report_runtime_error(m_error_handler, expr->bracket,
+                                "Only lists, arrays and strings can be "
+                                "sliced.");
+
+  size_t begin = 0;
+  size_t end = size;
+  if (expr->begin.has_value()) {
+    ASSIGN_OR_RETURN(BoopObject bound, evaluate_expr(expr->begin.value()));
+    ASSIGN_OR_RETURN(begin, check_index(expr->bracket, bound, size, true));
+  }
+  if (expr->end.has_value()) {
+    ASSIGN_OR_RETURN(BoopObject bound, evaluate_expr(expr->end.value()));
+    ASSIGN_OR_RETURN(end, check_index(expr->bracket, bound, size, true));
+  }
+  end = std::max(begin, end); // an inverted range is empty
+
+  if (const auto *list = std::get_if<BoopListPtr>(&object)) {
+    const auto first = (*list)->elements.cbegin();
+    return BoopObject(std::make_shared<BoopList>(std::vector<BoopObject>(
+        first + static_cast<std::ptrdiff_t>(begin),
+        first + static_cast<std::ptrdiff_t>(end))));
+  }
+  if (const auto *array = std::get_if<Float64ArrayPtr>(&object)) {
+    const auto first = (*array)->data.cbegin();
+    return BoopObject(std::make_shared<Float64Array>(std::vector<double>(
+        first + static_cast<std::ptrdiff_t>(begin),
+        first + static_cast<std::ptrdiff_t>(end))));
+  }
+  return BoopObject(
+      BoopString(std::get<BoopString>(object).str().substr(begin, end - begin)));
+}
+
+auto Evaluator::evaluate_map_expr(const AST::ExprMapPtr &expr) -> EvalResult {
+  auto map = std::make_shared<BoopMap>();
+  map->reserve(expr->keys.size());
+  for (size_t i = 0; i < expr->keys.size(); ++i) {
+    ASSIGN_OR_RETURN(BoopObject key, evaluate_expr(expr->keys[i]));
+    RETURN_IF_ERROR(check_map_key(expr->brace, key));
+    ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(expr->values[i]));
+    map->set(key, std::move(value));
+  }
+  return BoopObject(std::move(map));
+}
+
+auto Evaluator::evaluate_spawn_expr(const AST::ExprSpawnPtr &expr)
+    -> EvalResult {
+  const AST::ExprCallPtr &call = expr->call;
+  // the callee and the arguments, evaluated here like any call's
+  std::vector<BoopObject> values;
+  values.reserve(call->arguments.size() + 1);
+  ASSIGN_OR_RETURN(BoopObject callee, evaluate_expr(call->callee));
+  const bool is_fiber = expr->keyword.get_type() != TokenType::SPAWN;
+  if (EXPECT_FALSE(!std::holds_alternative<FunctionPtr>(callee) &&
+                   !std::holds_alternative<BuiltinFunctionPtr>(callee) &&
+                   !std::holds_alternative<BoopClassPtr>(callee)))
+    return report_runtime_error(
+        m_error_handler, call->paren,
+        is_fiber ? "Only functions and classes can be started as fibers."
+                 : "Only functions and classes can be spawned.");
+  values.push_back(std::move(callee));
+  for (const auto &arg : call->arguments) {
+    ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(arg));
+    values.push_back(std::move(value));
+  }
+  // a fiber runs on this thread and shares everything with its starter;
+  // a task gets copies of whatever this script could still change
+  if (!is_fiber)
+    RETURN_IF_ERROR(transfer(m_error_handler, call->paren, values));
+
+  BoopObject task_callee = std::move(values.front());
+  values.erase(values.begin());
+  if (is_fiber) {
+    // `async` gives a future of the fiber's result, `go` nothing
+    FuturePtr future = nullptr;
+    if (expr->keyword.get_type() == TokenType::ASYNC)
+      future = std::make_shared<BoopFuture>(true);
+    RETURN_IF_ERROR(fibers().go(m_error_handler, call->paren,
+                                std::move(task_callee), std::move(values),
+                                future));
+    return future == nullptr ? BoopObject(nullptr) : BoopObject(future);
+  }
+  return BoopObject(spawn(std::move(task_callee), std::move(values),
+                          call->paren, true));
+}
+
+auto Evaluator::evaluate_await_expr(const AST::ExprAwaitPtr &expr)
+    -> EvalResult {
+  ASSIGN_OR_RETURN(BoopObject value, evaluate_expr(expr->future));
+  const auto *future = std::get_if<FuturePtr>(&value);
+  if (EXPECT_FALSE(future == nullptr))
+    return report_runtime_error(m_error_handler, expr->keyword,
+                                "Only futures can be awaited.");
+  if ((*future)->is_local()) {
+    // set by another fiber, which runs meanwhile
+    RETURN_IF_ERROR(fibers().await(m_error_handler, expr->keyword, **future));
+    if (EXPECT_FALSE((*future)->failed()))
+      return report_runtime_error(m_error_handler, expr->keyword,
+                                  (*future)->get_error());
+    return (*future)->get_value();
+  }
+  if (!(*future)->is_done()) {
+    m_output.flush(); // what was printed before waiting shows up meanwhile
+    await_future(**future);
+  }
+  if (EXPECT_FALSE((*future)->failed()))
+    return report_runtime_error(m_error_handler, expr->keyword,
+                                "Task failed: " + (*future)->get_error());
+  return (*future)->get_value();
+}
+
+auto Evaluator::evaluate_expr(const AST::ExprPtrVariant &expr) -> EvalResult {
+  switch (expr.index()) {
+  case 0: // AST::ExprBinaryPtr
+    return evaluate_binary_expr(std::get<0>(expr));
+  case 1: // AST::ExprGroupingPtr
+    return evaluate_grouping_expr(std::get<1>(expr));
+  case 2: // AST::ExprLiteralPtr
+    return evaluate_literal_expr(std::get<2>(expr));
+  case 3: // AST::ExprUnaryPtr
+    return evaluate_unary_expr(std::get<3>(expr));
+  case 4: // AST::ExprConditionalPtr
+    return evaluate_conditional_expr(std::get<4>(expr));
+  case 5: // AST::ExprPostfixPtr
+    return evaluate_postfix_expr(std::get<5>(expr));
+  case 6: // AST::ExprVariablePtr
+    return evaluate_variable_expr(std::get<6>(expr));
+  case 7: // AST::ExprAssignmentPtr
+    return evaluate_assignment_expr(std::get<7>(expr));
+  case 8: // AST::ExprLogicalPtr
+    return evaluate_logical_expr(std::get<8>(expr));
+  case 9: // AST::ExprCallPtr
+    return evaluate_call_expr(std::get<9>(expr));
+  case 10: // AST::ExprFunctionPtr
+    return evaluate_function_expr(std::get<10>(expr));
+  case 11: // AST::ExprGetPtr
+    return evaluate_get_expr(std::get<11>(expr));
+  case 12: // AST::ExprSetPtr
+    return evaluate_set_expr(std::get<12>(expr));
+  case 13: // AST::ExprThisPtr
+    return evaluate_this_expr(std::get<13>(expr));
+  case 14: // AST::ExprSuperPtr
+    return evaluate_super_expr(std::get<14>(expr));
+  case 15: // AST::ExprListPtr
+    return evaluate_list_expr(std::get<15>(expr));
+  case 16: // AST::ExprIndexPtr
+    return evaluate_index_expr(std::get<16>(expr));
+  case 17: // AST::ExprIndexSetPtr
+    return evaluate_index_set_expr(std::get<17>(expr));
+  case 18: // AST::ExprSlicePtr
+    return evaluate_slice_expr(std::get<18>(expr));
+  case 19: // AST::ExprMapPtr
+    return evaluate_map_expr(std::get<19>(expr));
+  case 20: // AST::ExprSpawnPtr
+    return evaluate_spawn_expr(std::get<20>(expr));
+  case 21: // AST::ExprAwaitPtr
+    return evaluate_await_expr(std::get<21>(expr));
+  default:
+    static_assert(std::variant_size_v<AST::ExprPtrVariant> == 22,
+                  "Looks like you forgot to update the cases in "
+                  "Evaluator::Evaluate(const ExptrVariant&)!");
+    return BoopObject(nullptr);
+  }
+}
+
+//==============================//
+// Statement Evaluation Methods //
+//==============================//
+auto Evaluator::evaluate_expr_stmt(const AST::ExprStmtPtr &stmt)
+    -> StmtResult {
+  RETURN_IF_ERROR(evaluate_expr(stmt->expression).status);
+
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_print_stmt(const AST::PrintStmtPtr &stmt)
+    -> StmtResult {
+  ASSIGN_OR_RETURN(BoopObject obj_to_print, evaluate_expr(stmt->expression));
+  m_output.write("> ");
+  // strings and numbers go straight into the output buffer
+  if (const auto *str = std::get_if<BoopString>(&obj_to_print))
+    m_output.write(str->str());
+  else if (const auto *number = std::get_if<double>(&obj_to_print))
+    m_output.write_number(*number);
+  else if (const auto *integer = std::get_if<int64_t>(&obj_to_print))
+    m_output.write_number(*integer);
+  else
+    m_output.write(get_object_string(obj_to_print));
+  m_output.end_line();
+
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_block_stmt(const AST::BlockStmtPtr &stmt)
+    -> StmtResult {
+
+  // the block's locals already have slots in the running frame; all there is
+  // to do on exit is to close the upvalues capturing them, so every pass
+  // through a loop body gets fresh bindings, and drop the values they hold
+  const Completion completion = evaluate_stmts(stmt->statements);
+
+  m_env_manager.close_slots(stmt->local_begin, stmt->local_end);
+  return completion;
+}
+
+auto Evaluator::evaluate_var_stmt(const AST::VarStmtPtr &stmt)
+    -> StmtResult {
+  if (stmt->initializer.has_value()) {
+    ASSIGN_OR_RETURN(BoopObject value,
+                     evaluate_expr(stmt->initializer.value()));
+    m_env_manager.define(stmt->var_name, stmt->resolved, std::move(value));
+  } else {
+    m_env_manager.define(stmt->var_name, stmt->resolved, BoopObject(nullptr));
+  }
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_if_stmt(const AST::IfStmtPtr &stmt)
+    -> StmtResult {
+  ASSIGN_OR_RETURN(BoopObject condition, evaluate_expr(stmt->condition));
+  if (is_true(condition))
+    return evaluate_stmt(stmt->then_branch);
+  if (stmt->else_branch.has_value())
+    return evaluate_stmt(stmt->else_branch.value());
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_while_stmt(const AST::WhileStmtPtr &stmt)
+    -> StmtResult {
+  while (true) {
+    ASSIGN_OR_RETURN(BoopObject condition, evaluate_expr(stmt->condition));
+    if (!is_true(condition))
+      break;
+    ASSIGN_OR_RETURN(Completion completion, evaluate_stmt(stmt->loop_body));
+    if (completion == Completion::BREAK)
+      break;
+    if (completion == Completion::RETURN ||
+        completion == Completion::TAIL_CALL)
+      return completion;
+  }
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_for_stmt(const AST::ForStmtPtr &stmt)
+    -> StmtResult {
+  if (stmt->initializer.has_value())
+    RETURN_IF_ERROR(evaluate_stmt(stmt->initializer.value()).status);
+  while (true) {
+    if (stmt->condition.has_value()) {
+      ASSIGN_OR_RETURN(BoopObject condition,
+                       evaluate_expr(stmt->condition.value()));
+      if (!is_true(condition))
+        break;
+    }
+    ASSIGN_OR_RETURN(Completion completion, evaluate_stmt(stmt->loop_body));
+    if (completion == Completion::BREAK)
+      break;
+    if (completion == Completion::RETURN ||
+        completion == Completion::TAIL_CALL)
+      return completion;
+    // a CONTINUE still runs the increment
+    if (stmt->increment.has_value())
+      RETURN_IF_ERROR(evaluate_expr(stmt->increment.value()).status);
+  }
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_function_stmt(const AST::FuncStmtPtr &stmt)
+    -> StmtResult {
+  // The function captures only the variables the Resolver found it using.
+  std::vector<UpvaluePtr> upvalues =
+      m_env_manager.capture(stmt->ExprFunction->upvalues);
+  // Create a Functor for the function, and hand it off to environment to store
+  m_env_manager.define(stmt->function_name, stmt->resolved,
+                       std::make_shared<Functor>(*m_program, stmt->ExprFunction,
+                                                 stmt->function_name.get_lexeme(),
+                                                 std::move(upvalues)));
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_return_stmt(const AST::RetStmtPtr &stmt)
+    -> StmtResult {
+  // a bare `return;` still completes with RETURN, leaving nil in the slot
+  if (stmt->value.has_value()) {
+    const AST::ExprPtrVariant &value = stmt->value.value();
+    if (std::holds_alternative<AST::ExprCallPtr>(value) &&
+        std::get<AST::ExprCallPtr>(value)->is_tail_call)
+      return evaluate_tail_call(std::get<AST::ExprCallPtr>(value));
+    ASSIGN_OR_RETURN(m_return_value, evaluate_expr(stmt->value.value()));
+  } else {
+    m_return_value = nullptr;
+  }
+  return Completion::RETURN;
+}
+
+auto Evaluator::evaluate_tail_call(const AST::ExprCallPtr &expr)
+    -> StmtResult {
+  ASSIGN_OR_RETURN(BoopObject callee, evaluate_expr(expr->callee));
+  // classes and builtins don't run on a frame of their own, so there is
+  // nothing to reuse
+  if (!std::holds_alternative<FunctionPtr>(callee)) {
+    ASSIGN_OR_RETURN(m_return_value, invoke(expr, std::move(callee)));
+    return Completion::RETURN;
+  }
+
+  // the arguments go above the running frame; the record is only filled in
+  // once they're evaluated since they may make tail calls of their own
+  const size_t args_begin = m_env_manager.stack_top();
+  FunctionPtr fun_obj = std::get<FunctionPtr>(std::move(callee));
+  RETURN_IF_ERROR(push_arguments(fun_obj, expr));
+  m_tail_call.function = std::move(fun_obj);
+  m_tail_call.paren = &expr->paren;
+  m_tail_call.args_begin = args_begin;
+  return Completion::TAIL_CALL;
+}
+
+auto Evaluator::evaluate_class_stmt(const AST::ClassStmtPtr &stmt)
+    -> StmtResult {
+  // Determine if this class has a super class or not;
+  std::optional<BoopClassPtr> superClass = std::nullopt;
+  if (stmt->superClass.has_value()) {
+    ASSIGN_OR_RETURN(BoopObject superclass_obj,
+                     evaluate_expr(stmt->superClass.value()));
+    if (!std::holds_alternative<BoopClassPtr>(superclass_obj))
+      return report_runtime_error(
+          m_error_handler, stmt->class_name,
+          "Superclass must be a class; Can't inherit from non-class");
+    superClass = std::get<BoopClassPtr>(superclass_obj);
+  }
+
+  // Define the class name in the current environment
+  m_env_manager.define(stmt->class_name, stmt->resolved, BoopObject(nullptr));
+
+  // If there is a super class, 'super' gets the slot the Resolver reserved for
+  // it in the running frame
+  if (superClass.has_value())
+    m_env_manager.define(stmt->class_name, stmt->super_resolved,
+                         superClass.value());
+
+  std::vector<std::pair<std::string, BoopObject>> methods;
+  for (const auto &stmt : stmt->methods) {
+    const auto &functionStmt = std::get<AST::FuncStmtPtr>(stmt);
+    bool isInitializer = functionStmt->function_name.get_lexeme() == "init";
+    BoopObject method = std::make_shared<Functor>(
+        *m_program, functionStmt->ExprFunction,
+        functionStmt->function_name.get_lexeme(),
+        m_env_manager.capture(functionStmt->ExprFunction->upvalues), true,
+        isInitializer);
+    methods.emplace_back(functionStmt->function_name.get_lexeme(), method);
+  }
+
+  // the scope holding 'super' ends with the class body
+  if (superClass.has_value())
+    m_env_manager.close_slots(stmt->super_resolved.index,
+                              stmt->super_resolved.index + 1);
+
+  // Declare the class
+  RETURN_IF_ERROR(m_env_manager.assign(
+      stmt->class_name, stmt->resolved,
+      std::make_shared<BoopClass>(stmt->class_name.get_lexeme(), superClass,
+                                  methods)));
+
+  return Completion::NORMAL;
+}
+
+auto Evaluator::evaluate_break_stmt(const AST::BreakStmtPtr & /*stmt*/)
+    -> StmtResult {
+  return Completion::BREAK;
+}
+
+auto Evaluator::evaluate_continue_stmt(const AST::ContinueStmtPtr & /*stmt*/)
+    -> StmtResult {
+  return Completion::CONTINUE;
+}
+
+auto Evaluator::evaluate_stmt(const AST::StmtPtrVariant &stmt)
+    -> StmtResult {
+  switch (stmt.index()) {
+  case 0: // AST::ExprStmtPtr
+    return evaluate_expr_stmt(std::get<0>(stmt));
+  case 1: // AST::PrintStmtPtr
+    return evaluate_print_stmt(std::get<1>(stmt));
+  case 2: // AST::BlockStmtPtr
+    return evaluate_block_stmt(std::get<2>(stmt));
+  case 3: // AST::VarStmtPtr
+    return evaluate_var_stmt(std::get<3>(stmt));
+  case 4: // AST::IfStmtPtr
+    return evaluate_if_stmt(std::get<4>(stmt));
+  case 5: // AST::WhileStmtPtr
+    return evaluate_while_stmt(std::get<5>(stmt));
+  case 6: // AST::ForStmtPtr
+    return evaluate_for_stmt(std::get<6>(stmt));
+  case 7: // AST::FuncStmtPtr
+    return evaluate_function_stmt(std::get<7>(stmt));
+  case 8: // AST::RetStmtPtr
+    return evaluate_return_stmt(std::get<8>(stmt));
+  case 9: // AST::ClassStmtPtr
+    return evaluate_class_stmt(std::get<9>(stmt));
+  case 10: // AST::BreakStmtPtr
+    return evaluate_break_stmt(std::get<10>(stmt));
+  case 11: // AST::ContinueStmtPtr
+    return evaluate_continue_stmt(std::get<11>(stmt));
+  default:
+    static_assert(std::variant_size_v<AST::StmtPtrVariant> == 12,
+                  "Looks like you forgot to update the cases in "
+                  "PrettyPrinter::toString(const StmtPtrVariant& statement)!");
+    return Completion::NORMAL;
+  }
+}
+
+auto Evaluator::evaluate_stmts(const std::vector<AST::StmtPtrVariant> &stmts)
+    -> Completion {
+  for (const AST::StmtPtrVariant &stmt : stmts) {
+    StmtResult stmt_result = evaluate_stmt(stmt);
+    if (EXPECT_FALSE(!stmt_result.ok())) {
+      // the error has already been reported; only too many of them is fatal
+      if (EXPECT_FALSE(++m_runtime_err_count > MAX_RUNTIME_ERR)) {
+        m_output.flush(); // keep the script's output ahead of the message
+        std::cerr << "Too many errors occurred. Exiting evaluation."
+                  << std::endl;
+        throw RuntimeError();
+      }
+      continue;
+    }
+    // RETURN, BREAK and CONTINUE all abandon the rest of the statements
+    if (stmt_result.value != Completion::NORMAL)
+      return stmt_result.value;
+  }
+  return Completion::NORMAL;
+}
+
 } // namespace boop
\ No newline at end of file
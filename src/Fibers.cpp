@@ -0,0 +1,520 @@
+#include "../include/Fibers.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Tasks.h"
+
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+struct FiberScheduler::Fiber : public Uncopyable {
+  enum class State { RUNNING, READY, PARKED, ENDED };
+
+  FiberScheduler &scheduler;
+  State state{State::READY};
+  FiberState saved; // while the fiber isn't running
+  ucontext_t context{};
+  void *stack{nullptr}; // the main fiber runs on the caller's stack
+  size_t index{};       // in FiberScheduler::m_fibers
+
+  // the call a fiber makes when it first runs
+  BoopObject callee{nullptr};
+  std::vector<BoopObject> args;
+  std::optional<Token> call_site;
+  FuturePtr result; // of an async call
+
+  bool deadlocked{false}; // woken because nothing else could wake it
+  bool cancelled{false};  // woken to be abandoned
+
+  explicit Fiber(FiberScheduler &_scheduler) : scheduler(_scheduler) {}
+  ~Fiber() {
+    // an abandoned fiber's frames were never popped; closures it created
+    // keep the values of its variables
+    for (const UpvaluePtr &upvalue : saved.stack.open_upvalues)
+      upvalue->close();
+    if (stack != nullptr)
+      munmap(stack, STACK_BYTES);
+  }
+};
+
+namespace {
+using Fiber = FiberScheduler::Fiber;
+using WaitList = std::vector<Fiber *>;
+
+// thrown out of `park` and `yield` into a fiber that's being abandoned, to
+// unwind its stack
+struct FiberCancelled {};
+
+// the scheduler switching fibers on this thread, for a fiber's first run
+thread_local FiberScheduler *t_switching = nullptr;
+// where `select` starts looking, so that no channel is always served first
+thread_local size_t t_select_turn = 0;
+
+/**
+ * @brief registers a fiber as waiting on channels for as long as it's in
+ * scope, which includes being unwound when the fiber is abandoned
+ *
+ */
+class Waiting : public Uncopyable {
+private:
+  Fiber *const m_fiber;
+  const std::vector<WaitList *> m_lists;
+
+public:
+  Waiting(Fiber *fiber, std::vector<WaitList *> lists)
+      : m_fiber(fiber), m_lists(std::move(lists)) {
+    for (WaitList *list : m_lists)
+      list->push_back(m_fiber);
+  }
+  ~Waiting() {
+    for (WaitList *list : m_lists) {
+      auto iter = std::find(list->begin(), list->end(), m_fiber);
+      if (iter != list->end())
+        list->erase(iter);
+    }
+  }
+};
+} // namespace
+
+FiberScheduler::FiberScheduler(Evaluator &evaluator, size_t max_call_depth)
+    : m_evaluator(evaluator), m_max_call_depth(max_call_depth),
+      m_main(std::make_unique<Fiber>(*this)), m_running(m_main.get()) {
+  m_main->state = Fiber::State::RUNNING;
+}
+
+// only ever destroyed by the main fiber
+FiberScheduler::~FiberScheduler() {
+  cancel_all();
+  if (m_epoll >= 0)
+    ::close(m_epoll);
+}
+
+auto FiberScheduler::go(ErrorHandler &error_handler, const Token &call_site,
+                        BoopObject callee, std::vector<BoopObject> args,
+                        FuturePtr result) -> Status {
+  auto fiber = std::make_unique<Fiber>(*this);
+  void *stack = mmap(nullptr, STACK_BYTES, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (EXPECT_FALSE(stack == MAP_FAILED))
+    return report_runtime_error(error_handler, call_site,
+                                "Can't start a fiber: out of memory.");
+  fiber->stack = stack;
+  // the stack grows down; overflowing it faults on the guard page rather
+  // than overwriting another mapping
+  mprotect(stack, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE);
+  if (EXPECT_FALSE(getcontext(&fiber->context) != 0))
+    return report_runtime_error(error_handler, call_site,
+                                "Can't start a fiber.");
+  fiber->context.uc_stack.ss_sp = stack;
+  fiber->context.uc_stack.ss_size = STACK_BYTES;
+  fiber->context.uc_link = nullptr; // `start` never returns
+  makecontext(&fiber->context, &FiberScheduler::start, 0);
+
+  fiber->saved = FiberState(STACK_SLOTS, m_max_call_depth);
+  fiber->callee = std::move(callee);
+  fiber->args = std::move(args);
+  fiber->call_site.emplace(call_site);
+  fiber->result = std::move(result);
+  fiber->index = m_fibers.size();
+  m_ready.push_back(fiber.get());
+  m_fibers.push_back(std::move(fiber));
+  return Status::OK;
+}
+
+auto FiberScheduler::running() const noexcept -> Fiber * { return m_running; }
+
+auto FiberScheduler::park(ErrorHandler &error_handler, const Token &site)
+    -> Status {
+  Fiber *self = m_running;
+  self->state = Fiber::State::PARKED;
+  switch_away();
+  resumed(self);
+  if (EXPECT_FALSE(self->deadlocked)) {
+    self->deadlocked = false;
+    return report_runtime_error(
+        error_handler, site, "Deadlock: every fiber is waiting for another.");
+  }
+  return Status::OK;
+}
+
+auto FiberScheduler::wake(Fiber *fiber) -> bool {
+  if (fiber->state != Fiber::State::PARKED)
+    return false;
+  fiber->state = Fiber::State::READY;
+  fiber->scheduler.m_ready.push_back(fiber);
+  return true;
+}
+
+auto FiberScheduler::yield() -> bool {
+  if (m_ready.empty())
+    return false;
+  Fiber *self = m_running;
+  self->state = Fiber::State::READY;
+  m_ready.push_back(self);
+  switch_away();
+  resumed(self);
+  return true;
+}
+
+auto FiberScheduler::await(ErrorHandler &error_handler, const Token &site,
+                           const BoopFuture &future) -> Status {
+  while (!future.is_done()) {
+    Waiting waiting{m_running, {&m_awaiting[&future]}};
+    RETURN_IF_ERROR(park(error_handler, site));
+  }
+  auto iter = m_awaiting.find(&future);
+  if (iter != m_awaiting.end() && iter->second.empty())
+    m_awaiting.erase(iter);
+  return Status::OK;
+}
+
+auto FiberScheduler::wait_io(ErrorHandler &error_handler, const Token &site,
+                             int fd, bool for_write) -> Status {
+  if (m_epoll < 0) {
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (EXPECT_FALSE(m_epoll < 0))
+      return report_runtime_error(error_handler, site,
+                                  std::string("Can't wait for I/O: ") +
+                                      std::strerror(errno) + ".");
+  }
+  IoWaiters &waiters = m_io[fd];
+  Fiber *&waiter = for_write ? waiters.writer : waiters.reader;
+  if (EXPECT_FALSE(waiter != nullptr))
+    return report_runtime_error(
+        error_handler, site,
+        for_write ? "Another fiber is already writing to this stream."
+                  : "Another fiber is already reading from this stream.");
+  waiter = m_running;
+  const int error = update_io(fd);
+  if (EXPECT_FALSE(error != 0)) {
+    waiter = nullptr;
+    update_io(fd);
+    return report_runtime_error(error_handler, site,
+                                std::string("Can't wait for I/O: ") +
+                                    std::strerror(error) + ".");
+  }
+
+  // stops waiting however the fiber comes back, unless `poll_io` or
+  // `forget_io` did that already
+  struct Unwatch {
+    FiberScheduler &scheduler;
+    Fiber *const self;
+    const int fd;
+    const bool for_write;
+
+    ~Unwatch() {
+      auto iter = scheduler.m_io.find(fd);
+      if (iter == scheduler.m_io.end())
+        return;
+      Fiber *&waiter =
+          for_write ? iter->second.writer : iter->second.reader;
+      if (waiter == self) {
+        waiter = nullptr;
+        scheduler.update_io(fd);
+      }
+    }
+  } unwatch{*this, m_running, fd, for_write};
+  return park(error_handler, site);
+}
+
+auto FiberScheduler::forget_io(int fd) -> void {
+  auto iter = m_io.find(fd);
+  if (iter == m_io.end())
+    return;
+  const IoWaiters waiters = iter->second;
+  if (waiters.registered)
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+  m_io.erase(iter);
+  if (waiters.reader != nullptr)
+    wake(waiters.reader);
+  if (waiters.writer != nullptr)
+    wake(waiters.writer);
+}
+
+auto FiberScheduler::finish() -> void {
+  while (!m_fibers.empty()) {
+    wait_for_io();
+    if (m_ready.empty()) {
+      // everyone left waits on a channel only they could still use
+      cancel_all();
+      break;
+    }
+    m_main->state = Fiber::State::READY;
+    m_ready.push_back(m_main.get());
+    switch_away();
+  }
+  if (m_failure != nullptr)
+    std::rethrow_exception(std::exchange(m_failure, nullptr));
+}
+
+auto FiberScheduler::switch_away() -> void {
+  Fiber *self = m_running;
+  Fiber *next = nullptr;
+  if (!m_io.empty()) {
+    // fibers waiting on I/O get their turn even if others never block
+    if (m_ready.empty())
+      wait_for_io();
+    else
+      poll_io(0);
+  }
+  if (m_ready.empty()) {
+    // The main fiber is neither running nor ready, so it's parked (or it's
+    // the one switching away), and no fiber is left to wake it.
+    next = m_main.get();
+    next->deadlocked = true;
+  } else {
+    next = m_ready.front();
+    m_ready.pop_front();
+  }
+  if (next == self) {
+    self->state = Fiber::State::RUNNING;
+    return;
+  }
+  next->state = Fiber::State::RUNNING;
+  m_running = next;
+  m_evaluator.swap_fiber_state(self->saved);
+  m_evaluator.swap_fiber_state(next->saved);
+  t_switching = this;
+  swapcontext(&self->context, &next->context);
+  // switched back to `self`
+  reap();
+}
+
+auto FiberScheduler::resumed(Fiber *self) -> void {
+  if (self->cancelled)
+    throw FiberCancelled{};
+  if (self == m_main.get() && m_failure != nullptr)
+    std::rethrow_exception(std::exchange(m_failure, nullptr));
+}
+
+auto FiberScheduler::reap() -> void {
+  if (m_ended == nullptr)
+    return;
+  const size_t index = std::exchange(m_ended, nullptr)->index;
+  if (index + 1 != m_fibers.size()) {
+    std::swap(m_fibers[index], m_fibers.back());
+    m_fibers[index]->index = index;
+  }
+  m_fibers.pop_back();
+}
+
+auto FiberScheduler::settle(Fiber &fiber, bool ok, BoopObject value) -> void {
+  const FuturePtr future = std::move(fiber.result);
+  if (ok)
+    future->complete(std::move(value));
+  else
+    future->fail(fiber.cancelled ? "The async call was abandoned."
+                                 : "The async call failed.");
+  auto iter = m_awaiting.find(future.get());
+  if (iter == m_awaiting.end())
+    return;
+  for (Fiber *waiter : iter->second)
+    wake(waiter);
+}
+
+auto FiberScheduler::poll_io(int timeout) -> void {
+  std::array<epoll_event, 64> events;
+  const int count = epoll_wait(m_epoll, events.data(),
+                               static_cast<int>(events.size()), timeout);
+  for (int i = 0; i < count; ++i) {
+    const int fd = events[i].data.fd;
+    auto iter = m_io.find(fd);
+    if (iter == m_io.end())
+      continue;
+    IoWaiters &waiters = iter->second;
+    // errors and hang-ups wake both, for their next read or write to report
+    const uint32_t ready = events[i].events;
+    const uint32_t broken = EPOLLERR | EPOLLHUP;
+    if (waiters.reader != nullptr && (ready & (EPOLLIN | EPOLLRDHUP | broken)))
+      wake(std::exchange(waiters.reader, nullptr));
+    if (waiters.writer != nullptr && (ready & (EPOLLOUT | broken)))
+      wake(std::exchange(waiters.writer, nullptr));
+    update_io(fd);
+  }
+}
+
+auto FiberScheduler::wait_for_io() -> void {
+  if (m_ready.empty() && !m_io.empty())
+    m_evaluator.flush_output();
+  while (m_ready.empty() && !m_io.empty())
+    poll_io(-1);
+}
+
+auto FiberScheduler::update_io(int fd) -> int {
+  auto iter = m_io.find(fd);
+  IoWaiters &waiters = iter->second;
+  epoll_event event{};
+  event.events = (waiters.reader != nullptr ? EPOLLIN | EPOLLRDHUP : 0u) |
+                 (waiters.writer != nullptr ? EPOLLOUT : 0u);
+  event.data.fd = fd;
+  if (event.events == 0) {
+    if (waiters.registered)
+      epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    m_io.erase(iter);
+    return 0;
+  }
+  const int op = waiters.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (EXPECT_FALSE(epoll_ctl(m_epoll, op, fd, &event) != 0))
+    return errno;
+  waiters.registered = true;
+  return 0;
+}
+
+auto FiberScheduler::cancel_all() -> void {
+  for (const auto &fiber : m_fibers) {
+    fiber->cancelled = true;
+    wake(fiber.get());
+  }
+  // each of them unwinds as soon as it runs
+  while (!m_fibers.empty()) {
+    m_main->state = Fiber::State::READY;
+    m_ready.push_back(m_main.get());
+    switch_away();
+  }
+}
+
+auto FiberScheduler::start() -> void {
+  FiberScheduler &scheduler = *t_switching;
+  Fiber *self = scheduler.m_running;
+  scheduler.reap();
+  bool ok = false;
+  BoopObject value{nullptr};
+  if (!self->cancelled) {
+    try {
+      // errors were reported as they happened
+      auto result = scheduler.m_evaluator.call_value(
+          self->callee, ArgSpan(self->args.data(), self->args.size()),
+          *self->call_site);
+      ok = result.ok();
+      value = std::move(result.value);
+    } catch (const FiberCancelled &) {
+      // abandoned
+    } catch (...) {
+      if (scheduler.m_failure == nullptr)
+        scheduler.m_failure = std::current_exception();
+    }
+  }
+  if (self->result != nullptr)
+    scheduler.settle(*self, ok, std::move(value));
+  self->callee = nullptr;
+  self->args.clear();
+  self->state = Fiber::State::ENDED;
+  scheduler.m_ended = self;
+  scheduler.switch_away(); // for good
+}
+
+// definitions of BoopChannel methods
+BoopChannel::BoopChannel(size_t capacity) : m_capacity(capacity) {}
+
+auto BoopChannel::capacity() const noexcept -> size_t { return m_capacity; }
+
+auto BoopChannel::size() const noexcept -> size_t { return m_buffer.size(); }
+
+auto BoopChannel::is_closed() const noexcept -> bool { return m_closed; }
+
+auto BoopChannel::send(FiberScheduler &fibers, ErrorHandler &error_handler,
+                       const Token &site, BoopObject value) -> Status {
+  while (true) {
+    if (EXPECT_FALSE(m_closed))
+      return report_runtime_error(error_handler, site,
+                                  "Can't send on a closed channel.");
+    if (m_buffer.size() < m_capacity) {
+      m_buffer.push_back(std::move(value));
+      wake_one(m_receivers);
+      return Status::OK;
+    }
+    Waiting waiting{fibers.running(), {&m_senders}};
+    RETURN_IF_ERROR(fibers.park(error_handler, site));
+  }
+}
+
+auto BoopChannel::recv(FiberScheduler &fibers, ErrorHandler &error_handler,
+                       const Token &site) -> Result<BoopObject> {
+  while (true) {
+    if (!m_buffer.empty())
+      return take();
+    if (m_closed)
+      return BoopObject(nullptr);
+    Waiting waiting{fibers.running(), {&m_receivers}};
+    RETURN_IF_ERROR(fibers.park(error_handler, site));
+  }
+}
+
+auto BoopChannel::close() -> void {
+  m_closed = true;
+  // they all find out, whatever they were waiting for
+  for (Fiber *fiber : m_receivers)
+    FiberScheduler::wake(fiber);
+  for (Fiber *fiber : m_senders)
+    FiberScheduler::wake(fiber);
+}
+
+auto BoopChannel::select(FiberScheduler &fibers, ErrorHandler &error_handler,
+                         const Token &site,
+                         const std::vector<ChannelPtr> &channels,
+                         size_t &which) -> Result<BoopObject> {
+  const size_t count = channels.size();
+  while (true) {
+    const size_t turn = t_select_turn++;
+    bool any_open = false;
+    for (size_t i = 0; i < count; ++i) {
+      const size_t index = (turn + i) % count;
+      BoopChannel &channel = *channels[index];
+      if (!channel.m_buffer.empty()) {
+        which = index;
+        BoopObject value = channel.take();
+        // this fiber may have been woken for a value it left in another
+        // channel, which another receiver then has to be woken for
+        for (const ChannelPtr &other : channels)
+          if (!other->m_buffer.empty())
+            wake_one(other->m_receivers);
+        return value;
+      }
+      any_open = any_open || !channel.m_closed;
+    }
+    if (!any_open) {
+      which = count;
+      return BoopObject(nullptr);
+    }
+
+    std::vector<WaitList *> lists;
+    lists.reserve(count);
+    for (const ChannelPtr &channel : channels)
+      lists.push_back(&channel->m_receivers);
+    Waiting waiting{fibers.running(), std::move(lists)};
+    RETURN_IF_ERROR(fibers.park(error_handler, site));
+  }
+}
+
+auto BoopChannel::take() -> BoopObject {
+  BoopObject value = std::move(m_buffer.front());
+  m_buffer.pop_front();
+  wake_one(m_senders);
+  return value;
+}
+
+auto BoopChannel::wake_one(std::vector<FiberScheduler::Fiber *> &waiting)
+    -> void {
+  for (Fiber *fiber : waiting)
+    if (FiberScheduler::wake(fiber))
+      return;
+}
+
+} // namespace boop
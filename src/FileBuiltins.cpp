@@ -0,0 +1,78 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/FileReader.h"
+#include "../include/Native.h"
+#include "../include/Streams.h"
+#include "../include/Types.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto get_path(NativeContext &context, const std::string &name,
+              const BoopObject &arg) -> Result<const std::string *> {
+  const auto *path = std::get_if<BoopString>(&arg);
+  if (EXPECT_FALSE(path == nullptr))
+    return context.error("Argument 1 of " + name + " must be a string.");
+  return &path->str();
+}
+
+struct Lines final : public BuiltinFunction {
+  Lines() : BuiltinFunction("lines", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_path(context, get_name(), args[0]));
+    ASSIGN_OR_RETURN(StreamPtr stream,
+                     BoopStream::map(context.error_handler, context.call_site,
+                                     *path));
+    return BoopObject(std::move(stream));
+  }
+};
+
+struct ReadAll final : public BuiltinFunction {
+  ReadAll() : BuiltinFunction("read_all", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_path(context, get_name(), args[0]));
+    FileReader reader{*path};
+    if (EXPECT_FALSE(!reader.is_open()))
+      return context.error("Can't read " + *path + ".");
+    return BoopObject(BoopString(reader.content()));
+  }
+};
+
+struct WriteAll final : public BuiltinFunction {
+  WriteAll() : BuiltinFunction("write_all", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_path(context, get_name(), args[0]));
+    const auto *data = std::get_if<BoopString>(&args[1]);
+    if (EXPECT_FALSE(data == nullptr))
+      return context.error("Argument 2 of write_all must be a string.");
+    if (EXPECT_FALSE(!FileReader::write(*path, data->str())))
+      return context.error("Can't write " + *path + ".");
+    return BoopObject(nullptr);
+  }
+};
+} // namespace
+
+auto define_file_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<Lines>());
+  evaluator.define_native(std::make_shared<ReadAll>());
+  evaluator.define_native(std::make_shared<WriteAll>());
+}
+
+} // namespace boop
@@ -1,12 +1,37 @@
-#include "../include/FileReader.h"
-
-FileReader::FileReader(std::string_view fname) {
-  m_handler.open(static_cast<std::string>(fname), std::fstream::in);
-}
-
-FileReader::~FileReader(void) { m_handler.close(); }
-
-auto FileReader::content(void) -> std::string {
-  return {std::istreambuf_iterator<char>(m_handler),
-          std::istreambuf_iterator<char>()};
+#include "../include/FileReader.h"
+
+#include <iterator>
+
+FileReader::FileReader(std::string_view fname) {
+  m_handler.open(static_cast<std::string>(fname), std::fstream::in);
+}
+
+FileReader::~FileReader(void) { m_handler.close(); }
+
+auto FileReader::is_open(void) const -> bool { return m_handler.is_open(); }
+
+auto FileReader::content(void) -> std::string {
+  // a file that can be sized is read in one go
+  m_handler.seekg(0, std::ios::end);
+  const std::streamoff size = m_handler.tellg();
+  if (size < 0) {
+    m_handler.clear();
+    return {std::istreambuf_iterator<char>(m_handler),
+            std::istreambuf_iterator<char>()};
+  }
+  m_handler.seekg(0, std::ios::beg);
+  std::string text(static_cast<size_t>(size), '\0');
+  m_handler.read(text.data(), size);
+  text.resize(static_cast<size_t>(m_handler.gcount()));
+  return text;
+}
+
+auto FileReader::write(std::string_view fname, std::string_view data)
+    -> bool {
+  std::fstream out(static_cast<std::string>(fname),
+                   std::fstream::out | std::fstream::trunc |
+                       std::fstream::binary);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  out.close();
+  return !out.fail();
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "../include/Isolate.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Program.h"
+#include "../include/ThreadPool.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace boop {
+
+Isolate::Isolate(EvaluatorOptions options)
+    : m_evaluator(m_error_handler, options) {}
+
+auto Isolate::run(std::string_view source) -> bool {
+  const ProgramPtr program = compile(source);
+  return program != nullptr && run(program);
+}
+
+auto Isolate::run(const ProgramPtr &program) -> bool {
+  m_error_handler.clear();
+  try {
+    m_evaluator.run(program);
+  } catch (const RuntimeError &) {
+    // too many errors; they have all been added already
+  }
+  return !m_error_handler.has_found_error;
+}
+
+auto Isolate::compile(std::string_view source) -> ProgramPtr {
+  m_error_handler.clear();
+  return Program::compile(std::string(source), m_error_handler);
+}
+
+auto Isolate::call(const std::string &name, ArgSpan args)
+    -> std::optional<BoopObject> {
+  m_error_handler.clear();
+  try {
+    EvalResult result = m_evaluator.call(name, args);
+    if (result.ok())
+      return std::move(result.value);
+  } catch (const RuntimeError &) {
+    // too many errors; they have all been added already
+  }
+  return std::nullopt;
+}
+
+auto Isolate::define_native(BuiltinFunctionPtr native) -> void {
+  m_evaluator.define_native(std::move(native));
+}
+
+auto Isolate::define_global(const std::string &name, BoopObject value)
+    -> void {
+  m_evaluator.define_global(name, std::move(value));
+}
+
+auto Isolate::get_errors() const noexcept -> const std::vector<std::string> & {
+  return m_error_handler.get_errors();
+}
+
+namespace {
+// runs `job(isolate, i)` in a fresh isolate for every i below `count`
+template <typename Job>
+auto run_each(ThreadPool &pool, size_t count, const EvaluatorOptions &options,
+              const Job &job) -> std::vector<ScriptResult> {
+  EvaluatorOptions isolate_options = options;
+  // a dedicated stack would mean starting another thread for every script
+  if (pool.stack_bytes() >= options.native_stack_bytes())
+    isolate_options.dedicated_stack = false;
+
+  std::vector<ScriptResult> results(count);
+  // the pool may be running other work too, so this waits for its own tasks
+  // rather than for the pool to go idle
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t remaining = count;
+  for (size_t i = 0; i < count; ++i) {
+    pool.submit([&, i] {
+      ScriptResult &result = results[i];
+      try {
+        Isolate isolate{isolate_options};
+        result.ok = job(isolate, i);
+        result.errors = isolate.get_errors();
+      } catch (const std::exception &e) {
+        result.ok = false;
+        result.errors.emplace_back(std::string("Error: ") + e.what());
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--remaining == 0)
+        finished.notify_all();
+    });
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&remaining] { return remaining == 0; });
+  return results;
+}
+} // namespace
+
+auto run_isolates(ThreadPool &pool, const std::vector<std::string> &sources,
+                  const EvaluatorOptions &options)
+    -> std::vector<ScriptResult> {
+  return run_each(pool, sources.size(), options,
+                  [&sources](Isolate &isolate, size_t i) -> bool {
+                    return isolate.run(sources[i]);
+                  });
+}
+
+auto run_isolates(ThreadPool &pool, const std::vector<ProgramPtr> &programs,
+                  const EvaluatorOptions &options)
+    -> std::vector<ScriptResult> {
+  return run_each(pool, programs.size(), options,
+                  [&programs](Isolate &isolate, size_t i) -> bool {
+                    return isolate.run(programs[i]);
+                  });
+}
+
+} // namespace boop
@@ -0,0 +1,616 @@
+#include "../include/Json.h"
+#include "../include/BoopMap.h"
+#include "../include/ErrorHandler.h"
+#include "../include/JsonIndex.h"
+#include "../include/Types.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+// the first byte from `from` on that a JSON string can't hold as is: a
+// quote, a backslash or a control character; text.size() if there's none
+auto find_special(std::string_view text, size_t from) noexcept -> size_t {
+  size_t i = from;
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control_max = _mm_set1_epi8(0x1f);
+  for (; i + 16 <= text.size(); i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+    // unsigned bytes <= 0x1f are those max(byte, 0x1f) leaves at 0x1f
+    const __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                     _mm_cmpeq_epi8(bytes, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(bytes, control_max), control_max));
+    const int found = _mm_movemask_epi8(special);
+    if (found != 0)
+      return i + static_cast<size_t>(__builtin_ctz(found));
+  }
+#endif
+  for (; i < text.size(); ++i) {
+    const auto c = static_cast<unsigned char>(text[i]);
+    if (c < 0x20 || c == '"' || c == '\\')
+      return i;
+  }
+  return text.size();
+}
+
+auto append_utf8(std::string &out, uint32_t code_point) -> void {
+  if (code_point < 0x80) {
+    out.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    out.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+/**
+ * @brief stage 2: builds the value out of the tokens stage 1 indexed. Arrays
+ * and objects are kept on a stack of their own rather than recursed into, so
+ * deep nesting can't overflow the native stack.
+ *
+ */
+class JsonParser : public Uncopyable {
+private:
+  // an array or object still being parsed
+  struct Frame {
+    BoopListPtr list;
+    BoopMapPtr map;
+    BoopObject key{nullptr}; // of the value being parsed into `map`
+  };
+
+  const std::string_view m_text;
+  std::vector<uint32_t> m_index;
+  size_t m_next{0}; // into m_index
+  std::string m_error;
+  size_t m_error_at{0};
+
+public:
+  explicit JsonParser(std::string_view text) : m_text(text) {}
+
+  auto parse(BoopObject &result) -> bool;
+  auto error() const noexcept -> const std::string & { return m_error; }
+  auto error_offset() const noexcept -> size_t { return m_error_at; }
+
+private:
+  auto fail(size_t offset, std::string message) -> bool;
+  // the offset of the next token; false once there are none left
+  auto next_token(size_t &offset) -> bool;
+  auto peek() const noexcept -> char;
+  auto is_token_end(size_t offset) const noexcept -> bool;
+  // a string key followed by ':'
+  auto parse_key(BoopObject &key) -> bool;
+  auto parse_scalar(size_t offset, BoopObject &value) -> bool;
+  auto parse_string(size_t offset, BoopObject &value) -> bool;
+  auto parse_escape(std::string_view content, size_t &i, size_t offset,
+                    std::string &out) -> bool;
+  auto parse_literal(size_t offset, std::string_view literal) -> bool;
+  auto parse_number(size_t offset, BoopObject &value) -> bool;
+};
+
+auto JsonParser::parse(BoopObject &result) -> bool {
+  if (EXPECT_FALSE(m_text.size() > UINT32_MAX))
+    return fail(0, "The text is longer than 4 GiB.");
+  // most tokens take more than a few bytes
+  m_index.reserve(m_text.size() / 4 + 1);
+  if (EXPECT_FALSE(!json::index_tokens(m_text, m_index)))
+    return fail(m_text.size(), "Unterminated string.");
+
+  std::vector<Frame> frames;
+  BoopObject value{nullptr};
+  while (true) {
+    size_t offset;
+    if (EXPECT_FALSE(!next_token(offset)))
+      return fail(m_text.size(), "Expected a value.");
+    const char c = m_text[offset];
+    if (c == '[' || c == '{') {
+      if (EXPECT_FALSE(frames.size() == JSON_MAX_DEPTH))
+        return fail(offset, "Arrays and objects are nested too deeply.");
+      const bool is_list = c == '[';
+      if (peek() == (is_list ? ']' : '}')) {
+        ++m_next;
+        value = is_list ? BoopObject(std::make_shared<BoopList>())
+                        : BoopObject(std::make_shared<BoopMap>());
+      } else {
+        Frame frame;
+        if (is_list)
+          frame.list = std::make_shared<BoopList>();
+        else
+          frame.map = std::make_shared<BoopMap>();
+        frames.push_back(std::move(frame));
+        if (!is_list && !parse_key(frames.back().key))
+          return false;
+        continue;
+      }
+    } else if (!parse_scalar(offset, value)) {
+      return false;
+    }
+
+    // `value` is complete: add it to its array or object, and close every
+    // one it completes in turn
+    while (true) {
+      if (frames.empty()) {
+        if (EXPECT_FALSE(m_next != m_index.size()))
+          return fail(m_index[m_next], "Unexpected text after the value.");
+        result = std::move(value);
+        return true;
+      }
+      Frame &frame = frames.back();
+      if (frame.list != nullptr)
+        frame.list->elements.push_back(std::move(value));
+      else
+        frame.map->set(frame.key, std::move(value));
+      size_t separator;
+      if (EXPECT_FALSE(!next_token(separator)))
+        return fail(m_text.size(), frame.list != nullptr
+                                       ? "Unterminated array."
+                                       : "Unterminated object.");
+      if (m_text[separator] == ',') {
+        if (frame.map != nullptr && !parse_key(frame.key))
+          return false;
+        break;
+      }
+      if (frame.list != nullptr) {
+        if (EXPECT_FALSE(m_text[separator] != ']'))
+          return fail(separator, "Expected ',' or ']'.");
+        value = BoopObject(std::move(frame.list));
+      } else {
+        if (EXPECT_FALSE(m_text[separator] != '}'))
+          return fail(separator, "Expected ',' or '}'.");
+        value = BoopObject(std::move(frame.map));
+      }
+      frames.pop_back();
+    }
+  }
+}
+
+auto JsonParser::fail(size_t offset, std::string message) -> bool {
+  m_error = std::move(message);
+  m_error_at = offset;
+  return false;
+}
+
+auto JsonParser::next_token(size_t &offset) -> bool {
+  if (m_next == m_index.size())
+    return false;
+  offset = m_index[m_next++];
+  return true;
+}
+
+auto JsonParser::peek() const noexcept -> char {
+  return m_next == m_index.size() ? '\0' : m_text[m_index[m_next]];
+}
+
+auto JsonParser::is_token_end(size_t offset) const noexcept -> bool {
+  if (offset == m_text.size())
+    return true;
+  switch (m_text[offset]) {
+  case ' ':
+  case '\t':
+  case '\n':
+  case '\r':
+  case ',':
+  case ':':
+  case ']':
+  case '}':
+  case '[':
+  case '{':
+    return true;
+  default:
+    return false;
+  }
+}
+
+auto JsonParser::parse_key(BoopObject &key) -> bool {
+  size_t offset;
+  if (EXPECT_FALSE(!next_token(offset) || m_text[offset] != '"'))
+    return fail(m_next == 0 ? 0 : m_index[m_next - 1],
+                "Expected a string key.");
+  if (!parse_string(offset, key))
+    return false;
+  size_t colon;
+  if (EXPECT_FALSE(!next_token(colon) || m_text[colon] != ':'))
+    return fail(m_index[m_next - 1], "Expected ':' after a key.");
+  return true;
+}
+
+auto JsonParser::parse_scalar(size_t offset, BoopObject &value) -> bool {
+  switch (m_text[offset]) {
+  case '"':
+    return parse_string(offset, value);
+  case 't':
+    value = true;
+    return parse_literal(offset, "true");
+  case 'f':
+    value = false;
+    return parse_literal(offset, "false");
+  case 'n':
+    value = nullptr;
+    return parse_literal(offset, "null");
+  default:
+    return parse_number(offset, value);
+  }
+}
+
+auto JsonParser::parse_string(size_t offset, BoopObject &value) -> bool {
+  // stage 1 indexed the closing quote right after the opening one
+  const size_t close = m_index[m_next++];
+  const std::string_view content =
+      m_text.substr(offset + 1, close - offset - 1);
+  size_t special = find_special(content, 0);
+  if (EXPECT_TRUE(special == content.size())) {
+    value = BoopObject(BoopString(std::string(content)));
+    return true;
+  }
+  std::string text;
+  text.reserve(content.size());
+  size_t start = 0;
+  do {
+    text.append(content, start, special - start);
+    if (EXPECT_FALSE(content[special] != '\\'))
+      return fail(offset + 1 + special,
+                  "Control characters in strings must be escaped.");
+    if (!parse_escape(content, special, offset + 1, text))
+      return false;
+    start = special + 1;
+    special = find_special(content, start);
+  } while (special != content.size());
+  text.append(content, start);
+  value = BoopObject(BoopString(std::move(text)));
+  return true;
+}
+
+// appends what the escape sequence at content[i] stands for to `out`, and
+// moves `i` to its last byte
+auto JsonParser::parse_escape(std::string_view content, size_t &i,
+                              size_t offset, std::string &out) -> bool {
+  const auto read_hex = [&content](size_t at, uint32_t &code) {
+    if (at + 4 > content.size())
+      return false;
+    const char *begin = content.data() + at;
+    const auto [end, error] = std::from_chars(begin, begin + 4, code, 16);
+    return error == std::errc() && end == begin + 4;
+  };
+  // a backslash ending the contents would have escaped the closing quote
+  const char escaped = content[++i];
+  switch (escaped) {
+  case '"':
+  case '\\':
+  case '/':
+    out.push_back(escaped);
+    return true;
+  case 'b':
+    out.push_back('\b');
+    return true;
+  case 'f':
+    out.push_back('\f');
+    return true;
+  case 'n':
+    out.push_back('\n');
+    return true;
+  case 'r':
+    out.push_back('\r');
+    return true;
+  case 't':
+    out.push_back('\t');
+    return true;
+  case 'u':
+    break;
+  default:
+    return fail(offset + i - 1, "Invalid escape sequence.");
+  }
+  uint32_t code_point;
+  if (EXPECT_FALSE(!read_hex(i + 1, code_point)))
+    return fail(offset + i - 1, "Invalid \\u escape.");
+  i += 4;
+  if (code_point >= 0xdc00 && code_point <= 0xdfff)
+    return fail(offset + i - 5, "Unpaired surrogate in a \\u escape.");
+  if (code_point >= 0xd800 && code_point <= 0xdbff) {
+    // the high half of a surrogate pair; the low half must follow
+    uint32_t low;
+    if (EXPECT_FALSE(i + 2 >= content.size() || content[i + 1] != '\\' ||
+                     content[i + 2] != 'u' || !read_hex(i + 3, low) ||
+                     low < 0xdc00 || low > 0xdfff))
+      return fail(offset + i - 5, "Unpaired surrogate in a \\u escape.");
+    code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+    i += 6;
+  }
+  append_utf8(out, code_point);
+  return true;
+}
+
+auto JsonParser::parse_literal(size_t offset, std::string_view literal)
+    -> bool {
+  if (EXPECT_FALSE(m_text.compare(offset, literal.size(), literal) != 0 ||
+                   !is_token_end(offset + literal.size())))
+    return fail(offset, "Invalid value.");
+  return true;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+auto JsonParser::parse_number(size_t offset, BoopObject &value) -> bool {
+  const char *const begin = m_text.data() + offset;
+  const char *const end = m_text.data() + m_text.size();
+  const char *p = begin;
+  const auto is_digit = [&p, end] {
+    return p != end && *p >= '0' && *p <= '9';
+  };
+  const auto skip_digits = [&p, &is_digit] {
+    if (!is_digit())
+      return false;
+    while (is_digit())
+      ++p;
+    return true;
+  };
+
+  if (p != end && *p == '-')
+    ++p;
+  if (is_digit() && *p == '0')
+    ++p;
+  else if (!skip_digits())
+    return fail(offset, "Invalid value.");
+  bool is_integer = true;
+  if (p != end && *p == '.') {
+    ++p;
+    is_integer = false;
+    if (!skip_digits())
+      return fail(offset, "Invalid number.");
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    is_integer = false;
+    if (p != end && (*p == '+' || *p == '-'))
+      ++p;
+    if (!skip_digits())
+      return fail(offset, "Invalid number.");
+  }
+  if (EXPECT_FALSE(!is_token_end(static_cast<size_t>(p - m_text.data()))))
+    return fail(offset, "Invalid number.");
+
+  if (is_integer) {
+    int64_t integer;
+    if (std::from_chars(begin, p, integer).ec == std::errc()) {
+      value = integer;
+      return true;
+    }
+    // too big for an int64_t: a double instead
+  }
+  double number;
+  if (EXPECT_FALSE(std::from_chars(begin, p, number).ec != std::errc()))
+    return fail(offset, "The number is out of range.");
+  value = number;
+  return true;
+}
+
+/**
+ * @brief appends JSON to a single string, which only allocates when it has
+ * to grow; numbers are formatted on the stack and strings copied in runs
+ * between the bytes that need escaping.
+ *
+ */
+class JsonWriter : public Uncopyable {
+private:
+  ErrorHandler &m_error_handler;
+  const Token &m_site;
+  std::string &m_out;
+  // the lists and maps being written, innermost last
+  std::vector<const void *> m_open;
+
+public:
+  JsonWriter(ErrorHandler &error_handler, const Token &site, std::string &out)
+      : m_error_handler(error_handler), m_site(site), m_out(out) {}
+
+  auto write(const BoopObject &value) -> Status;
+
+private:
+  auto write_string(std::string_view text) -> void;
+  auto write_integer(int64_t value) -> void;
+  auto write_double(double value) -> Status;
+  auto write_list(const BoopList &list) -> Status;
+  auto write_map(const BoopMap &map) -> Status;
+  auto write_array(const Float64Array &array) -> Status;
+  auto enter(const void *container) -> Status;
+};
+
+auto JsonWriter::write(const BoopObject &value) -> Status {
+  switch (value.index()) {
+  case 0: // BoopString
+    write_string(std::get<BoopString>(value).str());
+    return Status::OK;
+  case 1: // double
+    return write_double(std::get<double>(value));
+  case 2: // bool
+    m_out += std::get<bool>(value) ? "true" : "false";
+    return Status::OK;
+  case 3: // nullptr
+    m_out += "null";
+    return Status::OK;
+  case 8: // int64_t
+    write_integer(std::get<int64_t>(value));
+    return Status::OK;
+  case 9: // BoopListPtr
+    return write_list(*std::get<BoopListPtr>(value));
+  case 10: // BoopMapPtr
+    return write_map(*std::get<BoopMapPtr>(value));
+  case 11: // Float64ArrayPtr
+    return write_array(*std::get<Float64ArrayPtr>(value));
+  case 4:  // FunctionPtr
+  case 5:  // BuiltinFunctionPtr
+  case 6:  // BoopClassPtr
+  case 7:  // BoopInstancePtr
+  case 12: // FuturePtr
+  case 13: // ChannelPtr
+  case 14: // PortPtr
+  case 15: // StreamPtr
+    return report_runtime_error(m_error_handler, m_site,
+                                "Can't write " + get_object_string(value) +
+                                    " as JSON.");
+  default:
+    static_assert(std::variant_size_v<BoopObject> == 16,
+                  "Looks like you forgot to update the cases in "
+                  "JsonWriter::write()!");
+    return Status::OK;
+  }
+}
+
+auto JsonWriter::write_string(std::string_view text) -> void {
+  static const char HEX[] = "0123456789abcdef";
+  m_out.push_back('"');
+  size_t start = 0;
+  for (size_t special = find_special(text, 0); special != text.size();
+       special = find_special(text, start)) {
+    m_out.append(text.data() + start, special - start);
+    const auto c = static_cast<unsigned char>(text[special]);
+    switch (c) {
+    case '"':
+      m_out += "\\\"";
+      break;
+    case '\\':
+      m_out += "\\\\";
+      break;
+    case '\n':
+      m_out += "\\n";
+      break;
+    case '\r':
+      m_out += "\\r";
+      break;
+    case '\t':
+      m_out += "\\t";
+      break;
+    default: {
+      const char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf]};
+      m_out.append(escape, sizeof(escape));
+      break;
+    }
+    }
+    start = special + 1;
+  }
+  m_out.append(text.data() + start, text.size() - start);
+  m_out.push_back('"');
+}
+
+auto JsonWriter::write_integer(int64_t value) -> void {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  m_out.append(buffer, result.ptr);
+}
+
+auto JsonWriter::write_double(double value) -> Status {
+  if (EXPECT_FALSE(!std::isfinite(value)))
+    return report_runtime_error(m_error_handler, m_site,
+                                "Can't write NaN or infinity as JSON.");
+  // the shortest form that reads back as the same double
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  m_out.append(buffer, result.ptr);
+  return Status::OK;
+}
+
+auto JsonWriter::write_list(const BoopList &list) -> Status {
+  RETURN_IF_ERROR(enter(&list));
+  m_out.push_back('[');
+  for (size_t i = 0; i < list.size(); ++i) {
+    if (i != 0)
+      m_out.push_back(',');
+    RETURN_IF_ERROR(write(list.elements[i]));
+  }
+  m_out.push_back(']');
+  m_open.pop_back();
+  return Status::OK;
+}
+
+auto JsonWriter::write_map(const BoopMap &map) -> Status {
+  RETURN_IF_ERROR(enter(&map));
+  m_out.push_back('{');
+  bool first = true;
+  for (const auto &entry : map.entries()) {
+    if (!entry.is_live())
+      continue;
+    if (!first)
+      m_out.push_back(',');
+    first = false;
+    if (const auto *key = std::get_if<BoopString>(&entry.key))
+      write_string(key->str());
+    else
+      write_string(get_object_string(entry.key));
+    m_out.push_back(':');
+    RETURN_IF_ERROR(write(entry.value));
+  }
+  m_out.push_back('}');
+  m_open.pop_back();
+  return Status::OK;
+}
+
+auto JsonWriter::write_array(const Float64Array &array) -> Status {
+  m_out.push_back('[');
+  for (size_t i = 0; i < array.size(); ++i) {
+    if (i != 0)
+      m_out.push_back(',');
+    RETURN_IF_ERROR(write_double(array.data[i]));
+  }
+  m_out.push_back(']');
+  return Status::OK;
+}
+
+auto JsonWriter::enter(const void *container) -> Status {
+  if (EXPECT_FALSE(std::find(m_open.begin(), m_open.end(), container) !=
+                   m_open.end()))
+    return report_runtime_error(m_error_handler, m_site,
+                                "Can't write a list or map that contains "
+                                "itself as JSON.");
+  if (EXPECT_FALSE(m_open.size() == JSON_MAX_DEPTH))
+    return report_runtime_error(m_error_handler, m_site,
+                                "Lists and maps are nested too deeply to "
+                                "write as JSON.");
+  m_open.push_back(container);
+  return Status::OK;
+}
+} // namespace
+
+auto parse_json(ErrorHandler &error_handler, const Token &site,
+                std::string_view text) -> Result<BoopObject> {
+  JsonParser parser{text};
+  BoopObject value{nullptr};
+  if (EXPECT_FALSE(!parser.parse(value)))
+    return report_runtime_error(error_handler, site,
+                                "Invalid JSON at byte " +
+                                    std::to_string(parser.error_offset()) +
+                                    ": " + parser.error());
+  return value;
+}
+
+auto write_json(ErrorHandler &error_handler, const Token &site,
+                const BoopObject &value, std::string &out) -> Status {
+  JsonWriter writer{error_handler, site, out};
+  return writer.write(value);
+}
+
+} // namespace boop
@@ -0,0 +1,48 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Json.h"
+#include "../include/Native.h"
+#include "../include/Types.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+struct JsonParse final : public BuiltinFunction {
+  JsonParse() : BuiltinFunction("json_parse", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    const auto *text = std::get_if<BoopString>(&args[0]);
+    if (EXPECT_FALSE(text == nullptr))
+      return context.error("Argument 1 of json_parse must be a string.");
+    return parse_json(context.error_handler, context.call_site, text->str());
+  }
+};
+
+struct JsonStringify final : public BuiltinFunction {
+  JsonStringify() : BuiltinFunction("json_stringify", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    std::string text;
+    RETURN_IF_ERROR(
+        write_json(context.error_handler, context.call_site, args[0], text));
+    return BoopObject(BoopString(std::move(text)));
+  }
+};
+} // namespace
+
+auto define_json_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<JsonParse>());
+  evaluator.define_native(std::make_shared<JsonStringify>());
+}
+
+} // namespace boop
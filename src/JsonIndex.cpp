@@ -0,0 +1,189 @@
+#include "../include/JsonIndex.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifdef BOOP_JSON_CLMUL
+#include <wmmintrin.h>
+#endif
+
+namespace boop::json {
+
+namespace {
+constexpr uint64_t EVEN_BITS = 0x5555555555555555ULL;
+constexpr uint64_t ODD_BITS = ~EVEN_BITS;
+} // namespace
+
+auto classify_portable(const char *block) noexcept -> BlockMasks {
+  BlockMasks masks;
+  for (size_t i = 0; i < BLOCK_BYTES; ++i) {
+    const uint64_t bit = uint64_t{1} << i;
+    switch (block[i]) {
+    case '"':
+      masks.quote |= bit;
+      break;
+    case '\\':
+      masks.backslash |= bit;
+      break;
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+      masks.op |= bit;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      masks.space |= bit;
+      break;
+    default:
+      break;
+    }
+  }
+  return masks;
+}
+
+#if defined(__SSE2__)
+auto classify_sse2(const char *block) noexcept -> BlockMasks {
+  BlockMasks masks;
+  for (size_t i = 0; i < BLOCK_BYTES; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+    const auto equals = [&bytes](char c) {
+      return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+    };
+    const auto bits = [i](__m128i matches) {
+      return static_cast<uint64_t>(
+                 static_cast<uint32_t>(_mm_movemask_epi8(matches)))
+             << i;
+    };
+    // '[' and ']' are '{' and '}' without bit 5
+    const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    const __m128i braces =
+        _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                     _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+    masks.quote |= bits(equals('"'));
+    masks.backslash |= bits(equals('\\'));
+    masks.op |= bits(
+        _mm_or_si128(braces, _mm_or_si128(equals(':'), equals(','))));
+    masks.space |= bits(_mm_or_si128(_mm_or_si128(equals(' '), equals('\t')),
+                                     _mm_or_si128(equals('\n'), equals('\r'))));
+  }
+  return masks;
+}
+#endif
+
+auto classify(const char *block) noexcept -> BlockMasks {
+#if defined(__SSE2__)
+  return classify_sse2(block);
+#else
+  return classify_portable(block);
+#endif
+}
+
+auto prefix_xor_portable(uint64_t bits) noexcept -> uint64_t {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+#ifdef BOOP_JSON_CLMUL
+__attribute__((target("pclmul"))) auto prefix_xor_clmul(uint64_t bits) noexcept
+    -> uint64_t {
+  // a carry-less multiplication by all ones does it in one instruction
+  const __m128i product = _mm_clmulepi64_si128(
+      _mm_set_epi64x(0, static_cast<int64_t>(bits)), _mm_set1_epi8(-1), 0);
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+}
+#endif
+
+auto prefix_xor(uint64_t bits) noexcept -> uint64_t {
+#if defined(__PCLMUL__) && defined(BOOP_JSON_CLMUL)
+  return prefix_xor_clmul(bits);
+#else
+  return prefix_xor_portable(bits);
+#endif
+}
+
+/**
+ * @brief runs of backslashes are told apart by where they start: adding the
+ * starts to the runs carries out of each run, into the byte after it, and
+ * the parity of that byte against the parity of the start gives the parity
+ * of the run's length
+ *
+ */
+auto find_escaped(uint64_t backslash, uint64_t &carry) noexcept -> uint64_t {
+  const uint64_t starts = backslash & ~(backslash << 1);
+  // a run carried over from the previous block flips the parity of its start
+  const uint64_t even_start_mask = EVEN_BITS ^ carry;
+  const uint64_t even_starts = starts & even_start_mask;
+  const uint64_t odd_starts = starts & ~even_start_mask;
+  const uint64_t even_carries = backslash + even_starts;
+  uint64_t odd_carries;
+  const bool ends_odd =
+      __builtin_add_overflow(backslash, odd_starts, &odd_carries);
+  odd_carries |= carry;
+  carry = ends_odd ? 1 : 0;
+  const uint64_t even_carry_ends = even_carries & ~backslash;
+  const uint64_t odd_carry_ends = odd_carries & ~backslash;
+  return (even_carry_ends & ODD_BITS) | (odd_carry_ends & EVEN_BITS);
+}
+
+auto index_tokens(std::string_view text, std::vector<uint32_t> &index)
+    -> bool {
+  uint64_t escape_carry = 0;
+  uint64_t string_carry = 0; // all ones while a string runs into a block
+  uint64_t scalar_carry = 0; // 1 if the last block ended in a scalar
+  char padded[BLOCK_BYTES];
+  for (size_t base = 0; base < text.size(); base += BLOCK_BYTES) {
+    const char *block = text.data() + base;
+    const size_t size = std::min(BLOCK_BYTES, text.size() - base);
+    if (size < BLOCK_BYTES) {
+      std::memset(padded, ' ', BLOCK_BYTES);
+      std::memcpy(padded, block, size);
+      block = padded;
+    }
+    const BlockMasks masks = classify(block);
+
+    const uint64_t quote =
+        masks.quote & ~find_escaped(masks.backslash, escape_carry);
+    const uint64_t in_string = prefix_xor(quote) ^ string_carry;
+    string_carry =
+        static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+    // the contents of every string and its closing quote
+    const uint64_t string_tail = in_string ^ quote;
+
+    // a scalar (a number, true, false or null) starts at any byte that
+    // isn't an operator or whitespace and doesn't follow one that isn't
+    // either, other than a quote
+    const uint64_t scalar = ~(masks.op | masks.space);
+    const uint64_t unquoted_scalar = scalar & ~quote;
+    const uint64_t follows_scalar = (unquoted_scalar << 1) | scalar_carry;
+    scalar_carry = unquoted_scalar >> 63;
+
+    uint64_t starts =
+        ((masks.op | (scalar & ~follows_scalar)) & ~string_tail) | quote;
+    while (starts != 0) {
+      index.push_back(static_cast<uint32_t>(
+          base + static_cast<size_t>(__builtin_ctzll(starts))));
+      starts &= starts - 1;
+    }
+  }
+  return string_carry == 0;
+}
+
+} // namespace boop::json
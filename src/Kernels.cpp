@@ -0,0 +1,499 @@
+#include "../include/Kernels.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BOOP_KERNELS_AVX2 1
+#include <immintrin.h>
+// compiles a single function for AVX2/FMA; it's only called after
+// has_avx2() said so
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop::kernels {
+
+namespace {
+// element-wise operations; `scalar` is the plain loop's version, `simd`
+// works on four doubles at a time
+struct Add {
+  static auto scalar(double x, double y) -> double { return x + y; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_add_pd(x, y);
+  }
+#endif
+};
+
+struct Sub {
+  static auto scalar(double x, double y) -> double { return x - y; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_sub_pd(x, y);
+  }
+#endif
+};
+
+struct RSub {
+  static auto scalar(double x, double y) -> double { return y - x; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_sub_pd(y, x);
+  }
+#endif
+};
+
+struct Mul {
+  static auto scalar(double x, double y) -> double { return x * y; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_mul_pd(x, y);
+  }
+#endif
+};
+
+struct Div {
+  static auto scalar(double x, double y) -> double { return x / y; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_div_pd(x, y);
+  }
+#endif
+};
+
+struct RDiv {
+  static auto scalar(double x, double y) -> double { return y / x; }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_div_pd(y, x);
+  }
+#endif
+};
+
+// NaN wins: the result is NaN if either operand is, on both paths
+struct Min {
+  static auto scalar(double x, double y) -> double {
+    return x < y || std::isnan(x) ? x : y;
+  }
+#ifdef BOOP_KERNELS_AVX2
+  // the instruction returns `y` when either is NaN, so a NaN `x` is put back
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_blendv_pd(_mm256_min_pd(x, y), x,
+                            _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+  }
+#endif
+};
+
+struct Max {
+  static auto scalar(double x, double y) -> double {
+    return x > y || std::isnan(x) ? x : y;
+  }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x, __m256d y) -> __m256d {
+    return _mm256_blendv_pd(_mm256_max_pd(x, y), x,
+                            _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+  }
+#endif
+};
+
+struct Sqrt {
+  static auto scalar(double x) -> double { return std::sqrt(x); }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x) -> __m256d {
+    return _mm256_sqrt_pd(x);
+  }
+#endif
+};
+
+struct Floor {
+  static auto scalar(double x) -> double { return std::floor(x); }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x) -> __m256d {
+    return _mm256_floor_pd(x);
+  }
+#endif
+};
+
+struct Ceil {
+  static auto scalar(double x) -> double { return std::ceil(x); }
+#ifdef BOOP_KERNELS_AVX2
+  AVX2_TARGET static auto simd(__m256d x) -> __m256d {
+    return _mm256_ceil_pd(x);
+  }
+#endif
+};
+
+struct Abs {
+  static auto scalar(double x) -> double { return std::fabs(x); }
+#ifdef BOOP_KERNELS_AVX2
+  // clears the sign bit
+  AVX2_TARGET static auto simd(__m256d x) -> __m256d {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+  }
+#endif
+};
+
+template <typename Op>
+auto unary_scalar(const double *a, double *out, size_t n) -> void {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = Op::scalar(a[i]);
+}
+
+template <typename Op>
+auto binary_scalar(const double *a, const double *b, double *out, size_t n)
+    -> void {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = Op::scalar(a[i], b[i]);
+}
+
+template <typename Op>
+auto broadcast_scalar(const double *a, double s, double *out, size_t n)
+    -> void {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = Op::scalar(a[i], s);
+}
+
+template <typename Op>
+auto extremum_scalar(const double *a, size_t n) -> double {
+  double result = a[0];
+  for (size_t i = 1; i < n; ++i)
+    result = Op::scalar(result, a[i]);
+  return result;
+}
+
+#ifdef BOOP_KERNELS_AVX2
+template <typename Op>
+AVX2_TARGET auto binary_avx2(const double *a, const double *b, double *out,
+                             size_t n) -> void {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, Op::simd(_mm256_loadu_pd(a + i),
+                                       _mm256_loadu_pd(b + i)));
+  for (; i < n; ++i)
+    out[i] = Op::scalar(a[i], b[i]);
+}
+
+template <typename Op>
+AVX2_TARGET auto broadcast_avx2(const double *a, double s, double *out,
+                                size_t n) -> void {
+  const __m256d y = _mm256_set1_pd(s);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, Op::simd(_mm256_loadu_pd(a + i), y));
+  for (; i < n; ++i)
+    out[i] = Op::scalar(a[i], s);
+}
+
+template <typename Op>
+AVX2_TARGET auto unary_avx2(const double *a, double *out, size_t n) -> void {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, Op::simd(_mm256_loadu_pd(a + i)));
+  for (; i < n; ++i)
+    out[i] = Op::scalar(a[i]);
+}
+
+AVX2_TARGET auto fma_avx2(const double *a, const double *b, const double *c,
+                          double *out, size_t n) -> void {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                                              _mm256_loadu_pd(b + i),
+                                              _mm256_loadu_pd(c + i)));
+  for (; i < n; ++i)
+    out[i] = __builtin_fma(a[i], b[i], c[i]);
+}
+
+// four independent accumulators of four lanes each, so consecutive FMAs
+// don't wait on each other
+AVX2_TARGET auto dot_avx2(const double *a, const double *b, size_t n)
+    -> double {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  __m256d acc2 = _mm256_setzero_pd();
+  __m256d acc3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                           acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4),
+                           _mm256_loadu_pd(b + i + 4), acc1);
+    acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8),
+                           _mm256_loadu_pd(b + i + 8), acc2);
+    acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12),
+                           _mm256_loadu_pd(b + i + 12), acc3);
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                           acc0);
+  const __m256d acc =
+      _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, acc);
+  double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; ++i)
+    result = __builtin_fma(a[i], b[i], result);
+  return result;
+}
+
+AVX2_TARGET auto sum_avx2(const double *a, size_t n) -> double {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  __m256d acc2 = _mm256_setzero_pd();
+  __m256d acc3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(a + i + 8));
+    acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(a + i + 12));
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+  const __m256d acc =
+      _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, acc);
+  double result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; ++i)
+    result += a[i];
+  return result;
+}
+
+// min or max of the n >= 1 elements, as `Op` picks
+template <typename Op>
+AVX2_TARGET auto extremum_avx2(const double *a, size_t n) -> double {
+  if (n < 4)
+    return extremum_scalar<Op>(a, n);
+  __m256d acc = _mm256_loadu_pd(a);
+  size_t i = 4;
+  for (; i + 4 <= n; i += 4)
+    acc = Op::simd(acc, _mm256_loadu_pd(a + i));
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, acc);
+  double result = extremum_scalar<Op>(lanes, 4);
+  for (; i < n; ++i)
+    result = Op::scalar(result, a[i]);
+  return result;
+}
+
+// in-register prefix sum of four lanes: two shifted adds, then the running
+// total of the previous blocks is added to all four
+AVX2_TARGET auto cumsum_avx2(const double *a, double *out, size_t n) -> void {
+  const __m256d zero = _mm256_setzero_pd();
+  __m256d carry = zero;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(a + i); // [a, b, c, d]
+    // [0, a, b, c]
+    x = _mm256_add_pd(
+        x, _mm256_blend_pd(_mm256_permute4x64_pd(x, 0x90), zero, 0x1));
+    // [0, 0, a, a + b]
+    x = _mm256_add_pd(
+        x, _mm256_blend_pd(_mm256_permute4x64_pd(x, 0x40), zero, 0x3));
+    x = _mm256_add_pd(x, carry);
+    _mm256_storeu_pd(out + i, x);
+    carry = _mm256_permute4x64_pd(x, 0xFF); // the last lane, broadcast
+  }
+  double total = n >= 4 ? out[i - 1] : 0.0;
+  for (; i < n; ++i) {
+    total += a[i];
+    out[i] = total;
+  }
+}
+#endif
+
+template <typename Op>
+auto unary(const double *a, double *out, size_t n) -> void {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return unary_avx2<Op>(a, out, n);
+#endif
+  unary_scalar<Op>(a, out, n);
+}
+
+template <typename Op>
+auto binary(const double *a, const double *b, double *out, size_t n) -> void {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return binary_avx2<Op>(a, b, out, n);
+#endif
+  binary_scalar<Op>(a, b, out, n);
+}
+
+template <typename Op>
+auto broadcast(const double *a, double s, double *out, size_t n) -> void {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return broadcast_avx2<Op>(a, s, out, n);
+#endif
+  broadcast_scalar<Op>(a, s, out, n);
+}
+} // namespace
+
+auto has_avx2() noexcept -> bool {
+#ifdef BOOP_KERNELS_AVX2
+  // BOOP_NO_AVX2 in the environment forces the plain loops, e.g. for
+  // checking them against the AVX2 versions on the same machine
+  static const bool supported = __builtin_cpu_supports("avx2") &&
+                                __builtin_cpu_supports("fma") &&
+                                std::getenv("BOOP_NO_AVX2") == nullptr;
+  return supported;
+#else
+  return false;
+#endif
+}
+
+auto add(const double *a, const double *b, double *out, size_t n) -> void {
+  binary<Add>(a, b, out, n);
+}
+
+auto sub(const double *a, const double *b, double *out, size_t n) -> void {
+  binary<Sub>(a, b, out, n);
+}
+
+auto mul(const double *a, const double *b, double *out, size_t n) -> void {
+  binary<Mul>(a, b, out, n);
+}
+
+auto div(const double *a, const double *b, double *out, size_t n) -> void {
+  binary<Div>(a, b, out, n);
+}
+
+auto add_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<Add>(a, s, out, n);
+}
+
+auto sub_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<Sub>(a, s, out, n);
+}
+
+auto rsub_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<RSub>(a, s, out, n);
+}
+
+auto mul_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<Mul>(a, s, out, n);
+}
+
+auto div_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<Div>(a, s, out, n);
+}
+
+auto rdiv_scalar(const double *a, double s, double *out, size_t n) -> void {
+  broadcast<RDiv>(a, s, out, n);
+}
+
+auto minimum(const double *a, const double *b, double *out, size_t n)
+    -> void {
+  binary<Min>(a, b, out, n);
+}
+
+auto maximum(const double *a, const double *b, double *out, size_t n)
+    -> void {
+  binary<Max>(a, b, out, n);
+}
+
+auto minimum_scalar(const double *a, double s, double *out, size_t n)
+    -> void {
+  broadcast<Min>(a, s, out, n);
+}
+
+auto maximum_scalar(const double *a, double s, double *out, size_t n)
+    -> void {
+  broadcast<Max>(a, s, out, n);
+}
+
+auto sqrt(const double *a, double *out, size_t n) -> void {
+  unary<Sqrt>(a, out, n);
+}
+
+auto floor(const double *a, double *out, size_t n) -> void {
+  unary<Floor>(a, out, n);
+}
+
+auto ceil(const double *a, double *out, size_t n) -> void {
+  unary<Ceil>(a, out, n);
+}
+
+auto abs(const double *a, double *out, size_t n) -> void {
+  unary<Abs>(a, out, n);
+}
+
+auto fma(const double *a, const double *b, const double *c, double *out,
+         size_t n) -> void {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return fma_avx2(a, b, c, out, n);
+#endif
+  // std::fma is emulated in software without hardware support
+  for (size_t i = 0; i < n; ++i)
+    out[i] = a[i] * b[i] + c[i];
+}
+
+auto dot(const double *a, const double *b, size_t n) -> double {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return dot_avx2(a, b, n);
+#endif
+  double acc[4] = {0.0, 0.0, 0.0, 0.0};
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    for (size_t lane = 0; lane < 4; ++lane)
+      acc[lane] += a[i + lane] * b[i + lane];
+  double result = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; i < n; ++i)
+    result += a[i] * b[i];
+  return result;
+}
+
+auto sum(const double *a, size_t n) -> double {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return sum_avx2(a, n);
+#endif
+  double acc[4] = {0.0, 0.0, 0.0, 0.0};
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    for (size_t lane = 0; lane < 4; ++lane)
+      acc[lane] += a[i + lane];
+  double result = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; i < n; ++i)
+    result += a[i];
+  return result;
+}
+
+auto min(const double *a, size_t n) -> double {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return extremum_avx2<Min>(a, n);
+#endif
+  return extremum_scalar<Min>(a, n);
+}
+
+auto max(const double *a, size_t n) -> double {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return extremum_avx2<Max>(a, n);
+#endif
+  return extremum_scalar<Max>(a, n);
+}
+
+auto cumsum(const double *a, double *out, size_t n) -> void {
+#ifdef BOOP_KERNELS_AVX2
+  if (EXPECT_TRUE(has_avx2()))
+    return cumsum_avx2(a, out, n);
+#endif
+  double total = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    total += a[i];
+    out[i] = total;
+  }
+}
+
+} // namespace boop::kernels
@@ -1,47 +1,55 @@
-#include "../include/ErrorHandler.h"
-#include "../include/FileReader.h"
-#include "../include/Scanner.h"
-#include "../include/Token.h"
-
-#include <iostream>
-#include <string>
-#include <vector>
-
-using std::cout;
-using std::string;
-using std::vector;
-
-
-namespace boop {
-
-auto run(std::string_view source) {
-  ErrorHandler error_handler{};
-  Scanner scanner{source, error_handler};
-  vector<Token> tokens = scanner.scan_and_get_tokens();
-
-  for (const auto i : tokens) {
-    cout << i.to_string() << '\n';
-  }
-}
-
-auto run_file(std::string_view c_str) -> void {
-  FileReader fr{c_str};
-  run(fr.content());
-}
-
-auto run_prompt() -> void {}
-
-}
-
-
-int main(void) {
-  // if(argc > 1)
-  //     exit(1);
-  // else if (argc == 1) {
-  //     run_file(argv[1]);
-  // } else {
-  //     run_prompt();
-  // }
-
-  // run_file("Sample.txt");
-}
\ No newline at end of file
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/FileReader.h"
+#include "../include/Program.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace boop {
+
+namespace {
+// exit codes, as in sysexits.h
+constexpr int EXIT_USAGE = 64;
+constexpr int EXIT_DATA_ERROR = 65;
+constexpr int EXIT_NO_INPUT = 66;
+constexpr int EXIT_SOFTWARE = 70;
+} // namespace
+
+// compiles and runs the script in `path`; returns the process's exit code
+auto run_file(std::string_view path) -> int {
+  FileReader reader{path};
+  if (!reader.is_open()) {
+    std::cerr << "Can't read " << path << ".\n";
+    return EXIT_NO_INPUT;
+  }
+  ErrorHandler error_handler{};
+  const ProgramPtr program = Program::compile(reader.content(), error_handler);
+  if (program == nullptr) {
+    error_handler.report();
+    return EXIT_DATA_ERROR;
+  }
+  Evaluator evaluator{error_handler};
+  try {
+    evaluator.run(program);
+  } catch (const RuntimeError &) {
+    // too many errors; they have all been added already
+  }
+  if (error_handler.has_found_error) {
+    error_handler.report();
+    return EXIT_SOFTWARE;
+  }
+  return 0;
+}
+
+} // namespace boop
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << (argc > 0 ? argv[0] : "LambdaPL")
+              << " <script>\n";
+    return boop::EXIT_USAGE;
+  }
+  return boop::run_file(argv[1]);
+}
@@ -0,0 +1,330 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Kernels.h"
+#include "../include/Native.h"
+#include "../include/Types.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+using ArrayArg = native::ArgTraits<Float64ArrayPtr>;
+using NumberArg = native::ArgTraits<double>;
+
+auto argument_error(NativeContext &context, size_t position,
+                    const std::string &name) -> Status {
+  return context.error("Argument " + std::to_string(position) + " of " +
+                       name + " must be a number or a Float64Array.");
+}
+
+/**
+ * @brief math function of one argument. Arrays go through `kernel` where
+ * there is a SIMD one and through a native loop over `scalar` otherwise.
+ * With `integral` set, an integer argument gives an integer result.
+ *
+ */
+struct UnaryMath final : public BuiltinFunction {
+  using Scalar = double (*)(double);
+  using Kernel = void (*)(const double *, double *, size_t);
+  using Integral = BoopObject (*)(int64_t);
+
+  const Scalar scalar;
+  const Kernel kernel;
+  const Integral integral;
+
+  UnaryMath(std::string name, Scalar _scalar, Kernel _kernel = nullptr,
+            Integral _integral = nullptr)
+      : BuiltinFunction(std::move(name), 1), scalar(_scalar),
+        kernel(_kernel), integral(_integral) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (integral != nullptr)
+      if (const auto *integer = std::get_if<int64_t>(&args[0]))
+        return integral(*integer);
+    if (NumberArg::matches(args[0]))
+      return BoopObject(scalar(NumberArg::get(args[0])));
+    if (EXPECT_FALSE(!ArrayArg::matches(args[0])))
+      return argument_error(context, 1, get_name());
+
+    const auto &array = ArrayArg::get(args[0]);
+    auto result = std::make_shared<Float64Array>(array->size());
+    if (kernel != nullptr) {
+      kernel(array->data.data(), result->data.data(), array->size());
+    } else {
+      for (size_t i = 0; i < array->size(); ++i)
+        result->data[i] = scalar(array->data[i]);
+    }
+    return BoopObject(std::move(result));
+  }
+};
+
+/**
+ * @brief math function of two arguments, each of which may be an array. Two
+ * arrays must have the same length; a number is paired with every element.
+ * `kernel` and `scalar_kernel` are only given for commutative functions.
+ *
+ */
+struct BinaryMath final : public BuiltinFunction {
+  using Scalar = double (*)(double, double);
+  using Kernel = void (*)(const double *, const double *, double *, size_t);
+  using ScalarKernel = void (*)(const double *, double, double *, size_t);
+  using Integral = BoopObject (*)(int64_t, int64_t);
+
+  const Scalar scalar;
+  const Kernel kernel;
+  const ScalarKernel scalar_kernel;
+  const Integral integral;
+
+  BinaryMath(std::string name, Scalar _scalar, Kernel _kernel = nullptr,
+             ScalarKernel _scalar_kernel = nullptr,
+             Integral _integral = nullptr)
+      : BuiltinFunction(std::move(name), 2), scalar(_scalar),
+        kernel(_kernel), scalar_kernel(_scalar_kernel),
+        integral(_integral) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    const BoopObject &x = args[0];
+    const BoopObject &y = args[1];
+    if (NumberArg::matches(x) && NumberArg::matches(y)) {
+      if (integral != nullptr && std::holds_alternative<int64_t>(x) &&
+          std::holds_alternative<int64_t>(y))
+        return integral(std::get<int64_t>(x), std::get<int64_t>(y));
+      return BoopObject(scalar(NumberArg::get(x), NumberArg::get(y)));
+    }
+    if (EXPECT_FALSE(!NumberArg::matches(x) && !ArrayArg::matches(x)))
+      return argument_error(context, 1, get_name());
+    if (EXPECT_FALSE(!NumberArg::matches(y) && !ArrayArg::matches(y)))
+      return argument_error(context, 2, get_name());
+
+    if (ArrayArg::matches(x) && ArrayArg::matches(y))
+      return both_arrays(context, ArrayArg::get(x), ArrayArg::get(y));
+
+    const bool array_first = ArrayArg::matches(x);
+    const auto &array = ArrayArg::get(array_first ? x : y);
+    const double number = NumberArg::get(array_first ? y : x);
+    auto result = std::make_shared<Float64Array>(array->size());
+    const double *a = array->data.data();
+    double *out = result->data.data();
+    if (scalar_kernel != nullptr) {
+      scalar_kernel(a, number, out, array->size());
+    } else if (array_first) {
+      for (size_t i = 0; i < array->size(); ++i)
+        out[i] = scalar(a[i], number);
+    } else {
+      for (size_t i = 0; i < array->size(); ++i)
+        out[i] = scalar(number, a[i]);
+    }
+    return BoopObject(std::move(result));
+  }
+
+private:
+  auto both_arrays(NativeContext &context, const Float64ArrayPtr &x,
+                   const Float64ArrayPtr &y) -> Result<BoopObject> {
+    if (EXPECT_FALSE(x->size() != y->size()))
+      return context.error("The arrays passed to " + get_name() +
+                           " differ in length.");
+    auto result = std::make_shared<Float64Array>(x->size());
+    if (kernel != nullptr) {
+      kernel(x->data.data(), y->data.data(), result->data.data(), x->size());
+    } else {
+      for (size_t i = 0; i < x->size(); ++i)
+        result->data[i] = scalar(x->data[i], y->data[i]);
+    }
+    return BoopObject(std::move(result));
+  }
+};
+
+auto integral_identity(int64_t value) -> BoopObject { return value; }
+
+// |INT64_MIN| doesn't fit, so it's promoted like an overflowing operation
+auto integral_abs(int64_t value) -> BoopObject {
+  if (EXPECT_FALSE(value == INT64_MIN))
+    return -static_cast<double>(value);
+  return value < 0 ? -value : value;
+}
+
+auto integral_min(int64_t x, int64_t y) -> BoopObject { return x < y ? x : y; }
+auto integral_max(int64_t x, int64_t y) -> BoopObject { return x > y ? x : y; }
+
+/**
+ * @brief xoshiro256** (Blackman and Vigna): 256 bits of state, a period of
+ * 2^256 - 1 and a handful of shifts and xors per number. Seeding goes through
+ * splitmix64 so that every seed, 0 included, gives a well-mixed state.
+ *
+ */
+class Xoshiro256 {
+private:
+  uint64_t m_state[4]{};
+
+  static auto rotl(uint64_t x, int k) -> uint64_t {
+    return (x << k) | (x >> (64 - k));
+  }
+
+public:
+  explicit Xoshiro256(uint64_t seed) { reseed(seed); }
+
+  auto reseed(uint64_t seed) -> void {
+    for (auto &word : m_state) {
+      seed += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  auto next() -> uint64_t {
+    const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+    const uint64_t t = m_state[1] << 17;
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+    return result;
+  }
+
+  // the top 53 bits scaled into [0, 1)
+  auto next_double() -> double {
+    return static_cast<double>(next() >> 11) * 0x1p-53;
+  }
+
+  // uniform in [0, range); a range of 0 stands for 2^64. Draws below
+  // `threshold` are rejected so that every remainder is equally likely.
+  auto next_below(uint64_t range) -> uint64_t {
+    if (range == 0)
+      return next();
+    const uint64_t threshold = (0 - range) % range;
+    uint64_t draw = next();
+    while (EXPECT_FALSE(draw < threshold))
+      draw = next();
+    return draw % range;
+  }
+};
+
+using GeneratorPtr = std::shared_ptr<Xoshiro256>;
+
+struct Random final : public BuiltinFunction {
+  const GeneratorPtr generator;
+
+  explicit Random(GeneratorPtr _generator)
+      : BuiltinFunction("random", VARIADIC), generator(std::move(_generator)) {
+  }
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (args.size() == 0)
+      return BoopObject(generator->next_double());
+    if (EXPECT_FALSE(args.size() > 1 ||
+                     !std::holds_alternative<int64_t>(args[0]) ||
+                     std::get<int64_t>(args[0]) < 0))
+      return context.error("random takes no argument or the length of the "
+                           "Float64Array to fill.");
+    auto result = std::make_shared<Float64Array>(
+        static_cast<size_t>(std::get<int64_t>(args[0])));
+    for (double &value : result->data)
+      value = generator->next_double();
+    return BoopObject(std::move(result));
+  }
+};
+
+struct RandomInt final : public BuiltinFunction {
+  const GeneratorPtr generator;
+
+  explicit RandomInt(GeneratorPtr _generator)
+      : BuiltinFunction("random_int", 2), generator(std::move(_generator)) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    using IntArg = native::ArgTraits<int64_t>;
+    if (EXPECT_FALSE(!IntArg::matches(args[0]) || !IntArg::matches(args[1])))
+      return context.error("The arguments of random_int must be integers.");
+    const int64_t low = IntArg::get(args[0]);
+    const int64_t high = IntArg::get(args[1]);
+    if (EXPECT_FALSE(low > high))
+      return context.error("random_int needs low <= high.");
+    // computed in unsigned arithmetic, where the full range wraps to 0
+    const uint64_t range =
+        static_cast<uint64_t>(high) - static_cast<uint64_t>(low) + 1;
+    return BoopObject(static_cast<int64_t>(static_cast<uint64_t>(low) +
+                                           generator->next_below(range)));
+  }
+};
+
+struct RandomSeed final : public BuiltinFunction {
+  const GeneratorPtr generator;
+
+  explicit RandomSeed(GeneratorPtr _generator)
+      : BuiltinFunction("random_seed", 1), generator(std::move(_generator)) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!std::holds_alternative<int64_t>(args[0])))
+      return context.error("Argument 1 of random_seed must be an integer.");
+    generator->reseed(static_cast<uint64_t>(std::get<int64_t>(args[0])));
+    return BoopObject(nullptr);
+  }
+};
+} // namespace
+
+auto define_math_builtins(Evaluator &evaluator) -> void {
+  auto unary = [&evaluator](std::string name, UnaryMath::Scalar scalar,
+                            UnaryMath::Kernel kernel = nullptr,
+                            UnaryMath::Integral integral = nullptr) {
+    evaluator.define_native(std::make_shared<UnaryMath>(
+        std::move(name), scalar, kernel, integral));
+  };
+  unary("sqrt", [](double x) { return std::sqrt(x); }, &kernels::sqrt);
+  unary("exp", [](double x) { return std::exp(x); });
+  unary("log", [](double x) { return std::log(x); });
+  unary("sin", [](double x) { return std::sin(x); });
+  unary("cos", [](double x) { return std::cos(x); });
+  unary("tan", [](double x) { return std::tan(x); });
+  unary("asin", [](double x) { return std::asin(x); });
+  unary("acos", [](double x) { return std::acos(x); });
+  unary("atan", [](double x) { return std::atan(x); });
+  unary("floor", [](double x) { return std::floor(x); }, &kernels::floor,
+        &integral_identity);
+  unary("ceil", [](double x) { return std::ceil(x); }, &kernels::ceil,
+        &integral_identity);
+  unary("abs", [](double x) { return std::fabs(x); }, &kernels::abs,
+        &integral_abs);
+
+  evaluator.define_native(std::make_shared<BinaryMath>(
+      "pow", [](double x, double y) { return std::pow(x, y); }));
+  evaluator.define_native(std::make_shared<BinaryMath>(
+      "atan2", [](double y, double x) { return std::atan2(y, x); }));
+  evaluator.define_native(std::make_shared<BinaryMath>(
+      "min",
+      [](double x, double y) { return x < y || std::isnan(x) ? x : y; },
+      &kernels::minimum, &kernels::minimum_scalar, &integral_min));
+  evaluator.define_native(std::make_shared<BinaryMath>(
+      "max",
+      [](double x, double y) { return x > y || std::isnan(x) ? x : y; },
+      &kernels::maximum, &kernels::maximum_scalar, &integral_max));
+
+  std::random_device entropy;
+  auto generator = std::make_shared<Xoshiro256>(
+      (static_cast<uint64_t>(entropy()) << 32) ^ entropy());
+  evaluator.define_native(std::make_shared<Random>(generator));
+  evaluator.define_native(std::make_shared<RandomInt>(generator));
+  evaluator.define_native(std::make_shared<RandomSeed>(generator));
+
+  evaluator.define_global("PI", 3.141592653589793);
+  evaluator.define_global("E", 2.718281828459045);
+}
+
+} // namespace boop
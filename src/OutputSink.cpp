@@ -0,0 +1,101 @@
+#include "../include/OutputSink.h"
+#include "../include/Types.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include <unistd.h>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+// longest shortest-round-trip double, "-2.2250738585072014e-308", rounded up
+constexpr size_t MAX_NUMBER_LENGTH = 32;
+} // namespace
+
+OutputSink::OutputSink(OutputOptions options)
+    : m_fd(options.fd), m_policy(options.policy),
+      m_buffer(std::max(options.buffer_size, MAX_NUMBER_LENGTH)) {
+  // interactive sessions must see each line as soon as it's printed
+  if (m_policy == FlushPolicy::AUTO)
+    m_policy = isatty(m_fd) ? FlushPolicy::LINE : FlushPolicy::FULL;
+}
+
+OutputSink::~OutputSink() { flush(); }
+
+auto OutputSink::get_policy() const noexcept -> FlushPolicy {
+  return m_policy;
+}
+
+auto OutputSink::reserve(size_t size) -> char * {
+  if (EXPECT_FALSE(m_used + size > m_buffer.size()))
+    flush();
+  return m_buffer.data() + m_used;
+}
+
+auto OutputSink::write(std::string_view text) -> void {
+  if (EXPECT_FALSE(text.size() > m_buffer.size())) {
+    // larger than the whole buffer, write it through
+    flush();
+    size_t written = 0;
+    while (written < text.size()) {
+      ssize_t result =
+          ::write(m_fd, text.data() + written, text.size() - written);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        return;
+      written += static_cast<size_t>(result);
+    }
+    return;
+  }
+  char *out = reserve(text.size());
+  std::memcpy(out, text.data(), text.size());
+  m_used += text.size();
+}
+
+auto OutputSink::put(char c) -> void {
+  *reserve(1) = c;
+  ++m_used;
+}
+
+auto OutputSink::write_number(double value) -> void {
+  char *out = reserve(MAX_NUMBER_LENGTH);
+  m_used = static_cast<size_t>(
+      std::to_chars(out, out + MAX_NUMBER_LENGTH, value).ptr -
+      m_buffer.data());
+}
+
+auto OutputSink::write_number(int64_t value) -> void {
+  char *out = reserve(MAX_NUMBER_LENGTH);
+  m_used = static_cast<size_t>(
+      std::to_chars(out, out + MAX_NUMBER_LENGTH, value).ptr -
+      m_buffer.data());
+}
+
+auto OutputSink::end_line() -> void {
+  put('\n');
+  if (m_policy == FlushPolicy::LINE)
+    flush();
+}
+
+auto OutputSink::flush() -> void {
+  size_t written = 0;
+  while (written < m_used) {
+    ssize_t result = ::write(m_fd, m_buffer.data() + written, m_used - written);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0) // nowhere to report it; drop the output like cout would
+      break;
+    written += static_cast<size_t>(result);
+  }
+  m_used = 0;
+}
+
+} // namespace boop
@@ -0,0 +1,158 @@
+#include "../include/Ports.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Fibers.h"
+#include "../include/Sharing.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto round_capacity(size_t capacity) -> size_t {
+  size_t rounded = 2;
+  while (rounded < capacity)
+    rounded <<= 1;
+  return rounded;
+}
+
+// how far `sequence` is ahead of `position`, wrapping around
+auto distance(size_t sequence, size_t position) -> std::ptrdiff_t {
+  return static_cast<std::ptrdiff_t>(sequence - position);
+}
+} // namespace
+
+BoopPort::BoopPort(size_t capacity)
+    : m_mask(round_capacity(capacity) - 1),
+      m_slots(std::make_unique<Slot[]>(m_mask + 1)) {
+  for (size_t i = 0; i <= m_mask; ++i)
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+auto BoopPort::capacity() const noexcept -> size_t { return m_mask + 1; }
+
+auto BoopPort::is_closed() const noexcept -> bool {
+  return m_closed.load(std::memory_order_acquire);
+}
+
+auto BoopPort::send(FiberScheduler &fibers, ErrorHandler &error_handler,
+                    const Token &site, const BoopObject &value) -> Status {
+  if (EXPECT_FALSE(is_closed()))
+    return report_runtime_error(error_handler, site,
+                                "Can't send to a closed port.");
+  ASSIGN_OR_RETURN(BoopObject message, transfer(error_handler, site, value));
+  while (!try_send(message)) {
+    if (EXPECT_FALSE(is_closed()))
+      return report_runtime_error(error_handler, site,
+                                  "Can't send to a closed port.");
+    if (!fibers.yield())
+      sleep(true);
+  }
+  notify();
+  return Status::OK;
+}
+
+auto BoopPort::recv(FiberScheduler &fibers) -> BoopObject {
+  BoopObject value{nullptr};
+  while (!try_recv(value)) {
+    // a value sent just before the port was closed is still received
+    if (is_closed() && is_empty())
+      return BoopObject(nullptr);
+    if (!fibers.yield())
+      sleep(false);
+  }
+  notify();
+  return value;
+}
+
+auto BoopPort::close() -> void {
+  m_closed.store(true, std::memory_order_seq_cst);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_changed.notify_all();
+}
+
+auto BoopPort::try_send(BoopObject &value) -> bool {
+  size_t position = m_tail.load(std::memory_order_relaxed);
+  Slot *slot = nullptr;
+  while (true) {
+    slot = &m_slots[position & m_mask];
+    const std::ptrdiff_t ahead =
+        distance(slot->sequence.load(std::memory_order_acquire), position);
+    if (ahead == 0) {
+      if (m_tail.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed))
+        break;
+    } else if (ahead < 0) {
+      return false; // the receiver hasn't emptied the slot yet
+    } else {
+      position = m_tail.load(std::memory_order_relaxed);
+    }
+  }
+  slot->value = std::move(value);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+auto BoopPort::try_recv(BoopObject &value) -> bool {
+  // receivers claim positions the way senders do
+  size_t position = m_head.load(std::memory_order_relaxed);
+  Slot *slot = nullptr;
+  while (true) {
+    slot = &m_slots[position & m_mask];
+    const std::ptrdiff_t ahead =
+        distance(slot->sequence.load(std::memory_order_acquire), position + 1);
+    if (ahead == 0) {
+      if (m_head.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed))
+        break;
+    } else if (ahead < 0) {
+      return false; // no sender has filled the slot yet
+    } else {
+      position = m_head.load(std::memory_order_relaxed);
+    }
+  }
+  value = std::exchange(slot->value, BoopObject(nullptr));
+  slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+  return true;
+}
+
+auto BoopPort::is_empty() const noexcept -> bool {
+  const size_t position = m_head.load(std::memory_order_seq_cst);
+  return distance(m_slots[position & m_mask].sequence.load(
+                      std::memory_order_seq_cst),
+                  position + 1) < 0;
+}
+
+auto BoopPort::is_full() const noexcept -> bool {
+  const size_t position = m_tail.load(std::memory_order_seq_cst);
+  return distance(m_slots[position & m_mask].sequence.load(
+                      std::memory_order_seq_cst),
+                  position) < 0;
+}
+
+auto BoopPort::notify() -> void {
+  // pairs with the increment in `sleep`: either the sleeper sees the change
+  // or this sees the sleeper
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (EXPECT_TRUE(m_sleepers.load(std::memory_order_relaxed) == 0))
+    return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_changed.notify_all();
+}
+
+auto BoopPort::sleep(bool for_room) -> void {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+  m_changed.wait(lock, [this, for_room] {
+    return is_closed() || (for_room ? !is_full() : !is_empty());
+  });
+  m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace boop
@@ -0,0 +1,49 @@
+#include "../include/Program.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Parser.h"
+#include "../include/Resolver.h"
+#include "../include/Scanner.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace boop {
+
+Program::Program(std::string source) : m_source(std::move(source)) {}
+
+auto Program::compile(std::string source, ErrorHandler &error_handler)
+    -> ProgramPtr {
+  // the constructor is private, so no make_shared
+  std::shared_ptr<Program> program{new Program(std::move(source))};
+
+  Scanner scanner{program->m_source, error_handler};
+  program->m_tokens = scanner.scan_and_get_tokens();
+  if (error_handler.has_found_error)
+    return nullptr;
+
+  Parser parser{program->m_tokens, error_handler};
+  program->m_stmts = parser.parse();
+  if (error_handler.has_found_error)
+    return nullptr;
+
+  // the last time the AST is written to, apart from quickening
+  Resolver resolver{error_handler};
+  program->m_layout = resolver.resolve(program->m_stmts);
+  if (error_handler.has_found_error)
+    return nullptr;
+  return program;
+}
+
+auto Program::get_source() const noexcept -> std::string_view {
+  return m_source;
+}
+
+auto Program::get_stmts() const noexcept
+    -> const std::vector<AST::StmtPtrVariant> & {
+  return m_stmts;
+}
+
+auto Program::get_layout() const noexcept -> ScriptLayout { return m_layout; }
+
+} // namespace boop
@@ -0,0 +1,364 @@
+#include "../include/Resolver.h"
+#include "../include/ASTNodes.h"
+#include "../include/ErrorHandler.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace boop {
+
+Resolver::Resolver(ErrorHandler &error_handler)
+    : m_error_handler(error_handler) {}
+
+auto Resolver::resolve(const std::vector<AST::StmtPtrVariant> &stmts)
+    -> ScriptLayout {
+  m_functions.clear();
+  m_functions.emplace_back(); // the script frame
+  resolve_stmts(stmts);
+  const FunctionScope &script = m_functions.back();
+  return ScriptLayout{script.frame_size};
+}
+
+auto Resolver::begin_scope() -> void {
+  FunctionScope &function = m_functions.back();
+  function.scopes.push_back(Scope{{}, function.next_slot});
+}
+
+auto Resolver::end_scope() -> void {
+  FunctionScope &function = m_functions.back();
+  // slots of the ended scope are free to be reused by its siblings
+  function.next_slot = function.scopes.back().first_slot;
+  function.scopes.pop_back();
+}
+
+auto Resolver::declare(const Token &name) -> AST::ResolvedSlot {
+  return declare(name.get_lexeme());
+}
+
+auto Resolver::declare(const std::string &name) -> AST::ResolvedSlot {
+  FunctionScope &function = m_functions.back();
+  if (function.scopes.empty()) // top-level declarations are globals
+    return AST::ResolvedSlot{};
+
+  auto &locals = function.scopes.back().locals;
+  auto iter = locals.find(name);
+  if (iter != locals.end()) // redeclaration reuses the slot
+    return AST::ResolvedSlot{AST::ResolvedSlot::Kind::LOCAL, iter->second};
+
+  const uint32_t slot = function.next_slot++;
+  function.frame_size = std::max(function.frame_size, function.next_slot);
+  locals.emplace(name, slot);
+  return AST::ResolvedSlot{AST::ResolvedSlot::Kind::LOCAL, slot};
+}
+
+auto Resolver::lookup(const std::string &name) -> AST::ResolvedSlot {
+  const size_t current = m_functions.size() - 1;
+  if (auto slot = find_local(current, name))
+    return AST::ResolvedSlot{AST::ResolvedSlot::Kind::LOCAL, *slot};
+  if (auto upvalue = find_upvalue(current, name))
+    return AST::ResolvedSlot{AST::ResolvedSlot::Kind::UPVALUE, *upvalue};
+  return AST::ResolvedSlot{}; // global
+}
+
+auto Resolver::find_local(size_t level, const std::string &name)
+    -> std::optional<uint32_t> {
+  const auto &scopes = m_functions[level].scopes;
+  for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+    auto iter = scope->locals.find(name);
+    if (iter != scope->locals.end())
+      return iter->second;
+  }
+  return std::nullopt;
+}
+
+auto Resolver::find_upvalue(size_t level, const std::string &name)
+    -> std::optional<uint32_t> {
+  if (level == 0) // the script has nothing to capture from
+    return std::nullopt;
+  // a variable of the directly enclosing function is captured from its frame,
+  // anything further out is threaded through the enclosing closure
+  if (auto slot = find_local(level - 1, name))
+    return add_upvalue(level, AST::UpvalueDescriptor{true, *slot});
+  if (auto upvalue = find_upvalue(level - 1, name))
+    return add_upvalue(level, AST::UpvalueDescriptor{false, *upvalue});
+  return std::nullopt;
+}
+
+auto Resolver::add_upvalue(size_t level, AST::UpvalueDescriptor descriptor)
+    -> uint32_t {
+  auto &upvalues = m_functions[level].upvalues;
+  for (size_t i = 0; i < upvalues.size(); ++i)
+    if (upvalues[i].is_local == descriptor.is_local &&
+        upvalues[i].index == descriptor.index)
+      return static_cast<uint32_t>(i);
+  upvalues.push_back(descriptor);
+  return static_cast<uint32_t>(upvalues.size() - 1);
+}
+
+auto Resolver::resolve_function(AST::ExprFunction &function, bool is_method,
+                                bool is_initializer) -> void {
+  m_functions.emplace_back();
+  m_functions.back().function = &function;
+  m_functions.back().is_initializer = is_initializer;
+  begin_scope();
+  if (is_method)
+    declare("this"); // the receiver always occupies slot 0
+  for (const Token &param : function.parameters)
+    declare(param);
+  resolve_stmts(function.body);
+  end_scope();
+
+  function.frame_size = m_functions.back().frame_size;
+  function.upvalues = std::move(m_functions.back().upvalues);
+  m_functions.pop_back();
+}
+
+auto Resolver::resolve_class(const AST::ClassStmtPtr &stmt) -> void {
+  stmt->resolved = declare(stmt->class_name);
+  if (stmt->superClass.has_value()) {
+    resolve_expr(stmt->superClass.value());
+    // 'super' lives in a scope wrapping the methods
+    begin_scope();
+    stmt->super_resolved = declare("super");
+  }
+
+  ++m_class_depth;
+  for (const auto &method : stmt->methods) {
+    const auto &function_stmt = std::get<AST::FuncStmtPtr>(method);
+    resolve_function(*function_stmt->ExprFunction, true,
+                     function_stmt->function_name.get_lexeme() == "init");
+  }
+  --m_class_depth;
+
+  if (stmt->superClass.has_value())
+    end_scope();
+}
+
+auto Resolver::resolve_stmts(const std::vector<AST::StmtPtrVariant> &stmts)
+    -> void {
+  for (const AST::StmtPtrVariant &stmt : stmts)
+    resolve_stmt(stmt);
+}
+
+auto Resolver::resolve_expr(const AST::ExprPtrVariant &expr) -> void {
+  switch (expr.index()) {
+  case 0: { // AST::ExprBinaryPtr
+    const auto &binary = std::get<0>(expr);
+    resolve_expr(binary->left);
+    resolve_expr(binary->right);
+    return;
+  }
+  case 1: // AST::ExprGroupingPtr
+    resolve_expr(std::get<1>(expr)->expression);
+    return;
+  case 2: { // AST::ExprLiteralPtr
+    // converted here so evaluating a string literal doesn't allocate
+    const auto &literal = std::get<2>(expr);
+    literal->value = make_boop_object(literal->literalVal);
+    return;
+  }
+  case 3: // AST::ExprUnaryPtr
+    resolve_expr(std::get<3>(expr)->right);
+    return;
+  case 4: { // AST::ExprConditionalPtr
+    const auto &conditional = std::get<4>(expr);
+    resolve_expr(conditional->condition);
+    resolve_expr(conditional->then_branch);
+    resolve_expr(conditional->else_branch);
+    return;
+  }
+  case 5: // AST::ExprPostfixPtr
+    resolve_expr(std::get<5>(expr)->left);
+    return;
+  case 6: { // AST::ExprVariablePtr
+    const auto &variable = std::get<6>(expr);
+    variable->resolved = lookup(variable->var_name.get_lexeme());
+    return;
+  }
+  case 7: { // AST::ExprAssignmentPtr
+    const auto &assignment = std::get<7>(expr);
+    resolve_expr(assignment->right);
+    assignment->resolved = lookup(assignment->var_name.get_lexeme());
+    return;
+  }
+  case 8: { // AST::ExprLogicalPtr
+    const auto &logical = std::get<8>(expr);
+    resolve_expr(logical->left);
+    resolve_expr(logical->right);
+    return;
+  }
+  case 9: { // AST::ExprCallPtr
+    const auto &call = std::get<9>(expr);
+    resolve_expr(call->callee);
+    for (const auto &arg : call->arguments)
+      resolve_expr(arg);
+    return;
+  }
+  case 10: // AST::ExprFunctionPtr
+    resolve_function(*std::get<10>(expr), false);
+    return;
+  case 11: // AST::ExprGetPtr
+    resolve_expr(std::get<11>(expr)->expr);
+    return;
+  case 12: { // AST::ExprSetPtr
+    const auto &set = std::get<12>(expr);
+    resolve_expr(set->expr);
+    resolve_expr(set->value);
+    return;
+  }
+  case 13: { // AST::ExprThisPtr
+    const auto &this_expr = std::get<13>(expr);
+    if (m_class_depth == 0)
+      m_error_handler.add(this_expr->keyword.get_line(),
+                          "Can't use 'this' outside of a class.");
+    this_expr->resolved = lookup("this");
+    return;
+  }
+  case 14: { // AST::ExprSuperPtr
+    const auto &super_expr = std::get<14>(expr);
+    if (m_class_depth == 0)
+      m_error_handler.add(super_expr->keyword.get_line(),
+                          "Can't use 'super' outside of a class.");
+    super_expr->resolved = lookup("super");
+    super_expr->this_resolved = lookup("this");
+    return;
+  }
+  case 15: // AST::ExprListPtr
+    for (const auto &element : std::get<15>(expr)->elements)
+      resolve_expr(element);
+    return;
+  case 16: { // AST::ExprIndexPtr
+    const auto &index = std::get<16>(expr);
+    resolve_expr(index->object);
+    resolve_expr(index->index);
+    return;
+  }
+  case 17: { // AST::ExprIndexSetPtr
+    const auto &index_set = std::get<17>(expr);
+    resolve_expr(index_set->object);
+    resolve_expr(index_set->index);
+    resolve_expr(index_set->value);
+    return;
+  }
+  case 18: { // AST::ExprSlicePtr
+    const auto &slice = std::get<18>(expr);
+    resolve_expr(slice->object);
+    if (slice->begin.has_value())
+      resolve_expr(slice->begin.value());
+    if (slice->end.has_value())
+      resolve_expr(slice->end.value());
+    return;
+  }
+  case 19: { // AST::ExprMapPtr
+    const auto &map = std::get<19>(expr);
+    for (size_t i = 0; i < map->keys.size(); ++i) {
+      resolve_expr(map->keys[i]);
+      resolve_expr(map->values[i]);
+    }
+    return;
+  }
+  case 20: { // AST::ExprSpawnPtr
+    const auto &call = std::get<20>(expr)->call;
+    resolve_expr(call->callee);
+    for (const auto &arg : call->arguments)
+      resolve_expr(arg);
+    return;
+  }
+  case 21: // AST::ExprAwaitPtr
+    resolve_expr(std::get<21>(expr)->future);
+    return;
+  default:
+    static_assert(std::variant_size_v<AST::ExprPtrVariant> == 22,
+                  "Looks like you forgot to update the cases in "
+                  "Resolver::resolve_expr(const ExprPtrVariant&)!");
+  }
+}
+
+auto Resolver::resolve_stmt(const AST::StmtPtrVariant &stmt) -> void {
+  switch (stmt.index()) {
+  case 0: // AST::ExprStmtPtr
+    resolve_expr(std::get<0>(stmt)->expression);
+    return;
+  case 1: // AST::PrintStmtPtr
+    resolve_expr(std::get<1>(stmt)->expression);
+    return;
+  case 2: { // AST::BlockStmtPtr
+    const auto &block = std::get<2>(stmt);
+    begin_scope();
+    block->local_begin = m_functions.back().next_slot;
+    resolve_stmts(block->statements);
+    block->local_end = m_functions.back().next_slot;
+    end_scope();
+    return;
+  }
+  case 3: { // AST::VarStmtPtr
+    const auto &var = std::get<3>(stmt);
+    // the initializer sees the enclosing binding of a shadowed name
+    if (var->initializer.has_value())
+      resolve_expr(var->initializer.value());
+    var->resolved = declare(var->var_name);
+    return;
+  }
+  case 4: { // AST::IfStmtPtr
+    const auto &if_stmt = std::get<4>(stmt);
+    resolve_expr(if_stmt->condition);
+    resolve_stmt(if_stmt->then_branch);
+    if (if_stmt->else_branch.has_value())
+      resolve_stmt(if_stmt->else_branch.value());
+    return;
+  }
+  case 5: { // AST::WhileStmtPtr
+    const auto &while_stmt = std::get<5>(stmt);
+    resolve_expr(while_stmt->condition);
+    resolve_stmt(while_stmt->loop_body);
+    return;
+  }
+  case 6: { // AST::ForStmtPtr
+    const auto &for_stmt = std::get<6>(stmt);
+    if (for_stmt->initializer.has_value())
+      resolve_stmt(for_stmt->initializer.value());
+    if (for_stmt->condition.has_value())
+      resolve_expr(for_stmt->condition.value());
+    if (for_stmt->increment.has_value())
+      resolve_expr(for_stmt->increment.value());
+    resolve_stmt(for_stmt->loop_body);
+    return;
+  }
+  case 7: { // AST::FuncStmtPtr
+    const auto &function = std::get<7>(stmt);
+    // declared before its body so it can call itself
+    function->resolved = declare(function->function_name);
+    resolve_function(*function->ExprFunction, false);
+    return;
+  }
+  case 8: { // AST::RetStmtPtr
+    const auto &ret = std::get<8>(stmt);
+    if (!ret->value.has_value())
+      return;
+    resolve_expr(ret->value.value());
+    // a call whose value is returned as is can take over the caller's frame;
+    // initializers are excluded since they return their instance instead
+    const FunctionScope &function = m_functions.back();
+    if (function.function != nullptr && !function.is_initializer &&
+        std::holds_alternative<AST::ExprCallPtr>(ret->value.value()))
+      std::get<AST::ExprCallPtr>(ret->value.value())->is_tail_call = true;
+    return;
+  }
+  case 9: // AST::ClassStmtPtr
+    resolve_class(std::get<9>(stmt));
+    return;
+  case 10: // AST::BreakStmtPtr
+  case 11: // AST::ContinueStmtPtr
+    return;
+  default:
+    static_assert(std::variant_size_v<AST::StmtPtrVariant> == 12,
+                  "Looks like you forgot to update the cases in "
+                  "Resolver::resolve_stmt(const StmtPtrVariant&)!");
+  }
+}
+
+} // namespace boop
@@ -0,0 +1,393 @@
+#include "../include/Sharing.h"
+#include "../include/BoopMap.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Tasks.h"
+#include "../include/Types.h"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto is_shareable_function(const Functor &function) -> bool {
+  return function.get_upvalues().empty() &&
+         (function.get_receiver() == nullptr ||
+          function.get_receiver()->is_frozen());
+}
+
+auto is_shareable_class(BoopClass &boop_class) -> bool {
+  for (const auto &[hash, method] : boop_class.get_methods())
+    if (!std::get<FunctionPtr>(method)->get_upvalues().empty())
+      return false;
+  const std::optional<BoopClassPtr> super = boop_class.get_super_class();
+  return !super.has_value() || is_shareable_class(*super.value());
+}
+
+/**
+ * @brief walks everything a value reaches to check it can all be frozen,
+ * collecting what to mark; nothing is marked unless the whole walk succeeds
+ *
+ */
+class Freezer {
+private:
+  ErrorHandler &m_error_handler;
+  const Token &m_site;
+  std::unordered_set<const void *> m_seen;
+  std::vector<Freezable *> m_to_mark; // children before their containers
+
+public:
+  Freezer(ErrorHandler &error_handler, const Token &site)
+      : m_error_handler(error_handler), m_site(site) {}
+
+  auto visit(const BoopObject &value) -> Status {
+    switch (value.index()) {
+    case 0: // BoopString
+      // flattening is harmless even if freezing fails later
+      std::get<BoopString>(value).str();
+      return Status::OK;
+    case 4: // FunctionPtr
+      return visit_function(*std::get<FunctionPtr>(value));
+    case 6: // BoopClassPtr
+      return visit_class(*std::get<BoopClassPtr>(value));
+    case 7: { // BoopInstancePtr
+      BoopInstance &instance = *std::get<BoopInstancePtr>(value);
+      if (!first_visit(instance))
+        return Status::OK;
+      RETURN_IF_ERROR(visit_class(*instance.get_class()));
+      for (const auto &[hash, field] : instance.get_fields())
+        RETURN_IF_ERROR(visit(field));
+      m_to_mark.push_back(&instance);
+      return Status::OK;
+    }
+    case 9: { // BoopListPtr
+      BoopList &list = *std::get<BoopListPtr>(value);
+      if (!first_visit(list))
+        return Status::OK;
+      for (const BoopObject &element : list.elements)
+        RETURN_IF_ERROR(visit(element));
+      m_to_mark.push_back(&list);
+      return Status::OK;
+    }
+    case 10: { // BoopMapPtr
+      BoopMap &map = *std::get<BoopMapPtr>(value);
+      if (!first_visit(map))
+        return Status::OK;
+      for (const auto &entry : map.entries()) {
+        if (!entry.is_live())
+          continue;
+        RETURN_IF_ERROR(visit(entry.key));
+        RETURN_IF_ERROR(visit(entry.value));
+      }
+      m_to_mark.push_back(&map);
+      return Status::OK;
+    }
+    case 11: { // Float64ArrayPtr
+      Float64Array &array = *std::get<Float64ArrayPtr>(value);
+      if (first_visit(array))
+        m_to_mark.push_back(&array);
+      return Status::OK;
+    }
+    case 12: // FuturePtr
+      if (EXPECT_FALSE(std::get<FuturePtr>(value)->is_local()))
+        return report_runtime_error(
+            m_error_handler, m_site,
+            "Can't freeze the future of an async call.");
+      return Status::OK;
+    case 13: // ChannelPtr
+      return report_runtime_error(m_error_handler, m_site,
+                                  "Can't freeze a channel.");
+    case 15: // StreamPtr
+      return report_runtime_error(m_error_handler, m_site,
+                                  "Can't freeze a stream.");
+    default:
+      // numbers, booleans, nil, builtins and futures never change, and
+      // ports are made for sharing
+      static_assert(std::variant_size_v<BoopObject> == 16,
+                    "Looks like you forgot to update the cases in "
+                    "Freezer::visit(const BoopObject&)!");
+      return Status::OK;
+    }
+  }
+
+  auto mark() -> void {
+    for (Freezable *value : m_to_mark)
+      value->mark_frozen();
+  }
+
+private:
+  // false for values frozen before or already seen on this walk
+  auto first_visit(Freezable &value) -> bool {
+    return !value.is_frozen() && m_seen.insert(&value).second;
+  }
+
+  auto visit_function(const Functor &function) -> Status {
+    if (EXPECT_FALSE(!function.get_upvalues().empty()))
+      return report_runtime_error(
+          m_error_handler, m_site,
+          "Can't freeze a closure that captures variables.");
+    if (function.get_receiver() != nullptr)
+      return visit(BoopObject(function.get_receiver()));
+    return Status::OK;
+  }
+
+  auto visit_class(BoopClass &boop_class) -> Status {
+    if (EXPECT_FALSE(!is_shareable_class(boop_class)))
+      return report_runtime_error(
+          m_error_handler, m_site,
+          "Can't freeze an instance of a class whose methods capture "
+          "variables.");
+    return Status::OK;
+  }
+};
+
+/**
+ * @brief deep copy of a value, made by the thread giving it away. Copies are
+ * remembered by the address of their original so aliasing survives.
+ *
+ */
+class Copier {
+private:
+  ErrorHandler &m_error_handler;
+  const Token &m_site;
+  const bool m_copy_frozen;
+  std::unordered_map<const void *, BoopObject> m_copies;
+  std::unordered_map<const Upvalue *, UpvaluePtr> m_cells;
+
+public:
+  Copier(ErrorHandler &error_handler, const Token &site, bool copy_frozen)
+      : m_error_handler(error_handler), m_site(site),
+        m_copy_frozen(copy_frozen) {}
+
+  auto copy(const BoopObject &value) -> Result<BoopObject> {
+    switch (value.index()) {
+    case 0: // BoopString
+      // a rope isn't safe to flatten on two threads at once
+      std::get<BoopString>(value).str();
+      return value;
+    case 4: // FunctionPtr
+      return copy_function(std::get<FunctionPtr>(value));
+    case 6: { // BoopClassPtr
+      const BoopClassPtr &boop_class = std::get<BoopClassPtr>(value);
+      if (EXPECT_FALSE(!is_shareable_class(*boop_class)))
+        return report_runtime_error(
+            m_error_handler, m_site,
+            "Can't pass class " + boop_class->get_name() +
+                " to another thread, its methods capture variables.");
+      return value;
+    }
+    case 7: // BoopInstancePtr
+      return copy_instance(std::get<BoopInstancePtr>(value));
+    case 9: // BoopListPtr
+      return copy_list(std::get<BoopListPtr>(value));
+    case 10: // BoopMapPtr
+      return copy_map(std::get<BoopMapPtr>(value));
+    case 11: { // Float64ArrayPtr
+      const Float64ArrayPtr &array = std::get<Float64ArrayPtr>(value);
+      if (is_kept(*array))
+        return value;
+      return remember(array.get(), std::make_shared<Float64Array>(array->data));
+    }
+    case 12: // FuturePtr
+      if (EXPECT_FALSE(std::get<FuturePtr>(value)->is_local()))
+        return report_runtime_error(
+            m_error_handler, m_site,
+            "Can't pass the future of an async call to another thread.");
+      return value;
+    case 13: // ChannelPtr
+      // only the fibers of one evaluator may use a channel
+      return report_runtime_error(m_error_handler, m_site,
+                                  "Can't pass a channel to another thread.");
+    case 15: // StreamPtr
+      // it's read and written through the fibers of one evaluator
+      return report_runtime_error(m_error_handler, m_site,
+                                  "Can't pass a stream to another thread.");
+    default:
+      static_assert(std::variant_size_v<BoopObject> == 16,
+                    "Looks like you forgot to update the cases in "
+                    "Copier::copy(const BoopObject&)!");
+      return value;
+    }
+  }
+
+private:
+  auto is_kept(const Freezable &value) const -> bool {
+    return !m_copy_frozen && value.is_frozen();
+  }
+
+  auto remember(const void *original, BoopObject copy) -> BoopObject {
+    m_copies.emplace(original, copy);
+    return copy;
+  }
+
+  auto find_copy(const void *original) const -> const BoopObject * {
+    auto iter = m_copies.find(original);
+    return iter == m_copies.end() ? nullptr : &iter->second;
+  }
+
+  auto copy_list(const BoopListPtr &list) -> Result<BoopObject> {
+    if (is_kept(*list))
+      return BoopObject(list);
+    if (const BoopObject *done = find_copy(list.get()))
+      return *done;
+    auto copy = std::make_shared<BoopList>();
+    // remembered before the elements are copied, for lists holding themselves
+    remember(list.get(), copy);
+    copy->elements.reserve(list->size());
+    for (const BoopObject &element : list->elements) {
+      ASSIGN_OR_RETURN(BoopObject element_copy, this->copy(element));
+      copy->elements.push_back(std::move(element_copy));
+    }
+    return BoopObject(std::move(copy));
+  }
+
+  auto copy_map(const BoopMapPtr &map) -> Result<BoopObject> {
+    if (is_kept(*map))
+      return BoopObject(map);
+    if (const BoopObject *done = find_copy(map.get()))
+      return *done;
+    auto copy = std::make_shared<BoopMap>();
+    remember(map.get(), copy);
+    copy->reserve(map->size());
+    for (const auto &entry : map->entries()) {
+      if (!entry.is_live())
+        continue;
+      // keys are strings, numbers or booleans, none of which is copied
+      ASSIGN_OR_RETURN(BoopObject key, this->copy(entry.key));
+      ASSIGN_OR_RETURN(BoopObject value, this->copy(entry.value));
+      copy->set(key, std::move(value));
+    }
+    return BoopObject(std::move(copy));
+  }
+
+  auto copy_instance(const BoopInstancePtr &instance) -> Result<BoopObject> {
+    if (is_kept(*instance))
+      return BoopObject(instance);
+    if (const BoopObject *done = find_copy(instance.get()))
+      return *done;
+    RETURN_IF_ERROR(copy(BoopObject(instance->get_class())).status);
+    auto copy = std::make_shared<BoopInstance>(instance->get_class());
+    remember(instance.get(), copy);
+    std::map<size_t, BoopObject> fields;
+    for (const auto &[hash, field] : instance->get_fields()) {
+      ASSIGN_OR_RETURN(BoopObject field_copy, this->copy(field));
+      fields.emplace(hash, std::move(field_copy));
+    }
+    copy->set_fields(std::move(fields));
+    return BoopObject(std::move(copy));
+  }
+
+  auto copy_function(const FunctionPtr &function) -> Result<BoopObject> {
+    if (function->get_upvalues().empty() &&
+        (function->get_receiver() == nullptr ||
+         is_kept(*function->get_receiver())))
+      return BoopObject(function);
+    if (const BoopObject *done = find_copy(function.get()))
+      return *done;
+
+    // each captured variable becomes a closed cell holding a copy of its
+    // current value; closures sharing a variable share the copied cell
+    std::vector<UpvaluePtr> cells;
+    cells.reserve(function->get_upvalues().size());
+    for (const UpvaluePtr &upvalue : function->get_upvalues()) {
+      auto iter = m_cells.find(upvalue.get());
+      if (iter != m_cells.end()) {
+        cells.push_back(iter->second);
+        continue;
+      }
+      auto cell = std::make_shared<Upvalue>(nullptr, 0);
+      cell->location = &cell->closed;
+      m_cells.emplace(upvalue.get(), cell);
+      ASSIGN_OR_RETURN(cell->closed, copy(*upvalue->location));
+      cells.push_back(std::move(cell));
+    }
+    BoopInstancePtr receiver = nullptr;
+    if (function->get_receiver() != nullptr) {
+      ASSIGN_OR_RETURN(BoopObject receiver_copy,
+                       copy(BoopObject(function->get_receiver())));
+      receiver = std::get<BoopInstancePtr>(receiver_copy);
+    }
+    return remember(function.get(),
+                    FunctionPtr(std::make_shared<Functor>(
+                        function->get_program(), function->get_declaration(),
+                        function->get_name(), std::move(cells),
+                        function->is_method(), function->is_initializer(),
+                        std::move(receiver))));
+  }
+};
+} // namespace
+
+auto is_shareable(const BoopObject &value) -> bool {
+  switch (value.index()) {
+  case 4: // FunctionPtr
+    return is_shareable_function(*std::get<FunctionPtr>(value));
+  case 6: // BoopClassPtr
+    return is_shareable_class(*std::get<BoopClassPtr>(value));
+  case 7: // BoopInstancePtr
+    return std::get<BoopInstancePtr>(value)->is_frozen();
+  case 9: // BoopListPtr
+    return std::get<BoopListPtr>(value)->is_frozen();
+  case 10: // BoopMapPtr
+    return std::get<BoopMapPtr>(value)->is_frozen();
+  case 11: // Float64ArrayPtr
+    return std::get<Float64ArrayPtr>(value)->is_frozen();
+  case 12: // FuturePtr
+    return !std::get<FuturePtr>(value)->is_local();
+  case 13: // ChannelPtr
+  case 15: // StreamPtr
+    return false;
+  default:
+    static_assert(std::variant_size_v<BoopObject> == 16,
+                  "Looks like you forgot to update the cases in "
+                  "is_shareable(const BoopObject&)!");
+    return true;
+  }
+}
+
+auto is_frozen(const BoopObject &value) -> bool {
+  if (const auto *list = std::get_if<BoopListPtr>(&value))
+    return (*list)->is_frozen();
+  if (const auto *map = std::get_if<BoopMapPtr>(&value))
+    return (*map)->is_frozen();
+  if (const auto *array = std::get_if<Float64ArrayPtr>(&value))
+    return (*array)->is_frozen();
+  if (const auto *instance = std::get_if<BoopInstancePtr>(&value))
+    return (*instance)->is_frozen();
+  return false;
+}
+
+auto freeze(ErrorHandler &error_handler, const Token &site,
+            const BoopObject &value) -> Status {
+  Freezer freezer{error_handler, site};
+  RETURN_IF_ERROR(freezer.visit(value));
+  freezer.mark();
+  return Status::OK;
+}
+
+auto transfer(ErrorHandler &error_handler, const Token &site,
+              const BoopObject &value) -> Result<BoopObject> {
+  return Copier{error_handler, site, false}.copy(value);
+}
+
+auto transfer(ErrorHandler &error_handler, const Token &site,
+              std::vector<BoopObject> &values) -> Status {
+  Copier copier{error_handler, site, false};
+  for (BoopObject &value : values) {
+    ASSIGN_OR_RETURN(value, copier.copy(value));
+  }
+  return Status::OK;
+}
+
+auto deep_copy(ErrorHandler &error_handler, const Token &site,
+               const BoopObject &value) -> Result<BoopObject> {
+  return Copier{error_handler, site, true}.copy(value);
+}
+
+} // namespace boop
@@ -0,0 +1,183 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Fibers.h"
+#include "../include/Native.h"
+#include "../include/Streams.h"
+#include "../include/Types.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+auto get_stream(NativeContext &context, const std::string &name,
+                const BoopObject &arg) -> Result<BoopStream *> {
+  const auto *stream = std::get_if<StreamPtr>(&arg);
+  if (EXPECT_FALSE(stream == nullptr))
+    return context.error("Argument 1 of " + name + " must be a stream.");
+  return stream->get();
+}
+
+auto get_string(NativeContext &context, const std::string &name, size_t index,
+                const BoopObject &arg) -> Result<const std::string *> {
+  const auto *str = std::get_if<BoopString>(&arg);
+  if (EXPECT_FALSE(str == nullptr))
+    return context.error("Argument " + std::to_string(index) + " of " + name +
+                         " must be a string.");
+  return &str->str();
+}
+
+auto make_pair_list(std::pair<StreamPtr, StreamPtr> streams) -> BoopObject {
+  auto list = std::make_shared<BoopList>();
+  list->elements = {BoopObject(std::move(streams.first)),
+                    BoopObject(std::move(streams.second))};
+  return BoopObject(std::move(list));
+}
+
+struct Open final : public BuiltinFunction {
+  Open() : BuiltinFunction("open", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_string(context, get_name(), 1, args[0]));
+    ASSIGN_OR_RETURN(const std::string *mode,
+                     get_string(context, get_name(), 2, args[1]));
+    ASSIGN_OR_RETURN(StreamPtr stream,
+                     BoopStream::open(context.error_handler, context.call_site,
+                                      *path, *mode));
+    return BoopObject(std::move(stream));
+  }
+};
+
+struct Pipe final : public BuiltinFunction {
+  Pipe() : BuiltinFunction("pipe", 0) {}
+
+  auto call(NativeContext &context, ArgSpan /*args*/)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(auto ends, BoopStream::make_pipe(context.error_handler,
+                                                      context.call_site));
+    return make_pair_list(std::move(ends));
+  }
+};
+
+struct SocketPair final : public BuiltinFunction {
+  SocketPair() : BuiltinFunction("socketpair", 0) {}
+
+  auto call(NativeContext &context, ArgSpan /*args*/)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(auto ends,
+                     BoopStream::make_socket_pair(context.error_handler,
+                                                  context.call_site));
+    return make_pair_list(std::move(ends));
+  }
+};
+
+struct Listen final : public BuiltinFunction {
+  Listen() : BuiltinFunction("listen", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_string(context, get_name(), 1, args[0]));
+    ASSIGN_OR_RETURN(StreamPtr stream,
+                     BoopStream::listen(context.error_handler,
+                                        context.call_site, *path));
+    return BoopObject(std::move(stream));
+  }
+};
+
+struct Connect final : public BuiltinFunction {
+  Connect() : BuiltinFunction("connect", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(const std::string *path,
+                     get_string(context, get_name(), 1, args[0]));
+    ASSIGN_OR_RETURN(StreamPtr stream,
+                     BoopStream::connect(context.evaluator.fibers(),
+                                         context.error_handler,
+                                         context.call_site, *path));
+    return BoopObject(std::move(stream));
+  }
+};
+
+struct Accept final : public BuiltinFunction {
+  Accept() : BuiltinFunction("accept", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(BoopStream * listener,
+                     get_stream(context, get_name(), args[0]));
+    ASSIGN_OR_RETURN(StreamPtr stream,
+                     listener->accept(context.evaluator.fibers(),
+                                      context.error_handler,
+                                      context.call_site));
+    return BoopObject(std::move(stream));
+  }
+};
+
+struct Read final : public BuiltinFunction {
+  Read() : BuiltinFunction("read", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(BoopStream * stream,
+                     get_stream(context, get_name(), args[0]));
+    const auto *size = std::get_if<int64_t>(&args[1]);
+    if (EXPECT_FALSE(size == nullptr || *size < 1))
+      return context.error("Argument 2 of read must be an integer of at "
+                           "least 1.");
+    return stream->read(context.evaluator.fibers(), context.error_handler,
+                        context.call_site, static_cast<size_t>(*size));
+  }
+};
+
+struct ReadLine final : public BuiltinFunction {
+  ReadLine() : BuiltinFunction("readline", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(BoopStream * stream,
+                     get_stream(context, get_name(), args[0]));
+    return stream->read_line(context.evaluator.fibers(),
+                             context.error_handler, context.call_site);
+  }
+};
+
+struct Write final : public BuiltinFunction {
+  Write() : BuiltinFunction("write", 2) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    ASSIGN_OR_RETURN(BoopStream * stream,
+                     get_stream(context, get_name(), args[0]));
+    ASSIGN_OR_RETURN(const std::string *data,
+                     get_string(context, get_name(), 2, args[1]));
+    RETURN_IF_ERROR(stream->write(context.evaluator.fibers(),
+                                  context.error_handler, context.call_site,
+                                  *data));
+    return BoopObject(nullptr);
+  }
+};
+} // namespace
+
+auto define_stream_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<Open>());
+  evaluator.define_native(std::make_shared<Pipe>());
+  evaluator.define_native(std::make_shared<SocketPair>());
+  evaluator.define_native(std::make_shared<Listen>());
+  evaluator.define_native(std::make_shared<Connect>());
+  evaluator.define_native(std::make_shared<Accept>());
+  evaluator.define_native(std::make_shared<Read>());
+  evaluator.define_native(std::make_shared<ReadLine>());
+  evaluator.define_native(std::make_shared<Write>());
+}
+
+} // namespace boop
@@ -0,0 +1,353 @@
+#include "../include/Streams.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Fibers.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+// reports the failure `errno` describes
+auto system_error(ErrorHandler &error_handler, const Token &site,
+                  const std::string &what) -> Status {
+  return report_runtime_error(error_handler, site,
+                              "Can't " + what + ": " + std::strerror(errno) +
+                                  ".");
+}
+
+auto would_block() -> bool { return errno == EAGAIN || errno == EWOULDBLOCK; }
+
+auto make_address(ErrorHandler &error_handler, const Token &site,
+                  const std::string &path, sockaddr_un &address) -> Status {
+  address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  if (EXPECT_FALSE(path.size() >= sizeof(address.sun_path)))
+    return report_runtime_error(error_handler, site,
+                                "The socket path " + path + " is too long.");
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return Status::OK;
+}
+
+auto make_socket(ErrorHandler &error_handler, const Token &site)
+    -> Result<int> {
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (EXPECT_FALSE(fd < 0))
+    return system_error(error_handler, site, "make a socket");
+  return fd;
+}
+
+/**
+ * @brief holds back the SIGPIPE a write to a pipe nobody reads any more
+ * raises on this thread, which would kill the process, so that the write
+ * just fails with EPIPE
+ *
+ */
+class SigpipeBlock : public Uncopyable {
+private:
+  sigset_t m_sigpipe;
+  sigset_t m_old_mask;
+  bool m_was_pending{false};
+
+public:
+  SigpipeBlock() {
+    sigemptyset(&m_sigpipe);
+    sigaddset(&m_sigpipe, SIGPIPE);
+    sigset_t pending;
+    sigemptyset(&pending);
+    sigpending(&pending);
+    m_was_pending = sigismember(&pending, SIGPIPE) == 1;
+    pthread_sigmask(SIG_BLOCK, &m_sigpipe, &m_old_mask);
+  }
+  ~SigpipeBlock() {
+    // discards the signal the write raised, if any
+    if (!m_was_pending) {
+      const timespec no_wait{0, 0};
+      const int saved_errno = errno;
+      while (sigtimedwait(&m_sigpipe, nullptr, &no_wait) == SIGPIPE)
+        ;
+      errno = saved_errno;
+    }
+    pthread_sigmask(SIG_SETMASK, &m_old_mask, nullptr);
+  }
+};
+} // namespace
+
+BoopStream::BoopStream(int fd, Kind kind) : m_fd(fd), m_kind(kind) {}
+
+BoopStream::~BoopStream() {
+  // a fiber waiting on the stream holds it, so none can be left waiting
+  unmap();
+  if (m_fd >= 0)
+    ::close(m_fd);
+}
+
+auto BoopStream::open(ErrorHandler &error_handler, const Token &site,
+                      const std::string &path, const std::string &mode)
+    -> Result<StreamPtr> {
+  int flags = O_NONBLOCK | O_CLOEXEC;
+  if (mode == "r")
+    flags |= O_RDONLY;
+  else if (mode == "w")
+    flags |= O_WRONLY | O_CREAT | O_TRUNC;
+  else if (mode == "a")
+    flags |= O_WRONLY | O_CREAT | O_APPEND;
+  else
+    return report_runtime_error(error_handler, site,
+                                "The mode of a stream must be \"r\", \"w\" or "
+                                "\"a\".");
+  const int fd = ::open(path.c_str(), flags, 0666);
+  if (EXPECT_FALSE(fd < 0))
+    return system_error(error_handler, site, "open " + path);
+  struct stat status {};
+  const bool is_fifo = fstat(fd, &status) == 0 && S_ISFIFO(status.st_mode);
+  return std::make_shared<BoopStream>(fd, is_fifo ? Kind::PIPE : Kind::FILE);
+}
+
+auto BoopStream::map(ErrorHandler &error_handler, const Token &site,
+                     const std::string &path) -> Result<StreamPtr> {
+  ASSIGN_OR_RETURN(StreamPtr stream, open(error_handler, site, path, "r"));
+  struct stat status {};
+  if (stream->m_kind != Kind::FILE || fstat(stream->m_fd, &status) != 0 ||
+      status.st_size <= 0)
+    return stream;
+  const auto size = static_cast<size_t>(status.st_size);
+  void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, stream->m_fd, 0);
+  if (EXPECT_FALSE(map == MAP_FAILED))
+    return stream;
+  // lets the kernel read ahead aggressively and drop pages once passed
+  madvise(map, size, MADV_SEQUENTIAL);
+  stream->m_map = static_cast<const char *>(map);
+  stream->m_map_size = size;
+  stream->m_at_end = true; // nothing left to read past the mapping
+  return stream;
+}
+
+auto BoopStream::make_pipe(ErrorHandler &error_handler, const Token &site)
+    -> Result<std::pair<StreamPtr, StreamPtr>> {
+  int fds[2];
+  if (EXPECT_FALSE(pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0))
+    return system_error(error_handler, site, "make a pipe");
+  return std::make_pair(std::make_shared<BoopStream>(fds[0], Kind::PIPE),
+                        std::make_shared<BoopStream>(fds[1], Kind::PIPE));
+}
+
+auto BoopStream::make_socket_pair(ErrorHandler &error_handler,
+                                  const Token &site)
+    -> Result<std::pair<StreamPtr, StreamPtr>> {
+  int fds[2];
+  if (EXPECT_FALSE(socketpair(AF_UNIX,
+                              SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0,
+                              fds) != 0))
+    return system_error(error_handler, site, "make a socket pair");
+  return std::make_pair(std::make_shared<BoopStream>(fds[0], Kind::SOCKET),
+                        std::make_shared<BoopStream>(fds[1], Kind::SOCKET));
+}
+
+auto BoopStream::listen(ErrorHandler &error_handler, const Token &site,
+                        const std::string &path) -> Result<StreamPtr> {
+  sockaddr_un address;
+  RETURN_IF_ERROR(make_address(error_handler, site, path, address));
+  ASSIGN_OR_RETURN(const int fd, make_socket(error_handler, site));
+  auto stream = std::make_shared<BoopStream>(fd, Kind::LISTENER);
+  if (EXPECT_FALSE(bind(fd, reinterpret_cast<const sockaddr *>(&address),
+                        sizeof(address)) != 0 ||
+                   ::listen(fd, SOMAXCONN) != 0))
+    return system_error(error_handler, site, "listen at " + path);
+  return stream;
+}
+
+auto BoopStream::connect(FiberScheduler &fibers, ErrorHandler &error_handler,
+                         const Token &site, const std::string &path)
+    -> Result<StreamPtr> {
+  sockaddr_un address;
+  RETURN_IF_ERROR(make_address(error_handler, site, path, address));
+  ASSIGN_OR_RETURN(const int fd, make_socket(error_handler, site));
+  auto stream = std::make_shared<BoopStream>(fd, Kind::SOCKET);
+  if (::connect(fd, reinterpret_cast<const sockaddr *>(&address),
+                sizeof(address)) == 0)
+    return stream;
+  if (EXPECT_FALSE(errno != EINPROGRESS))
+    return system_error(error_handler, site, "connect to " + path);
+  RETURN_IF_ERROR(fibers.wait_io(error_handler, site, fd, true));
+  int error = 0;
+  socklen_t length = sizeof(error);
+  if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0)
+    error = errno;
+  if (EXPECT_FALSE(error != 0)) {
+    errno = error;
+    return system_error(error_handler, site, "connect to " + path);
+  }
+  return stream;
+}
+
+auto BoopStream::accept(FiberScheduler &fibers, ErrorHandler &error_handler,
+                        const Token &site) -> Result<StreamPtr> {
+  RETURN_IF_ERROR(check_open(error_handler, site));
+  if (EXPECT_FALSE(m_kind != Kind::LISTENER))
+    return report_runtime_error(error_handler, site,
+                                "Only a listening socket accepts "
+                                "connections.");
+  while (true) {
+    const int fd =
+        accept4(m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd >= 0)
+      return std::make_shared<BoopStream>(fd, Kind::SOCKET);
+    if (errno == EINTR || errno == ECONNABORTED)
+      continue;
+    if (EXPECT_FALSE(!would_block()))
+      return system_error(error_handler, site, "accept a connection");
+    RETURN_IF_ERROR(fibers.wait_io(error_handler, site, m_fd, false));
+    RETURN_IF_ERROR(check_open(error_handler, site));
+  }
+}
+
+auto BoopStream::read(FiberScheduler &fibers, ErrorHandler &error_handler,
+                      const Token &site, size_t size) -> Result<BoopObject> {
+  RETURN_IF_ERROR(check_open(error_handler, site));
+  if (unread().empty()) {
+    ASSIGN_OR_RETURN(const bool more, fill(fibers, error_handler, site));
+    if (!more)
+      return BoopObject(nullptr);
+  }
+  return take(std::min(size, unread().size()));
+}
+
+auto BoopStream::read_line(FiberScheduler &fibers, ErrorHandler &error_handler,
+                           const Token &site) -> Result<BoopObject> {
+  RETURN_IF_ERROR(check_open(error_handler, site));
+  // unread bytes known not to hold a newline; `fill` may move them
+  size_t scanned = 0;
+  while (true) {
+    const std::string_view available = unread();
+    // glibc's memchr compares a vector register's worth of bytes at a time
+    const auto *newline = static_cast<const char *>(std::memchr(
+        available.data() + scanned, '\n', available.size() - scanned));
+    if (newline != nullptr) {
+      const auto length = static_cast<size_t>(newline - available.data());
+      BoopObject line = take(length);
+      ++m_start; // the newline
+      return line;
+    }
+    scanned = available.size();
+    ASSIGN_OR_RETURN(const bool more, fill(fibers, error_handler, site));
+    if (!more) // the last line may lack its newline
+      return scanned == 0 ? BoopObject(nullptr) : take(scanned);
+  }
+}
+
+auto BoopStream::write(FiberScheduler &fibers, ErrorHandler &error_handler,
+                       const Token &site, std::string_view data) -> Status {
+  RETURN_IF_ERROR(check_open(error_handler, site));
+  while (!data.empty()) {
+    const ssize_t count = write_some(data);
+    if (count >= 0) {
+      data.remove_prefix(static_cast<size_t>(count));
+      continue;
+    }
+    if (errno == EINTR)
+      continue;
+    if (EXPECT_FALSE(!would_block()))
+      return system_error(error_handler, site, "write to the stream");
+    RETURN_IF_ERROR(fibers.wait_io(error_handler, site, m_fd, true));
+    RETURN_IF_ERROR(check_open(error_handler, site));
+  }
+  return Status::OK;
+}
+
+auto BoopStream::close(FiberScheduler &fibers) -> void {
+  if (m_fd < 0)
+    return;
+  fibers.forget_io(m_fd);
+  unmap();
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+auto BoopStream::is_closed() const noexcept -> bool { return m_fd < 0; }
+
+auto BoopStream::unread() const noexcept -> std::string_view {
+  if (m_map != nullptr)
+    return {m_map + m_start, m_map_size - m_start};
+  return std::string_view(m_buffer).substr(m_start);
+}
+
+auto BoopStream::unmap() noexcept -> void {
+  if (m_map == nullptr)
+    return;
+  munmap(const_cast<char *>(m_map), m_map_size);
+  m_map = nullptr;
+  m_map_size = 0;
+  m_start = 0;
+}
+
+auto BoopStream::check_open(ErrorHandler &error_handler,
+                            const Token &site) const -> Status {
+  if (EXPECT_FALSE(m_fd < 0))
+    return report_runtime_error(error_handler, site, "The stream is closed.");
+  return Status::OK;
+}
+
+auto BoopStream::fill(FiberScheduler &fibers, ErrorHandler &error_handler,
+                      const Token &site) -> Result<bool> {
+  if (m_at_end)
+    return false;
+  RETURN_IF_ERROR(check_open(error_handler, site));
+  if (m_start != 0) {
+    m_buffer.erase(0, m_start);
+    m_start = 0;
+  }
+  const size_t old_size = m_buffer.size();
+  while (true) {
+    m_buffer.resize(old_size + CHUNK_BYTES);
+    const ssize_t count = ::read(m_fd, m_buffer.data() + old_size, CHUNK_BYTES);
+    m_buffer.resize(old_size + (count > 0 ? static_cast<size_t>(count) : 0));
+    if (count > 0)
+      return true;
+    if (count == 0) {
+      m_at_end = true;
+      return false;
+    }
+    if (errno == EINTR)
+      continue;
+    if (EXPECT_FALSE(!would_block()))
+      return system_error(error_handler, site, "read from the stream");
+    RETURN_IF_ERROR(fibers.wait_io(error_handler, site, m_fd, false));
+    RETURN_IF_ERROR(check_open(error_handler, site));
+  }
+}
+
+auto BoopStream::take(size_t size) -> BoopObject {
+  BoopObject taken{BoopString(std::string(unread().substr(0, size)))};
+  m_start += size;
+  return taken;
+}
+
+auto BoopStream::write_some(std::string_view data) -> ssize_t {
+  if (m_kind == Kind::SOCKET)
+    return send(m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+  if (m_kind == Kind::PIPE) {
+    SigpipeBlock block;
+    return ::write(m_fd, data.data(), data.size());
+  }
+  return ::write(m_fd, data.data(), data.size());
+}
+
+} // namespace boop
@@ -0,0 +1,257 @@
+#include "../include/Builtins.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Native.h"
+#include "../include/Sharing.h"
+#include "../include/Tasks.h"
+#include "../include/Types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define EXPECT_TRUE(x) __builtin_expect(static_cast<int64_t>(x), 1)
+#define EXPECT_FALSE(x) __builtin_expect(static_cast<int64_t>(x), 0)
+
+namespace boop {
+
+namespace {
+struct Freeze final : public BuiltinFunction {
+  Freeze() : BuiltinFunction("freeze", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    RETURN_IF_ERROR(freeze(context.error_handler, context.call_site, args[0]));
+    return args[0];
+  }
+};
+
+struct Copy final : public BuiltinFunction {
+  Copy() : BuiltinFunction("copy", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    return deep_copy(context.error_handler, context.call_site, args[0]);
+  }
+};
+
+struct IsFrozen final : public BuiltinFunction {
+  IsFrozen() : BuiltinFunction("is_frozen", 1) {}
+
+  auto call(NativeContext & /*context*/, ArgSpan args)
+      -> Result<BoopObject> override {
+    return BoopObject(is_frozen(args[0]));
+  }
+};
+
+// awaits every future of a list, in order, and returns their results
+struct Join final : public BuiltinFunction {
+  Join() : BuiltinFunction("join", 1) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (EXPECT_FALSE(!native::ArgTraits<BoopListPtr>::matches(args[0])))
+      return context.error("Argument 1 of join must be a list of futures.");
+    const auto &futures =
+        native::ArgTraits<BoopListPtr>::get(args[0])->elements;
+    for (const auto &element : futures)
+      if (EXPECT_FALSE(!std::holds_alternative<FuturePtr>(element)))
+        return context.error("Argument 1 of join must be a list of futures.");
+
+    auto results = std::make_shared<BoopList>();
+    results->elements.reserve(futures.size());
+    context.output.flush();
+    for (const auto &element : futures) {
+      BoopFuture &future = *std::get<FuturePtr>(element);
+      if (!future.is_done())
+        await_future(future);
+      if (EXPECT_FALSE(future.failed()))
+        return context.error("Task failed: " + future.get_error());
+      results->elements.push_back(future.get_value());
+    }
+    return BoopObject(std::move(results));
+  }
+};
+
+// chunks per worker, so that workers finishing early can steal the rest
+constexpr size_t CHUNKS_PER_WORKER = 4;
+
+/**
+ * @brief the per-element work of a parallel builtin, run over one chunk of
+ * its input by a task: the chunk's elements are the arguments. Reducing
+ * folds the chunk from its first element, so a chunk is never empty.
+ *
+ */
+struct ChunkRunner final : public BuiltinFunction {
+  enum class Kind { MAP, FILTER, REDUCE };
+
+  const Kind kind;
+  const BoopObject function;
+
+  ChunkRunner(std::string name, Kind _kind, BoopObject _function)
+      : BuiltinFunction(std::move(name), VARIADIC), kind(_kind),
+        function(std::move(_function)) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    if (kind == Kind::REDUCE) {
+      BoopObject accumulator = args[0];
+      for (size_t i = 1; i < args.size(); ++i) {
+        const BoopObject pair[] = {std::move(accumulator), args[i]};
+        ASSIGN_OR_RETURN(accumulator,
+                         context.evaluator.call_value(
+                             function, ArgSpan(pair, 2), context.call_site));
+      }
+      return accumulator;
+    }
+
+    auto results = std::make_shared<BoopList>();
+    results->elements.reserve(args.size());
+    for (const BoopObject &element : args) {
+      ASSIGN_OR_RETURN(BoopObject result,
+                       context.evaluator.call_value(
+                           function, ArgSpan(&element, 1), context.call_site));
+      if (kind == Kind::MAP)
+        results->elements.push_back(std::move(result));
+      else if (is_true(result))
+        results->elements.push_back(element);
+    }
+    return BoopObject(std::move(results));
+  }
+};
+
+/**
+ * @brief runs `runner` over `elements`, split into chunks that are spawned on
+ * the task pool, and returns the chunks' results in order. A function that
+ * can't be shared between threads (a closure capturing variables, a method
+ * of an instance that isn't frozen) makes a single chunk run right here
+ * instead, where it sees its variables as usual.
+ *
+ */
+auto run_chunks(NativeContext &context,
+                const std::shared_ptr<ChunkRunner> &runner,
+                std::vector<BoopObject> elements)
+    -> Result<std::vector<BoopObject>> {
+  std::vector<BoopObject> results;
+  if (elements.empty())
+    return results;
+  const size_t chunk_count =
+      is_shareable(runner->function)
+          ? std::min(elements.size(),
+                     context.evaluator.task_workers() * CHUNKS_PER_WORKER)
+          : 1;
+  if (chunk_count == 1) {
+    ASSIGN_OR_RETURN(BoopObject result,
+                     runner->call(context, ArgSpan(elements.data(),
+                                                   elements.size())));
+    results.push_back(std::move(result));
+    return results;
+  }
+
+  std::vector<FuturePtr> futures;
+  futures.reserve(chunk_count);
+  for (size_t i = 0; i < chunk_count; ++i) {
+    auto begin = elements.begin() + elements.size() * i / chunk_count;
+    auto end = elements.begin() + elements.size() * (i + 1) / chunk_count;
+    std::vector<BoopObject> chunk(std::make_move_iterator(begin),
+                                  std::make_move_iterator(end));
+    // each chunk gets its own copies: two tasks must not share a mutable
+    // element, even one the input holds twice
+    RETURN_IF_ERROR(transfer(context.error_handler, context.call_site, chunk));
+    // the chunk's result goes to nobody but this call, so it isn't frozen
+    futures.push_back(context.evaluator.spawn(runner, std::move(chunk),
+                                              context.call_site, false));
+  }
+
+  context.output.flush();
+  for (const FuturePtr &future : futures)
+    if (!future->is_done())
+      await_future(*future);
+  results.reserve(chunk_count);
+  // the first failed chunk, so the error doesn't depend on the scheduling
+  for (const FuturePtr &future : futures) {
+    if (EXPECT_FALSE(future->failed()))
+      return context.error("Task failed: " + future->get_error());
+    results.push_back(future->get_value());
+  }
+  return results;
+}
+
+/**
+ * @brief parallel_map, parallel_filter or parallel_reduce. The input is a
+ * list or a Float64Array, whose elements are passed as numbers.
+ *
+ */
+struct Parallel final : public BuiltinFunction {
+  const ChunkRunner::Kind kind;
+
+  Parallel(std::string name, ChunkRunner::Kind _kind, size_t arity)
+      : BuiltinFunction(std::move(name), arity), kind(_kind) {}
+
+  auto call(NativeContext &context, ArgSpan args)
+      -> Result<BoopObject> override {
+    std::vector<BoopObject> elements;
+    const auto *array = std::get_if<Float64ArrayPtr>(&args[0]);
+    if (array != nullptr) {
+      elements.assign((*array)->data.begin(), (*array)->data.end());
+    } else if (native::ArgTraits<BoopListPtr>::matches(args[0])) {
+      elements = native::ArgTraits<BoopListPtr>::get(args[0])->elements;
+    } else {
+      return context.error("Argument 1 of " + get_name() +
+                           " must be a list or a Float64Array.");
+    }
+    if (EXPECT_FALSE(!std::holds_alternative<FunctionPtr>(args[1]) &&
+                     !std::holds_alternative<BuiltinFunctionPtr>(args[1]) &&
+                     !std::holds_alternative<BoopClassPtr>(args[1])))
+      return context.error("Argument 2 of " + get_name() +
+                           " must be a function.");
+
+    // the first chunk folds from the initial value, and the chunks' totals
+    // are then folded in order: the same as folding everything from left to
+    // right if the function is associative
+    if (kind == ChunkRunner::Kind::REDUCE)
+      elements.insert(elements.begin(), args[2]);
+    auto runner = std::make_shared<ChunkRunner>(get_name(), kind, args[1]);
+    ASSIGN_OR_RETURN(std::vector<BoopObject> chunks,
+                     run_chunks(context, runner, std::move(elements)));
+    if (kind == ChunkRunner::Kind::REDUCE)
+      return runner->call(context, ArgSpan(chunks.data(), chunks.size()));
+
+    std::vector<BoopObject> results;
+    for (const BoopObject &chunk : chunks) {
+      auto &chunk_results = std::get<BoopListPtr>(chunk)->elements;
+      results.insert(results.end(),
+                     std::make_move_iterator(chunk_results.begin()),
+                     std::make_move_iterator(chunk_results.end()));
+    }
+    if (kind == ChunkRunner::Kind::FILTER && array != nullptr) {
+      auto filtered = std::make_shared<Float64Array>(results.size());
+      for (size_t i = 0; i < results.size(); ++i)
+        filtered->data[i] = std::get<double>(results[i]);
+      return BoopObject(std::move(filtered));
+    }
+    auto list = std::make_shared<BoopList>();
+    list->elements = std::move(results);
+    return BoopObject(std::move(list));
+  }
+};
+} // namespace
+
+auto define_task_builtins(Evaluator &evaluator) -> void {
+  evaluator.define_native(std::make_shared<Freeze>());
+  evaluator.define_native(std::make_shared<Copy>());
+  evaluator.define_native(std::make_shared<IsFrozen>());
+  evaluator.define_native(std::make_shared<Join>());
+  evaluator.define_native(std::make_shared<Parallel>(
+      "parallel_map", ChunkRunner::Kind::MAP, 2));
+  evaluator.define_native(std::make_shared<Parallel>(
+      "parallel_filter", ChunkRunner::Kind::FILTER, 2));
+  evaluator.define_native(std::make_shared<Parallel>(
+      "parallel_reduce", ChunkRunner::Kind::REDUCE, 3));
+}
+
+} // namespace boop
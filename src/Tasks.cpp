@@ -0,0 +1,179 @@
+#include "../include/Tasks.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Evaluator.h"
+#include "../include/Sharing.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace boop {
+
+BoopFuture::BoopFuture(bool local) : m_local(local) {}
+
+auto BoopFuture::is_done() const noexcept -> bool {
+  return m_done.load(std::memory_order_acquire);
+}
+
+auto BoopFuture::complete(BoopObject value) -> void {
+  m_value = std::move(value);
+  finish();
+}
+
+auto BoopFuture::fail(std::string error) -> void {
+  m_error = std::move(error);
+  finish();
+}
+
+auto BoopFuture::wait() -> void {
+  if (is_done())
+    return;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done_cv.wait(lock, [this] { return is_done(); });
+}
+
+auto BoopFuture::failed() const noexcept -> bool { return !m_error.empty(); }
+
+auto BoopFuture::get_value() const noexcept -> const BoopObject & {
+  return m_value;
+}
+
+auto BoopFuture::get_error() const noexcept -> const std::string & {
+  return m_error;
+}
+
+auto BoopFuture::finish() -> void {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done.store(true, std::memory_order_release);
+  }
+  m_done_cv.notify_all();
+}
+
+class TaskPool : public Uncopyable {
+public:
+  EvaluatorOptions options; // of every task evaluator
+  ThreadPool pool;
+
+  explicit TaskPool(const EvaluatorOptions &spawner_options)
+      : options(spawner_options),
+        pool(ThreadPoolOptions{0, spawner_options.native_stack_bytes()}) {
+    // the workers' stacks are sized for max_call_depth already
+    options.dedicated_stack = false;
+    if (pool.stack_bytes() == 0)
+      options.max_call_depth =
+          std::min<size_t>(options.max_call_depth,
+                           EvaluatorOptions::DEFAULT_MAX_CALL_DEPTH / 10);
+    // tasks spawn into the pool they run on
+    options.task_pool = this;
+  }
+};
+
+namespace {
+// the pool whose task the thread is running, if any
+thread_local TaskPool *worker_pool = nullptr;
+
+/**
+ * @brief the evaluator tasks printing to one descriptor run in on one thread.
+ * It's reused by every such task the thread runs, nested ones included.
+ *
+ */
+struct TaskRunner {
+  ErrorHandler error_handler;
+  Evaluator evaluator;
+
+  explicit TaskRunner(const EvaluatorOptions &options)
+      : evaluator(error_handler, options) {}
+};
+
+thread_local std::vector<std::unique_ptr<TaskRunner>> runners;
+thread_local std::vector<int> runner_fds;
+
+auto get_runner(const TaskPool &task_pool, const OutputOptions &output)
+    -> TaskRunner & {
+  for (size_t i = 0; i < runner_fds.size(); ++i)
+    if (runner_fds[i] == output.fd)
+      return *runners[i];
+  EvaluatorOptions options = task_pool.options;
+  options.output = output;
+  runners.push_back(std::make_unique<TaskRunner>(options));
+  runner_fds.push_back(output.fd);
+  return *runners.back();
+}
+
+auto join_errors(const std::vector<std::string> &errors) -> std::string {
+  std::string joined;
+  for (const auto &error : errors) {
+    if (!joined.empty())
+      joined += "; ";
+    joined += error;
+  }
+  return joined;
+}
+
+auto run_task(const TaskPool &task_pool, const TaskCall &call,
+              BoopFuture &future) -> void {
+  TaskRunner &runner = get_runner(task_pool, call.output);
+  ErrorHandler &error_handler = runner.error_handler;
+  // earlier errors on this thread belong to the tasks this one is nested in
+  const size_t first_error = error_handler.get_errors().size();
+  BoopObject value{nullptr};
+  try {
+    EvalResult result = runner.evaluator.run_task(call);
+    // a shared result may be awaited by any number of threads at once; an
+    // unshared one is only reachable from the future once the task is done
+    if (result.ok() && error_handler.get_errors().size() == first_error &&
+        (!call.share_result ||
+         freeze(error_handler, call.call_site, result.value) == Status::OK))
+      value = std::move(result.value);
+  } catch (const RuntimeError &) {
+    // too many errors; they have all been added already
+  } catch (const std::exception &e) {
+    error_handler.add(call.call_site.get_line(),
+                      std::string("Task failed: ") + e.what());
+  }
+  std::vector<std::string> errors = error_handler.take_errors(first_error);
+  if (errors.empty())
+    future.complete(std::move(value));
+  else
+    future.fail(join_errors(errors));
+}
+} // namespace
+
+auto start_task_pool(const EvaluatorOptions &options)
+    -> std::shared_ptr<TaskPool> {
+  return std::make_shared<TaskPool>(options);
+}
+
+auto spawn_task(TaskPool &task_pool, TaskCall call) -> FuturePtr {
+  auto future = std::make_shared<BoopFuture>();
+  task_pool.pool.submit([&task_pool, call = std::move(call), future] {
+    worker_pool = &task_pool;
+    run_task(task_pool, call, *future);
+  });
+  return future;
+}
+
+auto task_pool_size(const TaskPool &task_pool) -> size_t {
+  return task_pool.pool.size();
+}
+
+auto await_future(BoopFuture &future) -> void {
+  // Only the tasks this worker spawned itself are run here, newest first.
+  // Stealing someone else's could bury the task being waited for under one
+  // that waits for it in turn.
+  while (!future.is_done()) {
+    if (worker_pool == nullptr || !worker_pool->pool.run_own_task()) {
+      future.wait();
+      return;
+    }
+  }
+}
+
+} // namespace boop
@@ -0,0 +1,268 @@
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace boop {
+
+namespace {
+// the pool the running thread works for, and its index there
+thread_local const ThreadPool *t_pool = nullptr;
+thread_local size_t t_index = 0;
+} // namespace
+
+/**
+ * @brief Chase-Lev deque, after Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models". The owning worker pushes and pops at
+ * the bottom without taking a lock; thieves take from the top with a CAS, and
+ * only the last remaining task is contended for by the owner as well.
+ *
+ * The ring doubles when it fills up. Outgrown rings are kept until the deque
+ * is destroyed since a thief may still be reading one.
+ *
+ */
+class ThreadPool::TaskDeque {
+private:
+  struct Ring {
+    const int64_t capacity; // a power of two
+    const std::unique_ptr<std::atomic<Task *>[]> slots;
+
+    explicit Ring(int64_t _capacity)
+        : capacity(_capacity), slots(new std::atomic<Task *>[_capacity]) {}
+
+    auto get(int64_t i) const noexcept -> Task * {
+      return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+    auto put(int64_t i, Task *task) noexcept -> void {
+      slots[i & (capacity - 1)].store(task, std::memory_order_relaxed);
+    }
+  };
+  static constexpr int64_t INITIAL_CAPACITY = 64;
+
+  std::atomic<int64_t> m_top{0};
+  std::atomic<int64_t> m_bottom{0};
+  std::atomic<Ring *> m_ring;
+  std::vector<std::unique_ptr<Ring>> m_rings; // owner only
+
+public:
+  TaskDeque() {
+    m_rings.push_back(std::make_unique<Ring>(INITIAL_CAPACITY));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+  }
+
+  // owner only
+  auto push(Task *task) -> void {
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_top.load(std::memory_order_acquire);
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    if (bottom - top > ring->capacity - 1)
+      ring = grow(ring, top, bottom);
+    ring->put(bottom, task);
+    // publishes the task (and everything it points at) to thieves
+    m_bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  // owner only; nullptr if the deque is empty
+  auto pop() -> Task * {
+    const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    // the store and the load of m_top must not be reordered, or a thief and
+    // the owner could both take the last task
+    m_bottom.store(bottom, std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    if (top > bottom) {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Task *task = ring->get(bottom);
+    if (top == bottom) {
+      // the last one; whoever moves m_top first gets it
+      if (!m_top.compare_exchange_strong(top, top + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+        task = nullptr;
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  // any thread; nullptr if the deque is empty or another thief won the race
+  auto steal() -> Task * {
+    int64_t top = m_top.load(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+    if (top >= bottom)
+      return nullptr;
+    Task *task = m_ring.load(std::memory_order_acquire)->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+      return nullptr;
+    return task;
+  }
+
+private:
+  auto grow(Ring *ring, int64_t top, int64_t bottom) -> Ring * {
+    auto bigger = std::make_unique<Ring>(ring->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i)
+      bigger->put(i, ring->get(i));
+    m_rings.push_back(std::move(bigger));
+    m_ring.store(m_rings.back().get(), std::memory_order_release);
+    return m_rings.back().get();
+  }
+};
+
+ThreadPool::ThreadPool(ThreadPoolOptions options)
+    : m_stack_bytes(options.stack_bytes) {
+  size_t count = options.thread_count;
+  if (count == 0)
+    count = std::max(1U, std::thread::hardware_concurrency());
+  // every deque exists before the first worker starts looking for tasks
+  m_deques.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+    m_deques.push_back(std::make_unique<TaskDeque>());
+  m_threads.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    pthread_t thread;
+    // the stack is only a request; without it evaluation falls back to
+    // dedicated stacks
+    if (start_worker(m_stack_bytes, thread)) {
+      m_threads.push_back(thread);
+      continue;
+    }
+    if (m_stack_bytes != 0 && m_threads.empty()) {
+      m_stack_bytes = 0;
+      if (start_worker(0, thread)) {
+        m_threads.push_back(thread);
+        continue;
+      }
+    }
+    break;
+  }
+  if (m_threads.empty())
+    throw std::runtime_error("ThreadPool: no worker thread could be started");
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_work_ready.notify_all();
+  for (const pthread_t thread : m_threads)
+    pthread_join(thread, nullptr);
+}
+
+auto ThreadPool::submit(Task task) -> void {
+  auto *queued = new Task(std::move(task));
+  m_unfinished.fetch_add(1, std::memory_order_relaxed);
+  // counted before it's pushed so a thief never takes it uncounted
+  m_queued.fetch_add(1, std::memory_order_seq_cst);
+  if (t_pool == this) {
+    m_deques[t_index]->push(queued);
+  } else {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_injected.push_back(queued);
+  }
+  // a worker about to sleep either sees the task counted above or is
+  // counted as sleeping before this looks, so no wakeup is lost
+  if (m_sleeping.load(std::memory_order_seq_cst) != 0) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_work_ready.notify_one();
+  }
+}
+
+auto ThreadPool::wait_idle() -> void {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle.wait(lock, [this] { return m_unfinished.load() == 0; });
+}
+
+auto ThreadPool::run_own_task() -> bool {
+  if (t_pool != this)
+    return false;
+  Task *task = m_deques[t_index]->pop();
+  if (task == nullptr)
+    return false;
+  m_queued.fetch_sub(1, std::memory_order_relaxed);
+  run(task);
+  return true;
+}
+
+auto ThreadPool::is_worker_thread() const noexcept -> bool {
+  return t_pool == this;
+}
+
+auto ThreadPool::size() const noexcept -> size_t { return m_threads.size(); }
+
+auto ThreadPool::stack_bytes() const noexcept -> size_t {
+  return m_stack_bytes;
+}
+
+auto ThreadPool::start_worker(size_t stack_bytes, pthread_t &thread) -> bool {
+  pthread_attr_t attr;
+  if (pthread_attr_init(&attr) != 0)
+    return false;
+  int result = 0;
+  if (stack_bytes != 0)
+    result = pthread_attr_setstacksize(&attr, stack_bytes);
+  if (result == 0)
+    result = pthread_create(
+        &thread, &attr,
+        [](void *pool) -> void * {
+          static_cast<ThreadPool *>(pool)->work();
+          return nullptr;
+        },
+        this);
+  pthread_attr_destroy(&attr);
+  return result == 0;
+}
+
+auto ThreadPool::work() -> void {
+  t_pool = this;
+  t_index = m_started.fetch_add(1);
+  while (true) {
+    if (Task *task = find_task(t_index)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+    m_work_ready.wait(lock, [this] {
+      return m_stopping || m_queued.load(std::memory_order_seq_cst) != 0;
+    });
+    m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+    if (m_stopping && m_queued.load() == 0)
+      return; // nothing is left to run
+  }
+}
+
+auto ThreadPool::find_task(size_t index) -> Task * {
+  Task *task = m_deques[index]->pop();
+  // the victims are tried in turn, starting with the next worker, so thieves
+  // spread out rather than all going for the same deque
+  for (size_t i = 1; task == nullptr && i < m_deques.size(); ++i)
+    task = m_deques[(index + i) % m_deques.size()]->steal();
+  if (task == nullptr) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_injected.empty()) {
+      task = m_injected.front();
+      m_injected.pop_front();
+    }
+  }
+  if (task != nullptr)
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+auto ThreadPool::run(Task *task) -> void {
+  (*task)();
+  delete task;
+  if (m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.notify_all();
+  }
+}
+
+} // namespace boop
@@ -1 +1 @@
-#include "../include/TokenType.h"
+#include "../include/TokenType.h"
@@ -1,228 +1,527 @@
-#include "../include/Types.h"
-#include "../include/Token.h"
-#include "../include/ErrorHandler.h"
-
-#include <cstddef>
-#include <map>
-#include <memory>
-#include <optional>
-#include <string>
-#include <type_traits>
-#include <utility>
-#include <variant>
-
-namespace boop {
-
-auto get_literal_string(const LiteralType &value) -> std::string {
-  switch (value.index()) {
-  case 0: // string
-    return std::get<0>(value);
-  case 1: { // double
-    std::string result = std::to_string(std::get<1>(value));
-    auto pos = result.find(".000000");
-    if (pos != std::string::npos)
-      result.erase(pos, std::string::npos);
-    else
-      result.erase(result.find_last_not_of('0') + 1, std::string::npos);
-    return result;
-  }
-  default:
-    static_assert(
-        std::variant_size_v<LiteralType> == 2,
-        "Looks like you forgot to update the cases in get_literal_string()!");
-    return "";
-  }
-}
-
-auto makee_optional_lliteral(double value) -> OptionalLiteral {
-  return OptionalLiteral(std::in_place, value);
-}
-auto makee_optional_lliteral(const std::string &lexeme) -> OptionalLiteral {
-  return OptionalLiteral(std::in_place, lexeme);
-}
-
-// type definitions
-
-// Functor definitions
-Functor::Functor(const AST::ExprFunctionPtr &declaration, std::string name,
-                 std::shared_ptr<Environment> closure)
-    : m_declaration(declaration), m_name(name), m_closure(closure) {}
-
-auto Functor::arity() const noexcept -> size_t {
-  return m_declaration->parameters.size();
-}
-
-auto Functor::get_closure() const noexcept -> std::shared_ptr<Environment> {
-  return m_closure;
-}
-
-const auto Functor::get_declaration() const noexcept -> AST::ExprFunctionPtr & {
-  return m_declaration;
-}
-
-const auto Functor::get_name() const noexcept -> std::string & {
-  return m_name;
-}
-
-const auto get_body_stmt() const -> std::vector<AST::StmtPtrVariant> & {
-  return m_declaration->body;
-}
-
-auto Functor::is_method() const noexcept -> bool { return m_is_method; }
-
-auto Functor::is_initializer() const noexcept -> bool {
-  return m_is_initializer;
-}
-
-auto Functor::get_params() const noexcept -> std::vector<Token> & {
-  return m_declaration->parameters;
-}
-
-// BuiltinFunction definitions
-BuiltinFunction::BuiltinFunction(std::string name,
-                                 std::shared_ptr<Environment> closure)
-    : m_name(name), m_closure(closure) {}
-
-// BoopClass definitions
-BoopClass::Booplass(
-    std::string name, std::optional<BoopClassPtr> super,
-    const std::vector<std::pair<std::string, BoopObject>> &method_pairs)
-    : m_name(name), m_super_class(super), m_methods(method_pairs) {
-
-  for (const auto &[a, b] : method_pairs) {
-    m_methods.insert_or_assign(m_hasher(a), b); // check if this works
-  }
-}
-
-auto BoopClass::get_name() -> std::string { return m_name; }
-
-auto BoopClass::get_super_class() -> std::optional<BoopClassPtr> {
-  return m_super_class;
-}
-
-auto BoopClass::find_methods(const std::string &name)
-    -> std::optional<BoopObject> {
-
-  auto iter = m_methods.find(m_hasher(name));
-  if (iter != m_methods.end()) {
-    return iter->second;
-  }
-
-  if (m_super_class.has_value()) {
-    return m_super_class.value()->find_methods(name);
-  }
-
-  return std::nullopt;
-}
-
-// BoopInstance definitions
-BoopInstance::BoopInstance(BoopClassPtr _class):
-  m_class(_class){}
-
-auto BoopInstance::to_string() -> std::string {
-  return "Instance of " + m_class->get_name();
-}
-
-auto BoopInstance::get(const std::string &name) -> BoopObject {
-  auto iter = m_fields.find(hasher(name));
-  if (iter != m_fields.end()) {
-    return iter->second;
-  }
-  std::optional<BoopObject> method = m_class->find_methods(name);
-  if (method.has_value()){
-    return method.value();
-  }
-
-  throw RuntimeError();
-}
-
-auto BoopInstance::set(const std::string &name, BoopObject value) -> void {
-  m_fields[hasher(name)] = std::move(value);
-}
-
-// external functions definitions
-auto are_equals(const BoopObject &left, const BoopObject &right) -> bool {
-  if (left.index() == right.index()) {
-    switch (left.index()) {
-    case 0: // string
-      return std::get<std::string>(left) == std::get<std::string>(right);
-    case 1: // double
-      return std::get<double>(left) == std::get<double>(right);
-    case 2: // bool
-      return std::get<bool>(left) == std::get<bool>(right);
-    case 3: // std::nullptr_t
-      // The case where one is null and the other isn't is handled by the
-      // outer condition;
-      return true;
-    case 4: // FunctionPtr
-      return std::get<FunctionPtr>(left)->getFnName() ==
-             std::get<FunctionPtr>(right)->getFnName();
-    case 5: // BoopFunctionPtr
-      return std::get<BoopFunctionPtr>(left)->getFnName() ==
-             std::get<BoopFunctionPtr>(right)->getFnName();
-    case 6: // BoopClassPtr
-      return std::get<BoopClassPtr>(left)->getClassName() ==
-             std::get<BoopClassPtr>(right)->getClassName();
-    case 7: // BoopInstancePtr
-      return std::get<BoopInstancePtr>(left).get() ==
-             std::get<BoopInstancePtr>(right).get();
-    default:
-      static_assert(std::variant_size_v<BoopObject> == 8,
-                    "Looks like you forgot to update the cases in "
-                    "ExprEvaluator::are_equal(const BoopObject&, const "
-                    "BoopObject&)!");
-    }
-  }
-  return false;
-}
-
-auto get_object_string(const BoopObject &object) -> std::string{
-  switch (object.index()) {
-  case 0: // string
-    return std::get<0>(object);
-  case 1: { // double
-    std::string result = std::to_string(std::get<1>(object));
-    auto pos = result.find(".000000");
-    if (pos != std::string::npos)
-      result.erase(pos, std::string::npos);
-    else
-      result.erase(result.find_last_not_of('0') + 1, std::string::npos);
-    return result;
-  }
-  case 2: // bool
-    return std::get<2>(object) == true ? "true" : "false";
-  case 3: // nullptr
-    return "nil";
-  case 4: // FunctionPtr
-    return std::get<FunctionPtr>(object)->getFnName();
-  case 5: // BuiltinFunctionPtr
-    return std::get<BuiltinFunctionPtr>(object)->getFnName();
-  case 6: // BoopClassPtr
-    return std::get<BoopClassPtr>(object)->getClassName();
-  case 7: // BoopInstancePtr
-    return std::get<BoopInstancePtr>(object)->toString();
-  default:
-    static_assert(std::variant_size_v<LoxObject> == 8,
-                  "Looks like you forgot to update the cases in "
-                  "get_literal_string()!");
-    return "";
-  }
-}
-
-auto is_true(const BoopObject &object) -> bool{
-  if (std::holds_alternative<std::nullptr_t>(object))
-    return false;
-  if (std::holds_alternative<bool>(object))
-    return std::get<bool>(object);
-  if (std::holds_alternative<FunctionPtr>(object))
-    return (std::get<FunctionPtr>(object) == nullptr);
-  if (std::holds_alternative<BuiltinFunctionPtr>(object))
-    return (std::get<BuiltinFunctionPtr>(object) == nullptr);
-  if (std::holds_alternative<BoopClassPtr>(object))
-    return (std::get<BoopClassPtr>(object) == nullptr);
-  if (std::holds_alternative<BoopInstancePtr>(object))
-    return (std::get<BoopInstancePtr>(object) == nullptr);
-  return true;
-}
-
-} // namespace boop
\ No newline at end of file
+#include "../include/Types.h"
+#include "../include/ASTNodes.h"
+#include "../include/BoopMap.h"
+#include "../include/Token.h"
+#include "../include/ErrorHandler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace boop {
+
+auto get_literal_string(const LiteralType &value) -> std::string {
+  switch (value.index()) {
+  case 0: // string
+    return std::get<0>(value);
+  case 1: // double
+    return format_number(std::get<1>(value));
+  case 2: // float
+    return format_number(static_cast<double>(std::get<2>(value)));
+  case 3: // int64_t
+    return std::to_string(std::get<3>(value));
+  default:
+    static_assert(
+        std::variant_size_v<LiteralType> == 4,
+        "Looks like you forgot to update the cases in get_literal_string()!");
+    return "";
+  }
+}
+
+auto format_number(double value) -> std::string {
+  // std::to_chars without a precision is the shortest round-trip form
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  return std::string(buffer, result.ptr);
+}
+
+auto make_optional_literal(double value) -> OptionalLiteral {
+  return OptionalLiteral(std::in_place, value);
+}
+auto make_optional_literal(int64_t value) -> OptionalLiteral {
+  return OptionalLiteral(std::in_place, value);
+}
+auto make_optional_literal(const std::string &lexeme) -> OptionalLiteral {
+  return OptionalLiteral(std::in_place, lexeme);
+}
+
+// type definitions
+
+// BoopString definitions
+BoopString::Rep::Rep(std::string value)
+    : text(std::move(value)), length(text.size()) {}
+
+BoopString::Rep::Rep(std::shared_ptr<const Rep> left_half,
+                     std::shared_ptr<const Rep> right_half)
+    : left(std::move(left_half)), right(std::move(right_half)),
+      length(left->length + right->length) {}
+
+BoopString::Rep::~Rep() {
+  // an accumulator built in a loop is a rope as deep as the loop ran; take it
+  // apart iteratively instead of through nested destructor calls
+  std::vector<std::shared_ptr<const Rep>> pending;
+  if (left != nullptr) {
+    pending.push_back(std::move(left));
+    pending.push_back(std::move(right));
+  }
+  while (!pending.empty()) {
+    std::shared_ptr<const Rep> node = std::move(pending.back());
+    pending.pop_back();
+    if (node.use_count() == 1 && !node->is_flat()) {
+      pending.push_back(std::move(node->left));
+      pending.push_back(std::move(node->right));
+    }
+  }
+}
+
+auto BoopString::Rep::flatten() const -> void {
+  std::string flat;
+  flat.reserve(length);
+  // the left spine is walked with an explicit stack for the same reason
+  std::vector<const Rep *> pending{this};
+  while (!pending.empty()) {
+    const Rep *node = pending.back();
+    pending.pop_back();
+    if (node->is_flat()) {
+      flat += node->text;
+      continue;
+    }
+    pending.push_back(node->right.get());
+    pending.push_back(node->left.get());
+  }
+  text = std::move(flat);
+  // the halves are no longer needed; drop them after the rope is complete
+  std::shared_ptr<const Rep> old_left = std::move(left);
+  std::shared_ptr<const Rep> old_right = std::move(right);
+}
+
+BoopString::BoopString(std::shared_ptr<const Rep> rep) : m_rep(std::move(rep)) {}
+
+BoopString::BoopString() {
+  static const std::shared_ptr<const Rep> empty =
+      std::make_shared<const Rep>(std::string{});
+  m_rep = empty;
+}
+
+BoopString::BoopString(std::string text)
+    : m_rep(std::make_shared<const Rep>(std::move(text))) {}
+
+auto BoopString::concat(const BoopString &left, const BoopString &right)
+    -> BoopString {
+  if (left.size() == 0)
+    return right;
+  if (right.size() == 0)
+    return left;
+  if (left.size() + right.size() < MIN_ROPE_LENGTH)
+    return BoopString(left.str() + right.str());
+  return BoopString(std::make_shared<const Rep>(left.m_rep, right.m_rep));
+}
+
+auto BoopString::str() const -> const std::string & {
+  if (!m_rep->is_flat())
+    m_rep->flatten();
+  return m_rep->text;
+}
+
+auto BoopString::size() const noexcept -> size_t { return m_rep->length; }
+
+auto BoopString::hash() const -> size_t {
+  size_t hash = m_rep->hash.load(std::memory_order_relaxed);
+  if (hash == 0) {
+    hash = std::hash<std::string>{}(str());
+    hash = hash == 0 ? 1 : hash;
+    m_rep->hash.store(hash, std::memory_order_relaxed);
+  }
+  return hash;
+}
+
+auto BoopString::shares_buffer(const BoopString &other) const noexcept
+    -> bool {
+  return m_rep == other.m_rep;
+}
+
+auto operator==(const BoopString &left, const BoopString &right) -> bool {
+  if (left.shares_buffer(right))
+    return true;
+  if (left.size() != right.size() || left.hash() != right.hash())
+    return false;
+  return left.str() == right.str();
+}
+
+auto operator!=(const BoopString &left, const BoopString &right) -> bool {
+  return !(left == right);
+}
+
+// Functor definitions
+Functor::Functor(ProgramPtr program, const AST::ExprFunctionPtr &declaration,
+                 std::string name, std::vector<UpvaluePtr> upvalues,
+                 bool is_method, bool is_initializer, BoopInstancePtr receiver)
+    : m_program(std::move(program)), m_declaration(declaration), m_name(name),
+      m_upvalues(std::move(upvalues)),
+      m_is_method(is_method), m_is_initializer(is_initializer),
+      m_receiver(std::move(receiver)) {}
+
+auto Functor::arity() const noexcept -> size_t {
+  return m_declaration->parameters.size();
+}
+
+auto Functor::get_program() const noexcept -> const ProgramPtr & {
+  return m_program;
+}
+
+auto Functor::get_upvalues() const noexcept
+    -> const std::vector<UpvaluePtr> & {
+  return m_upvalues;
+}
+
+auto Functor::get_declaration() const noexcept
+    -> const AST::ExprFunctionPtr & {
+  return m_declaration;
+}
+
+auto Functor::get_name() const noexcept -> const std::string & {
+  return m_name;
+}
+
+auto Functor::is_method() const noexcept -> bool { return m_is_method; }
+
+auto Functor::is_initializer() const noexcept -> bool {
+  return m_is_initializer;
+}
+
+auto Functor::get_receiver() const noexcept -> const BoopInstancePtr & {
+  return m_receiver;
+}
+
+auto Functor::get_params() const noexcept -> const std::vector<Token> & {
+  return m_declaration->parameters;
+}
+
+// BuiltinFunction definitions
+BuiltinFunction::BuiltinFunction(std::string name, size_t arity)
+    : m_name(std::move(name)), m_arity(arity) {}
+
+auto BuiltinFunction::arity() const noexcept -> size_t { return m_arity; }
+
+auto BuiltinFunction::get_name() const noexcept -> const std::string & {
+  return m_name;
+}
+
+// BoopClass definitions
+BoopClass::BoopClass(
+    std::string name, std::optional<BoopClassPtr> super,
+    const std::vector<std::pair<std::string, BoopObject>> &method_pairs)
+    : m_name(std::move(name)), m_super_class(std::move(super)) {
+  for (const auto &[method_name, method] : method_pairs) {
+    m_methods.insert_or_assign(m_hasher(method_name), method);
+  }
+}
+
+auto BoopClass::get_name() -> std::string { return m_name; }
+
+auto BoopClass::get_super_class() -> std::optional<BoopClassPtr> {
+  return m_super_class;
+}
+
+auto BoopClass::find_methods(const std::string &name)
+    -> std::optional<BoopObject> {
+
+  auto iter = m_methods.find(m_hasher(name));
+  if (iter != m_methods.end()) {
+    return iter->second;
+  }
+
+  if (m_super_class.has_value()) {
+    return m_super_class.value()->find_methods(name);
+  }
+
+  return std::nullopt;
+}
+
+auto BoopClass::get_methods() const noexcept
+    -> const std::map<size_t, BoopObject> & {
+  return m_methods;
+}
+
+// BoopInstance definitions
+BoopInstance::BoopInstance(BoopClassPtr _class):
+  m_class(_class){}
+
+auto BoopInstance::to_string() -> std::string {
+  return "Instance of " + m_class->get_name();
+}
+
+auto BoopInstance::get(const std::string &name) -> std::optional<BoopObject> {
+  auto iter = m_fields.find(m_hasher(name));
+  if (iter != m_fields.end()) {
+    return iter->second;
+  }
+  // std::nullopt if the class doesn't define it either
+  return m_class->find_methods(name);
+}
+
+auto BoopInstance::set(const std::string &name, BoopObject value) -> void {
+  m_fields[m_hasher(name)] = std::move(value);
+}
+
+auto BoopInstance::get_class() const noexcept -> const BoopClassPtr & {
+  return m_class;
+}
+
+auto BoopInstance::get_fields() const noexcept
+    -> const std::map<size_t, BoopObject> & {
+  return m_fields;
+}
+
+auto BoopInstance::set_fields(std::map<size_t, BoopObject> fields) -> void {
+  m_fields = std::move(fields);
+}
+
+BoopList::BoopList(std::vector<BoopObject> _elements)
+    : elements(std::move(_elements)) {}
+
+namespace {
+// lists and maps being printed by the current thread; a container that
+// (indirectly) contains itself prints as "[...]" or "{...}" where it recurs
+thread_local std::vector<const void *> printing;
+
+auto is_printing(const void *container) -> bool {
+  return std::find(printing.cbegin(), printing.cend(), container) !=
+         printing.cend();
+}
+
+// "[1, 2, 3]"
+auto list_to_string(const BoopList &list) -> std::string {
+  if (is_printing(&list))
+    return "[...]";
+  printing.push_back(&list);
+  std::string text = "[";
+  for (size_t i = 0; i < list.size(); ++i) {
+    if (i != 0)
+      text += ", ";
+    text += get_object_string(list.elements[i]);
+  }
+  text += "]";
+  printing.pop_back();
+  return text;
+}
+
+// "{a: 1, b: 2}", in insertion order
+auto map_to_string(const BoopMap &map) -> std::string {
+  if (is_printing(&map))
+    return "{...}";
+  printing.push_back(&map);
+  std::string text = "{";
+  bool first = true;
+  for (const auto &entry : map.entries()) {
+    if (!entry.is_live())
+      continue;
+    if (!first)
+      text += ", ";
+    first = false;
+    text += get_object_string(entry.key) + ": " +
+            get_object_string(entry.value);
+  }
+  text += "}";
+  printing.pop_back();
+  return text;
+}
+
+// "Float64Array[1, 2.5]"
+auto array_to_string(const Float64Array &array) -> std::string {
+  std::string text = "Float64Array[";
+  for (size_t i = 0; i < array.size(); ++i) {
+    if (i != 0)
+      text += ", ";
+    text += format_number(array.data[i]);
+  }
+  text += "]";
+  return text;
+}
+} // namespace
+
+// external functions definitions
+auto are_equals(const BoopObject &left, const BoopObject &right) -> bool {
+  // integers and doubles compare by value, 1 == 1.0
+  if (std::holds_alternative<int64_t>(left) &&
+      std::holds_alternative<double>(right))
+    return compare_int_double(std::get<int64_t>(left),
+                              std::get<double>(right)) == 0;
+  if (std::holds_alternative<double>(left) &&
+      std::holds_alternative<int64_t>(right))
+    return compare_int_double(std::get<int64_t>(right),
+                              std::get<double>(left)) == 0;
+
+  if (left.index() == right.index()) {
+    switch (left.index()) {
+    case 0: // BoopString
+      return std::get<BoopString>(left) == std::get<BoopString>(right);
+    case 1: // double
+      return std::get<double>(left) == std::get<double>(right);
+    case 2: // bool
+      return std::get<bool>(left) == std::get<bool>(right);
+    case 3: // std::nullptr_t
+      // The case where one is null and the other isn't is handled by the
+      // outer condition;
+      return true;
+    case 4: // FunctionPtr
+      return std::get<FunctionPtr>(left)->get_name() ==
+             std::get<FunctionPtr>(right)->get_name();
+    case 5: // BuiltinFunctionPtr
+      return std::get<BuiltinFunctionPtr>(left) ==
+             std::get<BuiltinFunctionPtr>(right);
+    case 6: // BoopClassPtr
+      return std::get<BoopClassPtr>(left)->get_name() ==
+             std::get<BoopClassPtr>(right)->get_name();
+    case 7: // BoopInstancePtr
+      return std::get<BoopInstancePtr>(left).get() ==
+             std::get<BoopInstancePtr>(right).get();
+    case 8: // int64_t
+      return std::get<int64_t>(left) == std::get<int64_t>(right);
+    case 9: // BoopListPtr
+      return std::get<BoopListPtr>(left).get() ==
+             std::get<BoopListPtr>(right).get();
+    case 10: // BoopMapPtr
+      return std::get<BoopMapPtr>(left).get() ==
+             std::get<BoopMapPtr>(right).get();
+    case 11: // Float64ArrayPtr
+      return std::get<Float64ArrayPtr>(left).get() ==
+             std::get<Float64ArrayPtr>(right).get();
+    case 12: // FuturePtr
+      return std::get<FuturePtr>(left).get() ==
+             std::get<FuturePtr>(right).get();
+    case 13: // ChannelPtr
+      return std::get<ChannelPtr>(left).get() ==
+             std::get<ChannelPtr>(right).get();
+    case 14: // PortPtr
+      return std::get<PortPtr>(left).get() == std::get<PortPtr>(right).get();
+    case 15: // StreamPtr
+      return std::get<StreamPtr>(left).get() ==
+             std::get<StreamPtr>(right).get();
+    default:
+      static_assert(std::variant_size_v<BoopObject> == 16,
+                    "Looks like you forgot to update the cases in "
+                    "ExprEvaluator::are_equal(const BoopObject&, const "
+                    "BoopObject&)!");
+    }
+  }
+  return false;
+}
+
+auto get_object_string(const BoopObject &object) -> std::string{
+  switch (object.index()) {
+  case 0: // BoopString
+    return std::get<0>(object).str();
+  case 1: // double
+    return format_number(std::get<1>(object));
+  case 2: // bool
+    return std::get<2>(object) == true ? "true" : "false";
+  case 3: // nullptr
+    return "nil";
+  case 4: // FunctionPtr
+    return std::get<FunctionPtr>(object)->get_name();
+  case 5: // BuiltinFunctionPtr
+    return "< builtin-fn_" + std::get<BuiltinFunctionPtr>(object)->get_name() +
+           " >";
+  case 6: // BoopClassPtr
+    return std::get<BoopClassPtr>(object)->get_name();
+  case 7: // BoopInstancePtr
+    return std::get<BoopInstancePtr>(object)->to_string();
+  case 8: // int64_t
+    return std::to_string(std::get<int64_t>(object));
+  case 9: // BoopListPtr
+    return list_to_string(*std::get<BoopListPtr>(object));
+  case 10: // BoopMapPtr
+    return map_to_string(*std::get<BoopMapPtr>(object));
+  case 11: // Float64ArrayPtr
+    return array_to_string(*std::get<Float64ArrayPtr>(object));
+  case 12: // FuturePtr
+    return "< future >";
+  case 13: // ChannelPtr
+    return "< channel >";
+  case 14: // PortPtr
+    return "< port >";
+  case 15: // StreamPtr
+    return "< stream >";
+  default:
+    static_assert(std::variant_size_v<BoopObject> == 16,
+                  "Looks like you forgot to update the cases in "
+                  "get_literal_string()!");
+    return "";
+  }
+}
+
+auto compare_int_double(int64_t integer, double number) noexcept -> int {
+  if (std::isnan(number))
+    return 2;
+  // beyond the range of int64_t, where the cast below would be undefined
+  if (number >= 0x1p63)
+    return -1;
+  if (number < -0x1p63)
+    return 1;
+  const double whole = std::trunc(number);
+  const auto whole_integer = static_cast<int64_t>(whole);
+  if (integer != whole_integer)
+    return integer < whole_integer ? -1 : 1;
+  // same integral part; the fraction decides
+  if (number > whole)
+    return -1;
+  return number < whole ? 1 : 0;
+}
+
+auto is_true(const BoopObject &object) -> bool{
+  if (std::holds_alternative<std::nullptr_t>(object))
+    return false;
+  if (std::holds_alternative<bool>(object))
+    return std::get<bool>(object);
+  if (std::holds_alternative<FunctionPtr>(object))
+    return (std::get<FunctionPtr>(object) == nullptr);
+  if (std::holds_alternative<BuiltinFunctionPtr>(object))
+    return (std::get<BuiltinFunctionPtr>(object) == nullptr);
+  if (std::holds_alternative<BoopClassPtr>(object))
+    return (std::get<BoopClassPtr>(object) == nullptr);
+  if (std::holds_alternative<BoopInstancePtr>(object))
+    return (std::get<BoopInstancePtr>(object) == nullptr);
+  return true;
+}
+
+auto make_boop_object(const OptionalLiteral &literal) -> BoopObject {
+  if (!literal.has_value())
+    return BoopObject(nullptr);
+  const LiteralType &value = literal.value();
+  switch (value.index()) {
+  case 0: { // string
+    const auto &str = std::get<0>(value);
+    if (str == "true")
+      return BoopObject(true);
+    if (str == "false")
+      return BoopObject(false);
+    if (str == "nil")
+      return BoopObject(nullptr);
+    return BoopObject(BoopString(str));
+  }
+  case 1: // double
+    return BoopObject(std::get<1>(value));
+  case 2: // float
+    return BoopObject(static_cast<double>(std::get<2>(value)));
+  case 3: // int64_t
+    return BoopObject(std::get<3>(value));
+  default:
+    static_assert(std::variant_size_v<LiteralType> == 4,
+                  "Looks like you forgot to update the cases in "
+                  "make_boop_object()!");
+    return BoopObject(nullptr);
+  }
+}
+
+} // namespace boop
@@ -0,0 +1,169 @@
+// Checks stage 1 of the JSON parser against a byte-by-byte reference on
+// random text, and every vector version of its steps against the portable
+// one. Exits with 1 on the first mismatch.
+
+#include "../include/JsonIndex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace boop::json;
+
+constexpr int ITERATIONS = 100000;
+
+auto fail(const std::string &what, const std::string &text) -> int {
+  std::cerr << what << " mismatch on [" << text << "]\n";
+  return 1;
+}
+
+auto is_op(char c) -> bool {
+  return c != '\0' && std::strchr("{}[]:,", c) != nullptr;
+}
+
+auto is_space(char c) -> bool {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+auto reference_classify(const char *block) -> BlockMasks {
+  BlockMasks masks;
+  for (size_t i = 0; i < BLOCK_BYTES; ++i) {
+    const uint64_t bit = uint64_t{1} << i;
+    if (block[i] == '"')
+      masks.quote |= bit;
+    if (block[i] == '\\')
+      masks.backslash |= bit;
+    if (is_op(block[i]))
+      masks.op |= bit;
+    if (is_space(block[i]))
+      masks.space |= bit;
+  }
+  return masks;
+}
+
+auto operator!=(const BlockMasks &a, const BlockMasks &b) -> bool {
+  return a.quote != b.quote || a.backslash != b.backslash || a.op != b.op ||
+         a.space != b.space;
+}
+
+// the non-backslash bytes of a block that follow an odd run of backslashes;
+// `escaping` is whether the byte before the block was an escaping backslash
+auto reference_escaped(const char *block, bool &escaping) -> uint64_t {
+  uint64_t escaped = 0;
+  for (size_t i = 0; i < BLOCK_BYTES; ++i) {
+    if (escaping && block[i] != '\\')
+      escaped |= uint64_t{1} << i;
+    escaping = !escaping && block[i] == '\\';
+  }
+  return escaped;
+}
+
+auto reference_index(const std::string &text, std::vector<uint32_t> &index)
+    -> bool {
+  bool in_string = false;
+  bool escaping = false;
+  bool after_scalar = false;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    const bool quote = c == '"' && !escaping;
+    escaping = !escaping && c == '\\';
+    if (quote) {
+      index.push_back(static_cast<uint32_t>(i));
+      in_string = !in_string;
+      after_scalar = false;
+      continue;
+    }
+    if (in_string)
+      continue;
+    const bool scalar = !is_op(c) && !is_space(c);
+    if (is_op(c) || (scalar && !after_scalar))
+      index.push_back(static_cast<uint32_t>(i));
+    after_scalar = scalar;
+  }
+  return !in_string;
+}
+
+auto random_text(std::mt19937_64 &rng) -> std::string {
+  // mostly the bytes stage 1 cares about, in runs long enough to cross
+  // block boundaries
+  static const char alphabet[] = "\\\\\\\"\"ab1 {}[]:,\t\n\r";
+  const size_t length = rng() % 300;
+  std::string text;
+  for (size_t i = 0; i < length; ++i)
+    text += alphabet[rng() % (sizeof(alphabet) - 1)];
+  return text;
+}
+
+auto check_blocks(const std::string &text) -> int {
+  uint64_t carry = 0;
+  bool escaping = false;
+  for (size_t base = 0; base < text.size(); base += BLOCK_BYTES) {
+    char block[BLOCK_BYTES];
+    std::memset(block, ' ', BLOCK_BYTES);
+    std::memcpy(block, text.data() + base,
+                std::min(BLOCK_BYTES, text.size() - base));
+    const BlockMasks masks = reference_classify(block);
+    if (classify_portable(block) != masks)
+      return fail("classify_portable", text);
+#if defined(__SSE2__)
+    if (classify_sse2(block) != masks)
+      return fail("classify_sse2", text);
+#endif
+    if (find_escaped(masks.backslash, carry) !=
+        reference_escaped(block, escaping))
+      return fail("find_escaped", text);
+  }
+  return 0;
+}
+
+auto check_prefix_xor(uint64_t bits) -> int {
+  uint64_t expected = 0;
+  uint64_t parity = 0;
+  for (int i = 0; i < 64; ++i) {
+    parity ^= (bits >> i) & 1;
+    expected |= parity << i;
+  }
+  if (prefix_xor_portable(bits) != expected)
+    return fail("prefix_xor_portable", std::to_string(bits));
+#ifdef BOOP_JSON_CLMUL
+  if (__builtin_cpu_supports("pclmul") && prefix_xor_clmul(bits) != expected)
+    return fail("prefix_xor_clmul", std::to_string(bits));
+#endif
+  return 0;
+}
+} // namespace
+
+int main() {
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < ITERATIONS; ++i) {
+    const std::string text = random_text(rng);
+    if (check_blocks(text) != 0)
+      return 1;
+    std::vector<uint32_t> index;
+    std::vector<uint32_t> expected;
+    const bool closed = index_tokens(text, index);
+    if (closed != reference_index(text, expected) ||
+        (closed && index != expected))
+      return fail("index_tokens", text);
+
+    // every byte value, not just those of JSON
+    std::string block(BLOCK_BYTES, ' ');
+    for (char &c : block)
+      c = static_cast<char>(rng());
+    if (classify_portable(block.data()) != reference_classify(block.data()))
+      return fail("classify_portable", block);
+#if defined(__SSE2__)
+    if (classify_sse2(block.data()) != reference_classify(block.data()))
+      return fail("classify_sse2", block);
+#endif
+    if (check_prefix_xor(rng()) != 0)
+      return 1;
+  }
+  std::cout << "json index: " << ITERATIONS << " cases ok\n";
+  return 0;
+}
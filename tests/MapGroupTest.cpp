@@ -0,0 +1,78 @@
+// Checks the groups of BoopMap's control words against a slot-by-slot
+// reference on random control words: the SSE2 group must match exactly, the
+// portable one may only add full slots to what `match` reports. Exits with 1
+// on the first mismatch.
+
+#include "../include/MapGroup.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+namespace {
+using namespace boop::map_group;
+
+constexpr int ITERATIONS = 100000;
+
+// bit i set for every slot i of a group's match
+template <typename G> auto slots_of(uint64_t bits) -> uint64_t {
+  uint64_t slots = 0;
+  for (; bits != 0; bits &= bits - 1)
+    slots |= uint64_t{1} << (__builtin_ctzll(bits) >> G::SHIFT);
+  return slots;
+}
+
+template <typename G, typename Predicate>
+auto reference(const int8_t *ctrl, Predicate matches) -> uint64_t {
+  uint64_t slots = 0;
+  for (size_t i = 0; i < G::WIDTH; ++i)
+    if (matches(ctrl[i]))
+      slots |= uint64_t{1} << i;
+  return slots;
+}
+
+template <typename G> auto check(const int8_t *ctrl, bool exact) -> bool {
+  const G group(ctrl);
+  const int8_t h2 = ctrl[0] < 0 ? int8_t{0x35} : ctrl[0];
+  const uint64_t full = reference<G>(ctrl, [](int8_t c) { return c >= 0; });
+  const uint64_t expected =
+      reference<G>(ctrl, [h2](int8_t c) { return c == h2; });
+  const uint64_t found = slots_of<G>(group.match(h2));
+  if (exact ? found != expected
+            : (found & expected) != expected || (found & ~expected & ~full))
+    return false;
+  return slots_of<G>(group.match_empty()) ==
+             reference<G>(ctrl, [](int8_t c) { return c == EMPTY; }) &&
+         slots_of<G>(group.match_empty_or_deleted()) ==
+             reference<G>(ctrl, [](int8_t c) { return c < 0; });
+}
+} // namespace
+
+int main() {
+  std::mt19937_64 rng(42);
+  int8_t ctrl[16];
+  for (int i = 0; i < ITERATIONS; ++i) {
+    // few distinct hash bits, so that matches (and near misses, which the
+    // portable group may report) are common
+    for (int8_t &c : ctrl) {
+      const uint64_t pick = rng() % 8;
+      c = pick == 0   ? EMPTY
+          : pick == 1 ? DELETED
+                      : static_cast<int8_t>(0x34 + rng() % 4);
+    }
+    if (!check<PortableGroup>(ctrl, false) ||
+        !check<PortableGroup>(ctrl + 8, false)) {
+      std::cerr << "portable group mismatch\n";
+      return 1;
+    }
+#if defined(__SSE2__)
+    if (!check<Sse2Group>(ctrl, true)) {
+      std::cerr << "SSE2 group mismatch\n";
+      return 1;
+    }
+#endif
+  }
+  std::cout << "map group: " << ITERATIONS << " cases ok\n";
+  return 0;
+}
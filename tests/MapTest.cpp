@@ -0,0 +1,196 @@
+// Runs random sets, erases and lookups on a BoopMap and on a reference that
+// keeps its entries in a plain vector, checking that the two agree on every
+// lookup, on the size and on the insertion order. Keys that `==` finds equal
+// (1 and 1.0, a string and a rope with the same characters) must be one key.
+// Then checks that freeze, transfer and deep_copy (Sharing.h) share what's
+// frozen, copy everything else once and keep aliasing. Exits with 1 on the
+// first mismatch.
+
+#include "../include/BoopMap.h"
+#include "../include/ErrorHandler.h"
+#include "../include/Sharing.h"
+#include "../include/Token.h"
+#include "../include/TokenType.h"
+#include "../include/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+using namespace boop;
+
+constexpr int ITERATIONS = 200000;
+constexpr int KEY_IDS = 300;
+
+// a key of the reference is its id; the map gets one of the equal keys
+// standing for that id
+auto make_key(int id, std::mt19937_64 &rng) -> BoopObject {
+  switch (id % 3) {
+  case 0: // an integer, or the double equal to it
+    if (rng() % 2 == 0)
+      return BoopObject(static_cast<int64_t>(id));
+    return BoopObject(static_cast<double>(id));
+  case 1: { // a string, flat or a rope long enough not to be copied
+    const std::string half(40, static_cast<char>('a' + id % 26));
+    const std::string tail = std::to_string(id);
+    if (rng() % 2 == 0)
+      return BoopObject(BoopString(half + half + tail));
+    return BoopObject(BoopString::concat(BoopString(half),
+                                         BoopString(half + tail)));
+  }
+  default: // a fractional double, never equal to an integer
+    return BoopObject(id + 0.5);
+  }
+}
+
+struct Reference {
+  std::vector<std::pair<int, int64_t>> entries; // in insertion order
+
+  auto find(int id) -> std::pair<int, int64_t> * {
+    for (auto &entry : entries)
+      if (entry.first == id)
+        return &entry;
+    return nullptr;
+  }
+  auto erase(int id) -> bool {
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+      if (iter->first == id) {
+        entries.erase(iter);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+auto value_of(const BoopObject *value) -> int64_t {
+  return value == nullptr ? -1 : std::get<int64_t>(*value);
+}
+
+auto same_order(const BoopMap &map, const Reference &reference) -> bool {
+  size_t i = 0;
+  for (const BoopMap::Entry &entry : map.entries()) {
+    if (!entry.is_live())
+      continue;
+    if (i == reference.entries.size() ||
+        std::get<int64_t>(entry.value) != reference.entries[i].second)
+      return false;
+    ++i;
+  }
+  return i == reference.entries.size();
+}
+
+auto check_map() -> bool {
+  std::mt19937_64 rng(42);
+  BoopMap map;
+  Reference reference;
+  for (int i = 0; i < ITERATIONS; ++i) {
+    const int id = static_cast<int>(rng() % KEY_IDS);
+    const BoopObject key = make_key(id, rng);
+    switch (rng() % 8) {
+    case 0:
+    case 1:
+      if (map.erase(key) != reference.erase(id)) {
+        std::cerr << "erase of key " << id << " disagrees\n";
+        return false;
+      }
+      break;
+    case 2:
+      map.reserve(map.size() + rng() % 64);
+      break;
+    default: {
+      // the values are unique, so the order check can tell entries apart
+      const int64_t value = i;
+      map.set(key, BoopObject(value));
+      if (auto *entry = reference.find(id))
+        entry->second = value;
+      else
+        reference.entries.emplace_back(id, value);
+    }
+    }
+    const auto *expected = reference.find(id);
+    if (value_of(map.find(key)) != (expected ? expected->second : -1) ||
+        map.size() != reference.entries.size()) {
+      std::cerr << "lookup of key " << id << " disagrees\n";
+      return false;
+    }
+    if (i % 1000 == 0 && !same_order(map, reference)) {
+      std::cerr << "insertion order disagrees\n";
+      return false;
+    }
+  }
+  // keys that can't be stored are simply not found
+  return map.find(BoopObject(nullptr)) == nullptr &&
+         !BoopMap::is_valid_key(BoopObject(nullptr)) &&
+         same_order(map, reference);
+}
+
+auto make_list(std::vector<BoopObject> elements) -> BoopListPtr {
+  return std::make_shared<BoopList>(std::move(elements));
+}
+
+auto check_sharing() -> bool {
+  ErrorHandler error_handler;
+  const Token site(TokenType::IDENTIFIER, "test", std::nullopt, 1);
+
+  auto map = std::make_shared<BoopMap>();
+  map->set(BoopObject(BoopString("k")), BoopObject(int64_t{1}));
+  // the map twice, and a list holding itself
+  auto list = make_list({BoopObject(map), BoopObject(map)});
+  list->elements.push_back(BoopObject(list));
+
+  // not frozen: copied once, with the aliasing kept
+  Result<BoopObject> moved = transfer(error_handler, site, BoopObject(list));
+  if (!moved.ok())
+    return false;
+  const auto &copy = std::get<BoopListPtr>(moved.value);
+  if (copy == list || is_frozen(BoopObject(copy)) ||
+      std::get<BoopMapPtr>(copy->elements[0]) == map ||
+      copy->elements[0] != copy->elements[1] ||
+      std::get<BoopListPtr>(copy->elements[2]) != copy) {
+    std::cerr << "transfer of a list that isn't frozen\n";
+    return false;
+  }
+
+  // frozen: marked all the way down and handed over as it is
+  if (freeze(error_handler, site, BoopObject(list)) != Status::OK ||
+      !is_frozen(BoopObject(list)) || !is_frozen(BoopObject(map)) ||
+      !is_shareable(BoopObject(list))) {
+    std::cerr << "freeze of a list\n";
+    return false;
+  }
+  moved = transfer(error_handler, site, BoopObject(list));
+  if (!moved.ok() || std::get<BoopListPtr>(moved.value) != list) {
+    std::cerr << "transfer of a frozen list\n";
+    return false;
+  }
+
+  // deep_copy thaws, still copying each value once
+  Result<BoopObject> thawed = deep_copy(error_handler, site, BoopObject(list));
+  if (!thawed.ok())
+    return false;
+  const auto &thawed_list = std::get<BoopListPtr>(thawed.value);
+  const auto &thawed_map = std::get<BoopMapPtr>(thawed_list->elements[0]);
+  if (thawed_list == list || is_frozen(thawed.value) ||
+      is_frozen(BoopObject(thawed_map)) ||
+      thawed_list->elements[0] != thawed_list->elements[1] ||
+      value_of(thawed_map->find(BoopObject(BoopString("k")))) != 1) {
+    std::cerr << "deep_copy of a frozen list\n";
+    return false;
+  }
+  return error_handler.get_errors().empty();
+}
+} // namespace
+
+int main() {
+  if (!check_map() || !check_sharing())
+    return 1;
+  std::cout << "map: " << ITERATIONS << " operations ok, sharing ok\n";
+  return 0;
+}
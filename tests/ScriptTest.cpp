@@ -0,0 +1,138 @@
+// Runs the scripts given on the command line through the C API (boop.h) and
+// checks what they print and the errors they raise against comments in the
+// scripts themselves:
+//
+//   print x;  // expect: 42
+//   1 / 0;    // expect runtime error: /: Division by zero.
+//
+// Printed lines must match the `expect` comments in order, with print's "> "
+// prefix left out. Every error must be raised on the line of its comment,
+// in order too. Exits with 1 on the first script that doesn't match.
+
+#include "../include/boop.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string EXPECT_OUTPUT = "// expect: ";
+const std::string EXPECT_ERROR = "// expect runtime error: ";
+const std::string PRINT_PREFIX = "> ";
+
+struct Expectations {
+  std::vector<std::string> output;
+  std::vector<std::string> errors; // as the error handler formats them
+};
+
+auto read_file(const std::string &path, std::string &content) -> bool {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  content = buffer.str();
+  return true;
+}
+
+auto split_lines(const std::string &text) -> std::vector<std::string> {
+  std::vector<std::string> lines;
+  std::istringstream stream(text);
+  for (std::string line; std::getline(stream, line);)
+    lines.push_back(line);
+  return lines;
+}
+
+auto parse_expectations(const std::string &source) -> Expectations {
+  Expectations expected;
+  const std::vector<std::string> lines = split_lines(source);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const std::string &line = lines[i];
+    size_t at = line.find(EXPECT_OUTPUT);
+    if (at != std::string::npos) {
+      expected.output.push_back(line.substr(at + EXPECT_OUTPUT.size()));
+      continue;
+    }
+    at = line.find(EXPECT_ERROR);
+    if (at != std::string::npos)
+      expected.errors.push_back("[Line " + std::to_string(i + 1) +
+                                "] Error: " +
+                                line.substr(at + EXPECT_ERROR.size()));
+  }
+  return expected;
+}
+
+auto compare(const std::string &script, const char *what,
+             const std::vector<std::string> &got,
+             const std::vector<std::string> &expected) -> bool {
+  for (size_t i = 0; i < got.size() || i < expected.size(); ++i) {
+    const std::string got_line = i < got.size() ? got[i] : "<nothing>";
+    const std::string expected_line =
+        i < expected.size() ? expected[i] : "<nothing>";
+    if (got_line != expected_line) {
+      std::cerr << script << ": " << what << " " << i + 1 << " is \""
+                << got_line << "\", expected \"" << expected_line << "\"\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+auto run_script(const std::string &path) -> bool {
+  std::string source;
+  if (!read_file(path, source)) {
+    std::cerr << "Can't read " << path << ".\n";
+    return false;
+  }
+  const Expectations expected = parse_expectations(source);
+
+  // print writes to a temporary file, read back once the interpreter is gone
+  FILE *output = std::tmpfile();
+  if (output == nullptr) {
+    std::cerr << "Can't create a temporary file.\n";
+    return false;
+  }
+  boop_options options{};
+  options.output_fd = fileno(output);
+  boop_interpreter *interpreter = boop_new(&options);
+  const boop_status status =
+      boop_run_source(interpreter, source.data(), source.size());
+  const std::string last_error =
+      status == BOOP_OK ? "" : boop_last_error(interpreter);
+  boop_free(interpreter);
+
+  std::string printed;
+  std::rewind(output);
+  for (int c = std::fgetc(output); c != EOF; c = std::fgetc(output))
+    printed += static_cast<char>(c);
+  std::fclose(output);
+  std::vector<std::string> lines = split_lines(printed);
+  for (std::string &line : lines) {
+    if (line.compare(0, PRINT_PREFIX.size(), PRINT_PREFIX) == 0)
+      line.erase(0, PRINT_PREFIX.size());
+  }
+
+  if (status == BOOP_COMPILE_ERROR) {
+    std::cerr << path << ": doesn't compile:\n" << last_error << '\n';
+    return false;
+  }
+  return compare(path, "line", lines, expected.output) &&
+         compare(path, "error", split_lines(last_error), expected.errors);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <script>...\n";
+    return 64;
+  }
+  for (int i = 1; i < argc; ++i) {
+    if (!run_script(argv[i]))
+      return 1;
+    std::cout << argv[i] << ": ok\n";
+  }
+  return 0;
+}